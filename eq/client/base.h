@@ -91,9 +91,11 @@
 #include <eq/client/exception.h>
 #include <eq/client/frame.h>
 #include <eq/client/frameData.h>
+#include <eq/client/frameRecorder.h>
 #include <eq/client/global.h>
 #include <eq/client/glException.h>
 #include <eq/client/image.h>
+#include <eq/client/imageWriter.h>
 #include <eq/client/init.h>
 #include <eq/client/layout.h>
 #include <eq/client/log.h>
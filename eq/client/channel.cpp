@@ -46,6 +46,7 @@
 #include <eq/util/frameBufferObject.h>
 #include <eq/util/objectManager.h>
 #include <eq/fabric/commands.h>
+#include <eq/fabric/renderContextCache.h>
 #include <eq/fabric/task.h>
 #include <eq/fabric/tile.h>
 
@@ -53,6 +54,8 @@
 #include <co/exception.h>
 #include <co/objectICommand.h>
 #include <co/queueSlave.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/compressor.h>
 #include <lunchbox/rng.h>
 #include <lunchbox/scopedMutex.h>
 #include <lunchbox/plugins/compressor.h>
@@ -62,9 +65,12 @@
 #  include <GLStats/GLStats.h>
 #endif
 
+#include <algorithm>
 #include <bitset>
+#include <cmath>
 #include <set>
 
+#include "detail/compressionPolicy.h"
 #include "detail/channel.ipp"
 
 #ifdef EQ_USE_SAGE
@@ -843,6 +849,64 @@ bool _removeOverlap( PixelViewports& regions )
         }
     return false;
 }
+
+/** Cells per dimension of the cost grid reported to the server. */
+static const int32_t _costGridSize = 16;
+
+/**
+ * Compute the coverage of non-rectangular regions on a grid over the channel.
+ *
+ * Each cell holds the fraction of its area covered by the regions, rounded up
+ * so that any covered cell is non-zero. The grid is left empty if the regions
+ * are fully described by their bounding rectangle.
+ */
+void _computeCostGrid( const PixelViewports& regions, const PixelViewport& pvp,
+                       Vectorub& grid )
+{
+    grid.clear();
+    if( regions.size() < 2 || pvp.w < _costGridSize || pvp.h < _costGridSize )
+        return;
+
+    const int32_t size = _costGridSize;
+    std::vector< float > coverage( size * size, 0.f );
+
+    for( PixelViewportsCIter i = regions.begin(); i != regions.end(); ++i )
+    {
+        const PixelViewport& region = *i;
+        if( !region.hasArea( ))
+            continue;
+
+        // cell range touched by the region, widened for rounding of borders
+        const int32_t startX = LB_MAX( region.x * size / pvp.w - 1, 0 );
+        const int32_t endX = LB_MIN( region.getXEnd() * size / pvp.w + 1,
+                                     size - 1 );
+        const int32_t startY = LB_MAX( region.y * size / pvp.h - 1, 0 );
+        const int32_t endY = LB_MIN( region.getYEnd() * size / pvp.h + 1,
+                                     size - 1 );
+
+        for( int32_t y = startY; y <= endY; ++y )
+        {
+            const int32_t cellY = y * pvp.h / size;
+            const int32_t cellH = ( y + 1 ) * pvp.h / size - cellY;
+
+            for( int32_t x = startX; x <= endX; ++x )
+            {
+                const int32_t cellX = x * pvp.w / size;
+                const int32_t cellW = ( x + 1 ) * pvp.w / size - cellX;
+                PixelViewport cell( cellX, cellY, cellW, cellH );
+
+                cell.intersect( region );
+                if( cell.hasArea( ))
+                    coverage[ y * size + x ] += float( cell.getArea( )) /
+                                                float( cellW * cellH );
+            }
+        }
+    }
+
+    grid.resize( coverage.size( ));
+    for( size_t i = 0; i < coverage.size(); ++i )
+        grid[ i ] = uint8_t( std::ceil( LB_MIN( coverage[ i ], 1.f ) * 255.f ));
+}
 }
 
 void Channel::declareRegion( const PixelViewport& region )
@@ -900,9 +964,12 @@ bool Channel::processEvent( const Event& event )
         case Event::CHANNEL_POINTER_BUTTON_PRESS:
         case Event::CHANNEL_POINTER_BUTTON_RELEASE:
         case Event::CHANNEL_POINTER_WHEEL:
-        case Event::STATISTIC:
             break;
 
+        case Event::STATISTIC:
+            getConfig()->sendStatistic( event );
+            return true;
+
         case Event::CHANNEL_RESIZE:
         {
             const UUID& viewID = getNativeContext().view.identifier;
@@ -1057,6 +1124,11 @@ void Channel::_frameTiles( RenderContext& context, const bool isLocal,
     bool hasAsyncReadback = false;
     const uint32_t timeout = getConfig()->getTimeout();
 
+    const uint32_t frameNumber = getCurrentFrame();
+    const size_t index = frameNumber % _impl->statistics->size();
+    TileTimes& tileTimes = _impl->statistics.data[ index ].tileTimes;
+    lunchbox::Clock tileClock;
+
     co::QueueSlave* queue = _getQueue( queueID );
     LBASSERT( queue );
     for( ;; )
@@ -1066,6 +1138,7 @@ void Channel::_frameTiles( RenderContext& context, const bool isLocal,
             break;
 
         const Tile& tile = tileCmd.get< Tile >();
+        tileClock.reset();
         context.apply( tile );
 
         const PixelViewport tilePVP = context.pvp;
@@ -1123,6 +1196,8 @@ void Channel::_frameTiles( RenderContext& context, const bool isLocal,
             if( _asyncFinishReadback( nImages ))
                 hasAsyncReadback = true;
         }
+        tileTimes.push_back( TileTime( queueID, tile.pvp,
+                                       tileClock.getTimef( )));
     }
 
     if( tasks & fabric::TASK_CLEAR )
@@ -1171,10 +1246,13 @@ void Channel::_unrefFrame( const uint32_t frameNumber )
         return;
 
     send( getServer(), fabric::CMD_CHANNEL_FRAME_FINISH_REPLY )
-            << stats.region << frameNumber << stats.data;
+            << stats.region << frameNumber << stats.data << stats.costGrid
+            << stats.tileTimes;
 
     stats.data.clear();
     stats.region = Viewport::FULL;
+    stats.costGrid.clear();
+    stats.tileTimes.clear();
 
     _impl->finishedFrame = frameNumber;
 }
@@ -1316,6 +1394,113 @@ void Channel::_asyncTransmit( FrameDataPtr frame, const uint32_t frameNumber,
     }
 }
 
+namespace
+{
+// Compressed images larger than this are sent in bands of rows, which overlaps
+// the compression of one band with the transmission of the previous bands and
+// lets the receiver decompress bands while the rest is still in flight.
+static const int32_t _transmitBandArea = 256 * 1024;
+static const int32_t _maxTransmitBands = 64;
+
+uint32_t _getNumTransmitBands( const PixelViewport& pvp )
+{
+    const int32_t nBands = pvp.getArea() / _transmitBandArea;
+    return uint32_t( LB_MAX( 1, LB_MIN( nBands,
+                                        LB_MIN( _maxTransmitBands, pvp.h ))));
+}
+
+uint64_t _getImageDataSize( const std::vector< const PixelData* >& pixelDatas )
+{
+    uint64_t size = 0;
+    for( size_t i = 0; i < pixelDatas.size(); ++i )
+    {
+        const PixelData* data = pixelDatas[i];
+
+        // format, type, nChunks, compressor name
+        size += sizeof( FrameData::ImageHeader );
+        if( data->isCompressed )
+        {
+            for( size_t j = 0 ; j < data->compressedSize.size(); ++j )
+                size += sizeof( uint64_t ) + data->compressedSize[ j ];
+        }
+        else
+            size += sizeof( uint64_t ) + data->pvp.getArea() * data->pixelSize;
+    }
+    return size;
+}
+
+/** Send the given pixel data as one CMD_NODE_FRAMEDATA_TRANSMIT. */
+void _sendImageData( co::ConnectionPtr connection, const uint128_t& nodeID,
+                     const co::ObjectVersion& frameDataVersion,
+                     const PixelViewport& pvp, const Zoom& zoom,
+                     const uint32_t buffers, const uint32_t frameNumber,
+                     const bool useAlpha, const bool useCompression,
+                     const std::vector< const PixelData* >& pixelDatas,
+                     const std::vector< float >& qualities )
+{
+    LBASSERT( pvp.isValid( ));
+    const uint64_t imageDataSize = _getImageDataSize( pixelDatas );
+
+    co::ObjectOCommand command( co::Connections( 1, connection ),
+                                fabric::CMD_NODE_FRAMEDATA_TRANSMIT,
+                                co::COMMANDTYPE_OBJECT, nodeID,
+                                EQ_INSTANCE_ALL );
+    command << frameDataVersion << pvp << zoom << buffers << frameNumber
+            << useAlpha;
+    command.sendHeader( imageDataSize );
+
+#ifndef NDEBUG
+    size_t sentBytes = 0;
+#endif
+
+    for( uint32_t j=0; j < pixelDatas.size(); ++j )
+    {
+#ifndef NDEBUG
+        sentBytes += sizeof( FrameData::ImageHeader );
+#endif
+        const PixelData* data = pixelDatas[j];
+        const FrameData::ImageHeader header =
+              { data->internalFormat, data->externalFormat,
+                data->pixelSize, data->pvp,
+                useCompression ? data->compressorName : EQ_COMPRESSOR_NONE,
+                data->compressorFlags,
+                data->isCompressed ? uint32_t( data->compressedSize.size()) : 1,
+                qualities[ j ] };
+
+        connection->send( &header, sizeof( header ), true );
+
+        if( data->isCompressed )
+        {
+            for( uint32_t k = 0 ; k < data->compressedSize.size(); ++k )
+            {
+                const uint64_t dataSize = data->compressedSize[k];
+                connection->send( &dataSize, sizeof( dataSize ), true );
+                if( dataSize > 0 )
+                    connection->send( data->compressedData[k],
+                                      dataSize, true );
+#ifndef NDEBUG
+                sentBytes += sizeof( dataSize ) + dataSize;
+#endif
+            }
+        }
+        else
+        {
+            const uint64_t dataSize = data->pvp.getArea() *
+                data->pixelSize;
+            connection->send( &dataSize, sizeof( dataSize ), true );
+            connection->send( data->pixels, dataSize, true );
+#ifndef NDEBUG
+            sentBytes += sizeof( dataSize ) + dataSize;
+#endif
+        }
+    }
+#ifndef NDEBUG
+    LBASSERTINFO( sentBytes == imageDataSize,
+        sentBytes << " != " << imageDataSize );
+#endif
+}
+}
+
 void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
                               const uint128_t& nodeID,
                               const uint128_t& netNodeID,
@@ -1360,8 +1545,39 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
     co::ConnectionPtr connection = toNode->getConnection();
     co::ConstConnectionDescriptionPtr description =connection->getDescription();
 
-    // use compression on links up to 2 GBit/s
-    const bool useCompression = ( description->bandwidth <= 262144 );
+    const Frame::Buffer buffers[] = { Frame::BUFFER_COLOR,Frame::BUFFER_DEPTH };
+    uint32_t compressor = EQ_COMPRESSOR_NONE;
+    uint64_t rawSize = 0;
+    bool isCompressed = false;
+    for( unsigned j = 0; j < 2; ++j )
+    {
+        const Frame::Buffer buffer = buffers[j];
+        if( !image->hasPixelData( buffer ))
+            continue;
+
+        rawSize += image->getPixelDataSize( buffer );
+        if( image->getPixelData( buffer ).isCompressed )
+            isCompressed = true;
+        if( compressor == EQ_COMPRESSOR_NONE )
+            compressor = image->selectCompressor( buffer );
+    }
+
+    // compressed data from a transmission to another node is always reused
+    const bool useCompression = isCompressed ||
+        _impl->compressionPolicy.useCompression( netNodeID,
+                                                 description->bandwidth,
+                                                 compressor, rawSize );
+    if( useCompression && !isCompressed )
+    {
+        const uint32_t nBands =
+            _getNumTransmitBands( image->getPixelViewport( ));
+        if( nBands > 1 )
+        {
+            _transmitImageBands( frameDataVersion, nodeID, toNode, image,
+                                 nBands, frameNumber, taskID );
+            return;
+        }
+    }
 
     std::vector< const PixelData* > pixelDatas;
     std::vector< float > qualities;
@@ -1369,19 +1585,15 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
     uint32_t commandBuffers = Frame::BUFFER_NONE;
     uint64_t imageDataSize = 0;
 
-
     {
-        uint64_t rawSize( 0 );
+        // always sampled to show the compression decision
         ChannelStatistics compressEvent( Statistic::CHANNEL_FRAME_COMPRESS,
-                                         this, frameNumber,
-                                         useCompression ? AUTO : OFF );
+                                         this, frameNumber );
         compressEvent.event.statistic.task = taskID;
         compressEvent.event.statistic.ratio = 1.0f;
         compressEvent.event.statistic.plugins[0] = EQ_COMPRESSOR_NONE;
         compressEvent.event.statistic.plugins[1] = EQ_COMPRESSOR_NONE;
-
-        // Prepare image pixel data
-        Frame::Buffer buffers[] = {Frame::BUFFER_COLOR,Frame::BUFFER_DEPTH};
+        lunchbox::Clock clock;
 
         // for each image attachment
         for( unsigned j = 0; j < 2; ++j )
@@ -1389,9 +1601,6 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
             Frame::Buffer buffer = buffers[j];
             if( image->hasPixelData( buffer ))
             {
-                // format, type, nChunks, compressor name
-                imageDataSize += sizeof( FrameData::ImageHeader );
-
                 const PixelData& data = useCompression ?
                     image->compressPixelData( buffer ) :
                     image->getPixelData( buffer );
@@ -1399,32 +1608,24 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
                 qualities.push_back( image->getQuality( buffer ));
 
                 if( data.isCompressed )
-                {
-                    const uint32_t nElements =
-                        uint32_t( data.compressedSize.size( ));
-                    for( uint32_t k = 0 ; k < nElements; ++k )
-                    {
-                        imageDataSize += sizeof( uint64_t );
-                        imageDataSize += data.compressedSize[ k ];
-                    }
                     compressEvent.event.statistic.plugins[j] =
                         data.compressorName;
-                }
-                else
-                {
-                    imageDataSize += sizeof( uint64_t );
-                    imageDataSize += image->getPixelDataSize( buffer );
-                }
 
                 commandBuffers |= buffer;
-                rawSize += image->getPixelDataSize( buffer );
             }
         }
 
+        imageDataSize = _getImageDataSize( pixelDatas );
         if( rawSize > 0 )
             compressEvent.event.statistic.ratio =
-            static_cast< float >( imageDataSize ) /
-            static_cast< float >( rawSize );
+                static_cast< float >( imageDataSize ) /
+                static_cast< float >( rawSize );
+
+        // cached results from a transmission to another node are not timed
+        if( useCompression && !isCompressed )
+            _impl->compressionPolicy.addCompress( compressor, rawSize,
+                                                  imageDataSize,
+                                                  clock.getTimef( ));
     }
 
     if( pixelDatas.empty( ))
@@ -1439,67 +1640,157 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
         waitEvent.event.statistic.task = taskID;
         token = getLocalNode()->acquireSendToken( toNode );
     }
-    LBASSERT( image->getPixelViewport().isValid( ));
 
-    co::ObjectOCommand command( co::Connections( 1, connection ),
-                                fabric::CMD_NODE_FRAMEDATA_TRANSMIT,
-                                co::COMMANDTYPE_OBJECT, nodeID,
-                                EQ_INSTANCE_ALL );
-    command << frameDataVersion << image->getPixelViewport() << image->getZoom()
-            << commandBuffers << frameNumber << image->getAlphaUsage();
-    command.sendHeader( imageDataSize );
+    lunchbox::Clock clock;
+    _sendImageData( connection, nodeID, frameDataVersion,
+                    image->getPixelViewport(), image->getZoom(),
+                    commandBuffers, frameNumber, image->getAlphaUsage(),
+                    useCompression, pixelDatas, qualities );
+    _impl->compressionPolicy.addSend( netNodeID, imageDataSize,
+                                      clock.getTimef( ));
 
-#ifndef NDEBUG
-    size_t sentBytes = 0;
-#endif
+    getLocalNode()->releaseSendToken( token );
+}
 
-    for( uint32_t j=0; j < pixelDatas.size(); ++j )
+void Channel::_transmitImageBands( const co::ObjectVersion& frameDataVersion,
+                                   const uint128_t& nodeID,
+                                   co::NodePtr toNode, Image* image,
+                                   const uint32_t nBands,
+                                   const uint32_t frameNumber,
+                                   const uint32_t taskID )
+{
+    const Frame::Buffer buffers[] = { Frame::BUFFER_COLOR,Frame::BUFFER_DEPTH };
+    uint32_t commandBuffers = Frame::BUFFER_NONE;
+    uint32_t compressor = EQ_COMPRESSOR_NONE;
+    std::vector< float > qualities;
+    uint64_t rawSize = 0;
+
+    for( unsigned j = 0; j < 2; ++j )
     {
-#ifndef NDEBUG
-        sentBytes += sizeof( FrameData::ImageHeader );
-#endif
-        const PixelData* data = pixelDatas[j];
-        const FrameData::ImageHeader header =
-              { data->internalFormat, data->externalFormat,
-                data->pixelSize, data->pvp,
-                useCompression ? data->compressorName : EQ_COMPRESSOR_NONE,
-                data->compressorFlags,
-                data->isCompressed ? uint32_t( data->compressedSize.size()) : 1,
-                qualities[ j ] };
+        const Frame::Buffer buffer = buffers[j];
+        if( image->hasPixelData( buffer ))
+        {
+            const uint32_t name = image->selectCompressor( buffer );
+            if( compressor == EQ_COMPRESSOR_NONE )
+                compressor = name;
+            qualities.push_back( image->getQuality( buffer ));
+            commandBuffers |= buffer;
+            rawSize += image->getPixelDataSize( buffer );
+        }
+    }
+    if( commandBuffers == Frame::BUFFER_NONE )
+        return;
 
-        connection->send( &header, sizeof( header ), true );
+    detail::Channel::TransmitBands& bands = _impl->transmitBands;
+    while( bands.size() < nBands )
+        bands.push_back( new detail::Channel::TransmitBand );
 
-        if( data->isCompressed )
+    // The bands of an image sent to multiple nodes are compressed only once
+    const bool isCompressed = _impl->bandImage == image &&
+                              _impl->bandVersion == frameDataVersion &&
+                              _impl->nBands == nBands;
+    _impl->bandImage = 0;
+
+    co::LocalNode::SendToken token;
+    if( getIAttribute( IATTR_HINT_SENDTOKEN ) == ON )
+    {
+        ChannelStatistics waitEvent( Statistic::CHANNEL_FRAME_WAIT_SENDTOKEN,
+                                     this, frameNumber );
+        waitEvent.event.statistic.task = taskID;
+        token = getLocalNode()->acquireSendToken( toNode );
+    }
+
+    // always sampled to show the compression decision
+    ChannelStatistics compressEvent( Statistic::CHANNEL_FRAME_COMPRESS, this,
+                                     frameNumber, AUTO );
+    compressEvent.event.statistic.task = taskID;
+    compressEvent.event.statistic.ratio = 1.0f;
+    compressEvent.event.statistic.plugins[0] = EQ_COMPRESSOR_NONE;
+    compressEvent.event.statistic.plugins[1] = EQ_COMPRESSOR_NONE;
+
+    co::ConnectionPtr connection = toNode->getConnection();
+    const PixelViewport& pvp = image->getPixelViewport();
+    uint64_t imageDataSize = 0;
+    float compressTime = 0.f; // of the busiest compressing thread
+    float sendTime = 0.f;
+
+    // Compress bands in parallel, send each one in order as soon as it and all
+    // bands before it are compressed. Cached bands are only sent. Each thread
+    // times only its own compression, excluding the ordered sends and the
+    // waiting for them.
+#pragma omp parallel if( !isCompressed )
+    {
+        float threadTime = 0.f;
+
+#pragma omp for ordered schedule( static, 1 )
+        for( int32_t i = 0; i < int32_t( nBands ); ++i )
         {
-            for( uint32_t k = 0 ; k < data->compressedSize.size(); ++k )
+            detail::Channel::TransmitBand* band = bands[ i ];
+            const int32_t y = i * pvp.h / int32_t( nBands );
+            const int32_t h = ( i + 1 ) * pvp.h / int32_t( nBands ) - y;
+            std::vector< const PixelData* > pixelDatas;
+
+            lunchbox::Clock compressClock;
+            for( unsigned j = 0; j < 2; ++j )
             {
-                const uint64_t dataSize = data->compressedSize[k];
-                connection->send( &dataSize, sizeof( dataSize ), true );
-                if( dataSize > 0 )
-                    connection->send( data->compressedData[k],
-                                      dataSize, true );
-#ifndef NDEBUG
-                sentBytes += sizeof( dataSize ) + dataSize;
-#endif
+                if( !( commandBuffers & buffers[j] ))
+                    continue;
+
+                if( !isCompressed )
+                    image->compressPixelData( buffers[j], y, h,
+                                              band->compressors[j],
+                                              band->pixelData[j] );
+                pixelDatas.push_back( &band->pixelData[j] );
+            }
+            threadTime += compressClock.getTimef();
+
+#pragma omp ordered
+            {
+                lunchbox::Clock clock;
+                _sendImageData( connection, nodeID, frameDataVersion,
+                                PixelViewport( pvp.x, pvp.y + y, pvp.w, h ),
+                                image->getZoom(), commandBuffers, frameNumber,
+                                image->getAlphaUsage(), true, pixelDatas,
+                                qualities );
+                sendTime += clock.getTimef();
+                imageDataSize += _getImageDataSize( pixelDatas );
             }
         }
-        else
-        {
-            const uint64_t dataSize = data->pvp.getArea() *
-                data->pixelSize;
-            connection->send( &dataSize, sizeof( dataSize ), true );
-            connection->send( data->pixels, dataSize, true );
-#ifndef NDEBUG
-            sentBytes += sizeof( dataSize ) + dataSize;
-#endif
-        }
+
+#pragma omp critical
+        compressTime = std::max( compressTime, threadTime );
     }
-#ifndef NDEBUG
-    LBASSERTINFO( sentBytes == imageDataSize,
-        sentBytes << " != " << imageDataSize );
-#endif
 
     getLocalNode()->releaseSendToken( token );
+
+    // Sample the compression time of the busiest thread, which is the time
+    // the parallel compression takes without any sends
+    if( isCompressed )
+        compressTime = 0.f;
+    compressEvent.event.statistic.endTime =
+        compressEvent.event.statistic.startTime + int64_t( compressTime );
+
+    const uint128_t& netNodeID = toNode->getNodeID();
+    // The policy gets the compression and the send times separately, so that
+    // a slow link does not look like a slow compressor. Cached results are
+    // not timed.
+    if( !isCompressed )
+        _impl->compressionPolicy.addCompress( compressor, rawSize,
+                                              imageDataSize, compressTime );
+    _impl->compressionPolicy.addSend( netNodeID, imageDataSize, sendTime );
+
+    _impl->bandImage = image;
+    _impl->bandVersion = frameDataVersion;
+    _impl->nBands = nBands;
+
+    for( unsigned j = 0; j < 2; ++j )
+    {
+        const PixelData& data = bands.front()->pixelData[j];
+        if( ( commandBuffers & buffers[j] ) && data.isCompressed )
+            compressEvent.event.statistic.plugins[j] = data.compressorName;
+    }
+    compressEvent.event.statistic.ratio = static_cast< float >( imageDataSize )/
+                                          static_cast< float >( rawSize );
 }
 
 void Channel::_setReady( const bool async, detail::RBStat* stat )
@@ -1601,6 +1892,7 @@ bool Channel::_cmdConfigInit( co::ICommand& cmd )
     changeLatency( config->getLatency( ));
 
     setError( ERROR_NONE );
+    _impl->contexts.clear();
 
     bool result = false;
     const Window* window = getWindow();
@@ -1651,7 +1943,8 @@ bool Channel::_cmdFrameStart( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
 
-    RenderContext context = command.get< RenderContext >();
+    _impl->contexts.rewind();
+    RenderContext context = _impl->contexts.read( command );
     const uint128_t version = command.get< uint128_t >();
     const uint32_t frameNumber = command.get< uint32_t >();
 
@@ -1680,7 +1973,7 @@ bool Channel::_cmdFrameFinish( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
 
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
     const uint32_t frameNumber = command.get< uint32_t >();
 
     LBLOG( LOG_TASKS ) << "TASK frame finish " << getName() <<  " " << command
@@ -1699,7 +1992,7 @@ bool Channel::_cmdFrameClear( co::ICommand& cmd )
     LBASSERT( _impl->state == STATE_RUNNING );
 
     co::ObjectICommand command( cmd );
-    RenderContext context  = command.get< RenderContext >();
+    RenderContext context  = _impl->contexts.read( command );
 
     LBLOG( LOG_TASKS ) << "TASK clear " << getName() <<  " " << command
                        << " " << context << std::endl;
@@ -1715,7 +2008,7 @@ bool Channel::_cmdFrameClear( co::ICommand& cmd )
 bool Channel::_cmdFrameDraw( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context  = command.get< RenderContext >();
+    RenderContext context  = _impl->contexts.read( command );
     const bool finish = command.get< bool >();
 
     LBLOG( LOG_TASKS ) << "TASK draw " << getName() <<  " " << command
@@ -1731,7 +2024,9 @@ bool Channel::_cmdFrameDraw( co::ICommand& cmd )
     if( !getRegion().isValid( ))
         declareRegion( getPixelViewport( ));
     const size_t index = frameNumber % _impl->statistics->size();
-    _impl->statistics.data[ index ].region = getRegion() / getPixelViewport();
+    detail::Channel::FrameStatistics& stats = _impl->statistics.data[ index ];
+    stats.region = getRegion() / getPixelViewport();
+    _computeCostGrid( getRegions(), getPixelViewport(), stats.costGrid );
 
     resetRenderContext();
 
@@ -1757,7 +2052,7 @@ bool Channel::_cmdFrameDrawFinish( co::ICommand& cmd )
 bool Channel::_cmdFrameAssemble( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
     const co::ObjectVersions frames = command.get< co::ObjectVersions >();
 
     LBLOG( LOG_TASKS | LOG_ASSEMBLY )
@@ -1785,7 +2080,7 @@ bool Channel::_cmdFrameAssemble( co::ICommand& cmd )
 bool Channel::_cmdFrameReadback( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
     const co::ObjectVersions frames = command.get< co::ObjectVersions >();
     LBLOG( LOG_TASKS | LOG_ASSEMBLY ) << "TASK readback " << getName() <<  " "
                                       << command << " " << context<< " nFrames "
@@ -1894,7 +2189,7 @@ bool Channel::_cmdFrameSetReadyNode( co::ICommand& cmd )
 bool Channel::_cmdFrameViewStart( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
 
     LBLOG( LOG_TASKS ) << "TASK view start " << getName() <<  " " << command
                        << " " << context << std::endl;
@@ -1909,7 +2204,7 @@ bool Channel::_cmdFrameViewStart( co::ICommand& cmd )
 bool Channel::_cmdFrameViewFinish( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
 
     LBLOG( LOG_TASKS ) << "TASK view finish " << getName() <<  " " << command
                        << " " << context << std::endl;
@@ -1938,7 +2233,7 @@ bool Channel::_cmdStopFrame( co::ICommand& cmd )
 bool Channel::_cmdFrameTiles( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
-    RenderContext context = command.get< RenderContext >();
+    RenderContext context = _impl->contexts.read( command );
     const bool isLocal = command.get< bool >();
     const UUID& queueID = command.get< UUID >();
     const uint32_t tasks = command.get< uint32_t >();
@@ -597,6 +597,14 @@ namespace detail { class Channel; struct RBStat; }
                              const uint32_t frameNumber,
                              const uint32_t taskID );
 
+        /** Compress and send one image in bands of rows. */
+        void _transmitImageBands( const co::ObjectVersion& frameDataVersion,
+                                  const uint128_t& nodeID,
+                                  co::NodePtr toNode, Image* image,
+                                  const uint32_t nBands,
+                                  const uint32_t frameNumber,
+                                  const uint32_t taskID );
+
         void _frameReadback( const uint128_t& frameID,
                              const co::ObjectVersions& frames );
         void _finishReadback( const co::ObjectVersion& frameDataVersion,
@@ -34,6 +34,7 @@
 #include "server.h"
 #include "window.h"
 #include "windowSystem.h"
+#include "detail/cpuCompositor.h"
 
 #include <eq/util/accum.h>
 #include <eq/util/frameBufferObject.h>
@@ -797,6 +798,8 @@ void Compositor::_mergeDBImage( void* destColor, void* destDepth,
     uint32_t* destD = reinterpret_cast< uint32_t* >( destDepth );
 
     const PixelViewport&  pvp    = image->getPixelViewport();
+    LBASSERT( image->getPixelSize( Frame::BUFFER_COLOR ) == 4 );
+    LBASSERT( image->getPixelSize( Frame::BUFFER_DEPTH ) == 4 );
 
 #ifdef EQ_USE_PARACOMP_DEPTH
     if( pvp == destPVP && offset == eq::Vector2i::ZERO )
@@ -817,27 +820,22 @@ void Compositor::_mergeDBImage( void* destColor, void* destDepth,
     const uint32_t* depth = reinterpret_cast< const uint32_t* >
         ( image->getPixelPointer( Frame::BUFFER_DEPTH ));
 
-#pragma omp parallel for
-    for( int32_t y = 0; y < pvp.h; ++y )
-    {
-        const uint32_t skip =  (destY + y) * destPVP.w + destX;
-        uint32_t* destColorIt = destC + skip;
-        uint32_t* destDepthIt = destD + skip;
-        const uint32_t* colorIt = color + y * pvp.w;
-        const uint32_t* depthIt = depth + y * pvp.w;
+    // Merge tile-by-tile to keep the four buffers of a tile in the cache
+    const detail::MergeKernels& kernels = detail::getMergeKernels();
+    detail::Tiles tiles;
+    detail::computeTiles( pvp.w, pvp.h, 4 * sizeof( uint32_t ), tiles );
+    const int32_t nTiles = int32_t( tiles.size( ));
 
-        for( int32_t x = 0; x < pvp.w; ++x )
+#pragma omp parallel for schedule( dynamic )
+    for( int32_t i = 0; i < nTiles; ++i )
+    {
+        const detail::Tile& tile = tiles[ i ];
+        for( int32_t y = tile.y; y < tile.y + tile.h; ++y )
         {
-            if( *destDepthIt > *depthIt )
-            {
-                *destColorIt = *colorIt;
-                *destDepthIt = *depthIt;
-            }
-
-            ++destColorIt;
-            ++destDepthIt;
-            ++colorIt;
-            ++depthIt;
+            const uint32_t skip = (destY + y) * destPVP.w + destX + tile.x;
+            const uint32_t offs = y * pvp.w + tile.x;
+            kernels.mergeDepth( destC + skip, destD + skip, color + offs,
+                                depth + offs, tile.w );
         }
     }
 }
@@ -881,16 +879,26 @@ void Compositor::_mergeBlendImage( void* dest, const eq::PixelViewport& destPVP,
 {
     LBVERB << "CPU-Blend assembly"<< std::endl;
 
-    int32_t* destColor = reinterpret_cast< int32_t* >( dest );
+    uint8_t* destColor = reinterpret_cast< uint8_t* >( dest );
 
     const PixelViewport&  pvp    = image->getPixelViewport();
     const int32_t         destX  = offset.x() + pvp.x - destPVP.x;
     const int32_t         destY  = offset.y() + pvp.y - destPVP.y;
+    const size_t      pixelSize  = image->getPixelSize( Frame::BUFFER_COLOR );
 
-    LBASSERT( image->getPixelSize( Frame::BUFFER_COLOR ) == 4 );
     LBASSERT( image->hasPixelData( Frame::BUFFER_COLOR ));
     LBASSERT( image->hasAlpha( ));
 
+    const detail::MergeKernels& kernels = detail::getMergeKernels();
+    const detail::MergeBlendFunc mergeBlend = kernels.getMergeBlend(pixelSize);
+    if( !mergeBlend )
+    {
+        LBWARN << "Blend compositing of " << pixelSize << " byte pixels not "
+               << "implemented, image ignored" << std::endl;
+        LBUNIMPLEMENTED;
+        return;
+    }
+
 #ifdef EQ_USE_PARACOMP_BLEND
     if( pvp == destPVP && offset == eq::Vector2i::ZERO )
     {
@@ -903,8 +911,7 @@ void Compositor::_mergeBlendImage( void* dest, const eq::PixelViewport& destPVP,
     }
 #endif
 
-    const int32_t* color = reinterpret_cast< const int32_t* >
-                               ( image->getPixelPointer( Frame::BUFFER_COLOR ));
+    const uint8_t* color = image->getPixelPointer( Frame::BUFFER_COLOR );
 
     // Blending of two slices, none of which is on final image (i.e. result
     // could be blended on to something else) should be performed with:
@@ -915,26 +922,20 @@ void Compositor::_mergeBlendImage( void* dest, const eq::PixelViewport& destPVP,
     // because we accumulate light which is go through (= 1-Alpha) and we
     // already have colors as Alpha*Color
 
-    int32_t* destColorStart = destColor + destY*destPVP.w + destX;
-    const uint32_t step = sizeof( int32_t );
+    detail::Tiles tiles;
+    detail::computeTiles( pvp.w, pvp.h, 2 * pixelSize, tiles );
+    const int32_t nTiles = int32_t( tiles.size( ));
 
-#pragma omp parallel for
-    for( int32_t y = 0; y < pvp.h; ++y )
+#pragma omp parallel for schedule( dynamic )
+    for( int32_t i = 0; i < nTiles; ++i )
     {
-        const unsigned char* src =
-            reinterpret_cast< const uint8_t* >( color + pvp.w * y );
-        unsigned char*       dst =
-            reinterpret_cast< uint8_t* >( destColorStart + destPVP.w * y );
-
-        for( int32_t x = 0; x < pvp.w; ++x )
+        const detail::Tile& tile = tiles[ i ];
+        for( int32_t y = tile.y; y < tile.y + tile.h; ++y )
         {
-            dst[0] = LB_MIN( src[0] + (src[3]*dst[0] >> 8), 255 );
-            dst[1] = LB_MIN( src[1] + (src[3]*dst[1] >> 8), 255 );
-            dst[2] = LB_MIN( src[2] + (src[3]*dst[2] >> 8), 255 );
-            dst[3] =                   src[3]*dst[3] >> 8;
-
-            src += step;
-            dst += step;
+            const size_t skip = ( size_t( destY + y ) * destPVP.w +
+                                  destX + tile.x ) * pixelSize;
+            const size_t offs = ( size_t( y ) * pvp.w + tile.x ) * pixelSize;
+            mergeBlend( destColor + skip, color + offs, tile.w );
         }
     }
 }
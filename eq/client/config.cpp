@@ -38,6 +38,7 @@
 #include "server.h"
 #include "view.h"
 #include "window.h"
+#include "detail/statisticQueue.h"
 
 #include <eq/fabric/commands.h>
 #include <eq/fabric/task.h>
@@ -136,6 +137,12 @@ public:
     lunchbox::Lockable< GLStats::Data, lunchbox::SpinLock > statistics;
 #endif
 
+    /** Statistics of the local threads, sent once per frame. */
+    StatisticQueue statisticQueue;
+
+    /** Received statistics batch, used by the command thread. */
+    StatisticQueue::Items statisticItems;
+
     /** The last started frame. */
     uint32_t currentFrame;
     /** The last locally released frame. */
@@ -212,6 +219,8 @@ void Config::attach( const UUID& id, const uint32_t instanceID )
                      ConfigFunc( this, &Config::_cmdSyncClock ), 0 );
     registerCommand( fabric::CMD_CONFIG_SWAP_OBJECT,
                      ConfigFunc( this, &Config::_cmdSwapObject ), 0 );
+    registerCommand( fabric::CMD_CONFIG_STATISTICS,
+                     ConfigFunc( this, &Config::_cmdStatistics ), 0 );
 }
 
 void Config::notifyAttached()
@@ -702,6 +711,27 @@ bool Config::_handleEvent( const Event& event )
 
 void Config::addStatistic( const uint32_t originator, const Statistic& stat )
 {
+#ifdef EQ_USE_GLSTATS
+    lunchbox::ScopedFastWrite mutex( _impl->statistics );
+    _addStatistic( originator, stat );
+#endif
+}
+
+void Config::sendStatistic( const Event& event )
+{
+    LBASSERT( event.type == Event::STATISTIC );
+    LBASSERT( event.statistic.type != Statistic::NONE );
+    _impl->statisticQueue.push( event );
+}
+
+void Config::flushStatistics()
+{
+    _impl->statisticQueue.flush( *this, _impl->appNode,
+                                 fabric::CMD_CONFIG_STATISTICS );
+}
+
+void Config::_addStatistic( const uint32_t originator, const Statistic& stat )
+{
 #ifdef EQ_USE_GLSTATS
     const uint32_t frame = stat.frameNumber;
     LBASSERT( stat.type != Statistic::NONE );
@@ -710,7 +740,6 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
     if( frame == 0 || stat.type == Statistic::NONE )
         return;
 
-    lunchbox::ScopedFastWrite mutex( _impl->statistics );
     GLStats::Item item;
     item.entity = originator;
     item.type = stat.type;
@@ -766,10 +795,12 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
           type.group = "window";
           break;
       case Statistic::NODE_FRAME_DECOMPRESS:
+      case Statistic::NODE_FRAME_TASKS:
           type.group = "node";
           break;
 
       case Statistic::CONFIG_WAIT_FINISH_FRAME:
+      case Statistic::CONFIG_UPDATE_FRAME:
           item.layer = 1;
           // no break;
       case Statistic::CONFIG_START_FRAME:
@@ -815,6 +846,13 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
       case Statistic::CHANNEL_READBACK:
       {
           std::stringstream text;
+          if( stat.type == Statistic::CHANNEL_FRAME_COMPRESS &&
+              stat.plugins[ 0 ] <= EQ_COMPRESSOR_NONE &&
+              stat.plugins[ 1 ] <= EQ_COMPRESSOR_NONE )
+          {
+              item.text = "off"; // not compressed by transmission policy
+              break;
+          }
           text << unsigned( 100.f * stat.ratio ) << '%';
 
           if( stat.plugins[ 0 ] > EQ_COMPRESSOR_NONE )
@@ -827,6 +865,16 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
           item.text = text.str();
           break;
       }
+      case Statistic::NODE_FRAME_TASKS:
+      {
+          std::stringstream text;
+          if( stat.size < 10240 )
+              text << stat.size << 'B';
+          else
+              text << ( stat.size + 512 ) / 1024 << "KB";
+          item.text = text.str();
+          break;
+      }
       default:
           break;
     }
@@ -1205,6 +1253,27 @@ bool Config::_cmdSyncClock( co::ICommand& cmd )
     return true;
 }
 
+bool Config::_cmdStatistics( co::ICommand& cmd )
+{
+    co::ObjectICommand command( cmd );
+    StatisticQueue::Items& items = _impl->statisticItems;
+    _impl->statisticQueue.read( command, items );
+
+    // Pass each statistic as an event to handleEvent(), which adds it to the
+    // statistics overlay and lets applications observe it.
+    Event event;
+    event.type = Event::STATISTIC;
+    for( StatisticQueue::Items::const_iterator i = items.begin();
+         i != items.end(); ++i )
+    {
+        event.serial = i->serial;
+        event.originator = i->originator;
+        event.statistic = i->statistic;
+        sendEvent( Event::STATISTIC ) << event;
+    }
+    return true;
+}
+
 bool Config::_cmdSwapObject( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
@@ -450,6 +450,20 @@ namespace detail { class Config; }
         /** @internal Set up appNode connections configured by server. */
         void setupServerConnections( const std::string& connectionData );
 
+        /**
+         * @internal
+         * Queue a statistic event for the next flushStatistics(). Thread safe.
+         *
+         * The statistics of a frame are sent as one batch. The application
+         * node passes each of them to handleEvent() as a STATISTIC event.
+         *
+         * @param event the statistic event.
+         */
+        void sendStatistic( const Event& event );
+
+        /** @internal Send the queued statistics to the application node. */
+        void flushStatistics();
+
     protected:
         /** @internal */
         EQ_API virtual void attach( const UUID& id,
@@ -481,6 +495,9 @@ namespace detail { class Config; }
          */
         void _updateStatistics( const uint32_t finishedFrame );
 
+        /** Add a statistic to the overlay, with the statistics locked. */
+        void _addStatistic( const uint32_t originator, const Statistic& stat );
+
         /** Release all deregistered buffered objects after their latency is
             done. */
         void _releaseObjects();
@@ -499,6 +516,7 @@ namespace detail { class Config; }
         bool _cmdReleaseFrameLocal( co::ICommand& command );
         bool _cmdFrameFinish( co::ICommand& command );
         bool _cmdSwapObject( co::ICommand& command );
+        bool _cmdStatistics( co::ICommand& command );
     };
 }
 
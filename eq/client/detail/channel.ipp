@@ -39,6 +39,8 @@ public:
             : state( STATE_STOPPED )
             , fbo( 0 )
             , initialSize( Vector2i::ZERO )
+            , bandImage( 0 )
+            , nBands( 0 )
 #ifdef EQ_USE_SAGE
             , _sageProxy( 0 )
 #endif
@@ -53,6 +55,11 @@ public:
         {
             statistics->clear();
             LBASSERT( !fbo );
+            for( TransmitBandsCIter i = transmitBands.begin();
+                 i != transmitBands.end(); ++i )
+            {
+                delete *i;
+            }
         }
 
     /** The channel's drawable config (FBO). */
@@ -78,6 +85,8 @@ public:
     {
         Statistics data; //!< all events for one frame
         eq::Viewport region; //!< from draw for equalizers
+        Vectorub costGrid; //!< region coverage from draw for equalizers
+        TileTimes tileTimes; //!< from tile rendering for tile equalizers
         /** reference count by pipe and transmit thread */
         lunchbox::a_int32_t used;
     };
@@ -98,6 +107,31 @@ public:
     /** The number of the last finished frame. */
     lunchbox::Monitor< uint32_t > finishedFrame;
 
+    /** Compression state for one band of a streamed image transmission. */
+    struct TransmitBand
+    {
+        ~TransmitBand() { compressors[0].clear(); compressors[1].clear(); }
+
+        lunchbox::Compressor compressors[2]; //!< color, depth
+        PixelData pixelData[2]; //!< color, depth
+    };
+    typedef std::vector< TransmitBand* > TransmitBands;
+    typedef TransmitBands::const_iterator TransmitBandsCIter;
+
+    /** Reused band state, only accessed from the transmit thread. */
+    TransmitBands transmitBands;
+
+    /** The image compressed in the transmit bands, reused for all nodes. */
+    const Image* bandImage;
+    co::ObjectVersion bandVersion; //!< the frame data of the band image
+    uint32_t nBands; //!< the number of compressed bands of the band image
+
+    /** Compression decisions for image transmission, transmit thread only. */
+    CompressionPolicy compressionPolicy;
+
+    /** The render contexts of the last frame's tasks, pipe thread only. */
+    fabric::RenderContextCache contexts;
+
 #ifdef EQ_USE_SAGE
     SageProxy* _sageProxy;
 #endif
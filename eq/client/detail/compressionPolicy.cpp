@@ -0,0 +1,101 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "compressionPolicy.h"
+
+#include <lunchbox/plugins/compressor.h>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** Weight of a new sample in the running averages. */
+static const float _weight = 0.25f;
+
+/** Use the option not chosen once every this many decisions. */
+static const uint32_t _probeInterval = 64;
+
+/** Raw link bandwidth up to which compression is used without measurements. */
+static const int64_t _defaultBandwidth = 262144; // 2 GBit/s in KB/s
+}
+
+void CompressionPolicy::Throughput::add( const uint64_t size, const float time,
+                                         const float ratio_ )
+{
+    const float sample = float( size ) / time;
+    if( value == 0.f )
+    {
+        value = sample;
+        ratio = ratio_;
+        return;
+    }
+    value += _weight * ( sample - value );
+    ratio += _weight * ( ratio_ - ratio );
+}
+
+bool CompressionPolicy::useCompression( const uint128_t& node,
+                                        const int64_t bandwidth,
+                                        const uint32_t compressor,
+                                        const uint64_t rawSize )
+{
+    if( compressor <= EQ_COMPRESSOR_NONE )
+        return false;
+
+    bool compress = bandwidth <= _defaultBandwidth;
+    const CompressorThroughputs::const_iterator i =
+        _compressors.find( compressor );
+
+    if( i != _compressors.end( ))
+    {
+        // KB/s to bytes/ms until the link has been measured
+        const NodeThroughputs::const_iterator j = _nodes.find( node );
+        const float send = j == _nodes.end() ? float( bandwidth ) * 1.024f :
+                                               j->second.value;
+        const float size = float( rawSize );
+        const float rawTime = size / send;
+        const float compressedTime = 2.f * size / i->second.value +
+                                     size * i->second.ratio / send;
+        compress = send <= 0.f || compressedTime < rawTime;
+    }
+
+    if( ++_nDecisions % _probeInterval == 0 )
+        return !compress;
+    return compress;
+}
+
+void CompressionPolicy::addCompress( const uint32_t compressor,
+                                     const uint64_t rawSize,
+                                     const uint64_t compressedSize,
+                                     const float time )
+{
+    if( compressor <= EQ_COMPRESSOR_NONE || rawSize == 0 || time <= 0.f )
+        return;
+    _compressors[ compressor ].add( rawSize, time,
+                                    float( compressedSize ) / float( rawSize ));
+}
+
+void CompressionPolicy::addSend( const uint128_t& node, const uint64_t size,
+                                 const float time )
+{
+    if( size == 0 || time <= 0.f )
+        return;
+    _nodes[ node ].add( size, time, 1.f );
+}
+
+}
+}
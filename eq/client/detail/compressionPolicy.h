@@ -0,0 +1,87 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_COMPRESSIONPOLICY_H
+#define EQ_DETAIL_COMPRESSIONPOLICY_H
+
+#include <lunchbox/types.h>
+#include <map>
+
+namespace eq
+{
+namespace detail
+{
+/**
+ * Decides per image transmission if compression pays off.
+ *
+ * The policy keeps running averages of the achieved send throughput per
+ * destination node and of the throughput and ratio per compressor. For each
+ * image it predicts the time to send the raw data and the time to compress,
+ * send and decompress it, and picks the faster option. Decompression is
+ * assumed to run at the measured compression throughput, since the receiver
+ * does not report its timing back. Every so often the option not chosen is
+ * used once to keep its estimate current.
+ *
+ * Not thread safe, used by the transmit thread only.
+ */
+class CompressionPolicy
+{
+public:
+    CompressionPolicy() : _nDecisions( 0 ) {}
+
+    /**
+     * Decide if an image is to be compressed.
+     *
+     * @param node the identifier of the destination node.
+     * @param bandwidth the configured bandwidth of the connection to the node,
+     *                  in KB/s, used until the throughput has been measured.
+     * @param compressor the compressor which would be used.
+     * @param rawSize the size of the uncompressed image data.
+     * @return true if the image should be compressed.
+     */
+    bool useCompression( const uint128_t& node, const int64_t bandwidth,
+                         const uint32_t compressor, const uint64_t rawSize );
+
+    /** Account a finished compression of rawSize bytes to compressedSize. */
+    void addCompress( const uint32_t compressor, const uint64_t rawSize,
+                      const uint64_t compressedSize, const float time );
+
+    /** Account a finished send of size bytes to the given node. */
+    void addSend( const uint128_t& node, const uint64_t size,
+                  const float time );
+
+private:
+    /** Running average of a throughput, in bytes per millisecond. */
+    struct Throughput
+    {
+        Throughput() : value( 0.f ), ratio( 1.f ) {}
+        void add( const uint64_t size, const float time, const float ratio );
+
+        float value;
+        float ratio; //!< compressed to raw size, compressors only
+    };
+
+    typedef std::map< uint128_t, Throughput > NodeThroughputs;
+    typedef std::map< uint32_t, Throughput > CompressorThroughputs;
+
+    NodeThroughputs _nodes;
+    CompressorThroughputs _compressors;
+    uint32_t _nDecisions;
+};
+}
+}
+
+#endif // EQ_DETAIL_COMPRESSIONPOLICY_H
@@ -0,0 +1,482 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "cpuCompositor.h"
+#include "simd.h"
+#include "../half.h"
+
+#include <algorithm>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** Bytes touched by one tile over all buffers, sized to fit a L2 cache. */
+static const size_t _tileCacheSize = 256 * 1024;
+
+/** Maximum tile width in pixels, keeps rows of a tile contiguous enough. */
+static const int32_t _maxTileWidth = 1024;
+
+void _mergeDepthScalar( uint32_t* destColor, uint32_t* destDepth,
+                        const uint32_t* color, const uint32_t* depth,
+                        const size_t nPixels )
+{
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        if( destDepth[i] > depth[i] )
+        {
+            destColor[i] = color[i];
+            destDepth[i] = depth[i];
+        }
+    }
+}
+
+void _mergeBlendRGBA8Scalar( void* dest, const void* source,
+                             const size_t nPixels )
+{
+    uint8_t* dst = reinterpret_cast< uint8_t* >( dest );
+    const uint8_t* src = reinterpret_cast< const uint8_t* >( source );
+
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        dst[0] = uint8_t( std::min( src[0] + (src[3]*dst[0] >> 8), 255 ));
+        dst[1] = uint8_t( std::min( src[1] + (src[3]*dst[1] >> 8), 255 ));
+        dst[2] = uint8_t( std::min( src[2] + (src[3]*dst[2] >> 8), 255 ));
+        dst[3] = uint8_t(                     src[3]*dst[3] >> 8 );
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+void _mergeBlendRGBA16FScalar( void* dest, const void* source,
+                               const size_t nPixels )
+{
+    uint16_t* dst = reinterpret_cast< uint16_t* >( dest );
+    const uint16_t* src = reinterpret_cast< const uint16_t* >( source );
+
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        const float alpha = half_to_float( src[3] );
+        for( size_t j = 0; j < 3; ++j )
+            dst[j] = half_from_float( half_to_float( src[j] ) +
+                                      alpha * half_to_float( dst[j] ));
+        dst[3] = half_from_float( alpha * half_to_float( dst[3] ));
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+void _mergeBlendRGBA32FScalar( void* dest, const void* source,
+                               const size_t nPixels )
+{
+    float* dst = reinterpret_cast< float* >( dest );
+    const float* src = reinterpret_cast< const float* >( source );
+
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        dst[0] = src[0] + src[3] * dst[0];
+        dst[1] = src[1] + src[3] * dst[1];
+        dst[2] = src[2] + src[3] * dst[2];
+        dst[3] = src[3] * dst[3];
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+#ifdef EQ_CPU_X86
+#  ifdef _MSC_VER
+void _cpuid( const int leaf, int registers[4] )
+{
+    __cpuidex( registers, leaf, 0 );
+}
+
+uint64_t _getXCR0()
+{
+    return _xgetbv( 0 );
+}
+#  else
+void _cpuid( const int leaf, int registers[4] )
+{
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __cpuid_count( leaf, 0, eax, ebx, ecx, edx );
+    registers[0] = int( eax );
+    registers[1] = int( ebx );
+    registers[2] = int( ecx );
+    registers[3] = int( edx );
+}
+
+uint64_t _getXCR0()
+{
+    uint32_t eax = 0, edx = 0;
+    // xgetbv, spelled out for assemblers which do not know the mnemonic
+    __asm__ __volatile__( ".byte 0x0f, 0x01, 0xd0"
+                          : "=a"( eax ), "=d"( edx ) : "c"( 0 ));
+    return ( uint64_t( edx ) << 32 ) | eax;
+}
+#  endif
+
+SIMD _detectSIMD()
+{
+    int registers[4] = { 0, 0, 0, 0 };
+    _cpuid( 0, registers );
+    const int maxLeaf = registers[0];
+    if( maxLeaf < 1 )
+        return SIMD_NONE;
+
+    _cpuid( 1, registers );
+    const bool hasSSE2 = ( registers[3] & ( 1 << 26 )) != 0;
+    const bool hasOSXSave = ( registers[2] & ( 1 << 27 )) != 0;
+    const bool hasAVX = ( registers[2] & ( 1 << 28 )) != 0;
+    const bool hasF16C = ( registers[2] & ( 1 << 29 )) != 0;
+    if( !hasSSE2 )
+        return SIMD_NONE;
+
+    if( maxLeaf < 7 || !hasOSXSave || !hasAVX || !hasF16C )
+        return SIMD_SSE2;
+
+    // The OS has to save the upper halves of the ymm registers
+    if(( _getXCR0() & 0x6 ) != 0x6 )
+        return SIMD_SSE2;
+
+    _cpuid( 7, registers );
+    const bool hasAVX2 = ( registers[1] & ( 1 << 5 )) != 0;
+    return hasAVX2 ? SIMD_AVX2 : SIMD_SSE2;
+}
+
+// SSE2 and AVX2 only have signed 32 bit compares. Flipping the sign bit maps
+// the unsigned depth range onto the signed range, preserving the order.
+EQ_TARGET_SSE2
+void _mergeDepthSSE2( uint32_t* destColor, uint32_t* destDepth,
+                      const uint32_t* color, const uint32_t* depth,
+                      const size_t nPixels )
+{
+    const __m128i bias = _mm_set1_epi32( int( 0x80000000u ));
+    size_t i = 0;
+    for( ; i + 4 <= nPixels; i += 4 )
+    {
+        __m128i* destC = reinterpret_cast< __m128i* >( destColor + i );
+        __m128i* destD = reinterpret_cast< __m128i* >( destDepth + i );
+        const __m128i srcC = _mm_loadu_si128(
+                              reinterpret_cast< const __m128i* >( color + i ));
+        const __m128i srcD = _mm_loadu_si128(
+                              reinterpret_cast< const __m128i* >( depth + i ));
+        const __m128i dstC = _mm_loadu_si128( destC );
+        const __m128i dstD = _mm_loadu_si128( destD );
+
+        const __m128i mask = _mm_cmpgt_epi32( _mm_xor_si128( dstD, bias ),
+                                              _mm_xor_si128( srcD, bias ));
+        _mm_storeu_si128( destC, _mm_or_si128( _mm_and_si128( mask, srcC ),
+                                               _mm_andnot_si128( mask, dstC )));
+        _mm_storeu_si128( destD, _mm_or_si128( _mm_and_si128( mask, srcD ),
+                                               _mm_andnot_si128( mask, dstD )));
+    }
+    _mergeDepthScalar( destColor + i, destDepth + i, color + i, depth + i,
+                       nPixels - i );
+}
+
+
+// The 8 bit blend widens to 16 bit lanes, where src.a * dest fits without
+// overflow. The saturated add of the source color, with the source alpha
+// masked out, yields exactly min( src + (src.a * dest >> 8), 255 ).
+EQ_TARGET_SSE2
+inline __m128i _blendRGBA8SSE2( const __m128i src, const __m128i dst )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32( int( 0xff000000u ));
+
+    __m128i alphaLo = _mm_unpacklo_epi8( src, zero );
+    __m128i alphaHi = _mm_unpackhi_epi8( src, zero );
+    alphaLo = _mm_shufflelo_epi16( alphaLo, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaLo = _mm_shufflehi_epi16( alphaLo, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaHi = _mm_shufflelo_epi16( alphaHi, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaHi = _mm_shufflehi_epi16( alphaHi, _MM_SHUFFLE( 3, 3, 3, 3 ));
+
+    const __m128i lo = _mm_srli_epi16(
+        _mm_mullo_epi16( alphaLo, _mm_unpacklo_epi8( dst, zero )), 8 );
+    const __m128i hi = _mm_srli_epi16(
+        _mm_mullo_epi16( alphaHi, _mm_unpackhi_epi8( dst, zero )), 8 );
+
+    return _mm_adds_epu8( _mm_andnot_si128( alphaMask, src ),
+                          _mm_packus_epi16( lo, hi ));
+}
+
+EQ_TARGET_SSE2
+void _mergeBlendRGBA8SSE2( void* dest, const void* source,
+                           const size_t nPixels )
+{
+    __m128i* dst = reinterpret_cast< __m128i* >( dest );
+    const __m128i* src = reinterpret_cast< const __m128i* >( source );
+
+    size_t i = 0;
+    for( ; i + 16 <= nPixels; i += 16, dst += 4, src += 4 )
+    {
+        const __m128i result0 = _blendRGBA8SSE2( _mm_loadu_si128( src ),
+                                                 _mm_loadu_si128( dst ));
+        const __m128i result1 = _blendRGBA8SSE2( _mm_loadu_si128( src + 1 ),
+                                                 _mm_loadu_si128( dst + 1 ));
+        const __m128i result2 = _blendRGBA8SSE2( _mm_loadu_si128( src + 2 ),
+                                                 _mm_loadu_si128( dst + 2 ));
+        const __m128i result3 = _blendRGBA8SSE2( _mm_loadu_si128( src + 3 ),
+                                                 _mm_loadu_si128( dst + 3 ));
+        _mm_storeu_si128( dst, result0 );
+        _mm_storeu_si128( dst + 1, result1 );
+        _mm_storeu_si128( dst + 2, result2 );
+        _mm_storeu_si128( dst + 3, result3 );
+    }
+    _mergeBlendRGBA8Scalar( dst, src, nPixels - i );
+}
+
+EQ_TARGET_SSE2
+void _mergeBlendRGBA32FSSE2( void* dest, const void* source,
+                             const size_t nPixels )
+{
+    float* dst = reinterpret_cast< float* >( dest );
+    const float* src = reinterpret_cast< const float* >( source );
+    const __m128 colorMask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ));
+
+    for( size_t i = 0; i < nPixels; ++i, dst += 4, src += 4 )
+    {
+        const __m128 srcPixel = _mm_loadu_ps( src );
+        const __m128 alpha = _mm_shuffle_ps( srcPixel, srcPixel,
+                                             _MM_SHUFFLE( 3, 3, 3, 3 ));
+        const __m128 product = _mm_mul_ps( alpha, _mm_loadu_ps( dst ));
+        _mm_storeu_ps( dst, _mm_add_ps( product,
+                                        _mm_and_ps( srcPixel, colorMask )));
+    }
+}
+
+EQ_TARGET_AVX2
+void _mergeDepthAVX2( uint32_t* destColor, uint32_t* destDepth,
+                      const uint32_t* color, const uint32_t* depth,
+                      const size_t nPixels )
+{
+    const __m256i bias = _mm256_set1_epi32( int( 0x80000000u ));
+    size_t i = 0;
+    for( ; i + 8 <= nPixels; i += 8 )
+    {
+        __m256i* destC = reinterpret_cast< __m256i* >( destColor + i );
+        __m256i* destD = reinterpret_cast< __m256i* >( destDepth + i );
+        const __m256i srcC = _mm256_loadu_si256(
+                              reinterpret_cast< const __m256i* >( color + i ));
+        const __m256i srcD = _mm256_loadu_si256(
+                              reinterpret_cast< const __m256i* >( depth + i ));
+        const __m256i dstC = _mm256_loadu_si256( destC );
+        const __m256i dstD = _mm256_loadu_si256( destD );
+
+        const __m256i mask = _mm256_cmpgt_epi32(
+            _mm256_xor_si256( dstD, bias ), _mm256_xor_si256( srcD, bias ));
+        _mm256_storeu_si256( destC, _mm256_blendv_epi8( dstC, srcC, mask ));
+        _mm256_storeu_si256( destD, _mm256_blendv_epi8( dstD, srcD, mask ));
+    }
+    _mergeDepthScalar( destColor + i, destDepth + i, color + i, depth + i,
+                       nPixels - i );
+}
+
+EQ_TARGET_AVX2
+inline __m256i _blendRGBA8AVX2( const __m256i src, const __m256i dst )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32( int( 0xff000000u ));
+
+    __m256i alphaLo = _mm256_unpacklo_epi8( src, zero );
+    __m256i alphaHi = _mm256_unpackhi_epi8( src, zero );
+    alphaLo = _mm256_shufflelo_epi16( alphaLo, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaLo = _mm256_shufflehi_epi16( alphaLo, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaHi = _mm256_shufflelo_epi16( alphaHi, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alphaHi = _mm256_shufflehi_epi16( alphaHi, _MM_SHUFFLE( 3, 3, 3, 3 ));
+
+    const __m256i lo = _mm256_srli_epi16(
+        _mm256_mullo_epi16( alphaLo, _mm256_unpacklo_epi8( dst, zero )), 8 );
+    const __m256i hi = _mm256_srli_epi16(
+        _mm256_mullo_epi16( alphaHi, _mm256_unpackhi_epi8( dst, zero )), 8 );
+
+    // unpack and pack both operate per 128 bit lane, restoring pixel order
+    return _mm256_adds_epu8( _mm256_andnot_si256( alphaMask, src ),
+                             _mm256_packus_epi16( lo, hi ));
+}
+
+EQ_TARGET_AVX2
+void _mergeBlendRGBA8AVX2( void* dest, const void* source,
+                           const size_t nPixels )
+{
+    __m256i* dst = reinterpret_cast< __m256i* >( dest );
+    const __m256i* src = reinterpret_cast< const __m256i* >( source );
+
+    size_t i = 0;
+    for( ; i + 16 <= nPixels; i += 16, dst += 2, src += 2 )
+    {
+        const __m256i result0 = _blendRGBA8AVX2( _mm256_loadu_si256( src ),
+                                                 _mm256_loadu_si256( dst ));
+        const __m256i result1 = _blendRGBA8AVX2( _mm256_loadu_si256( src + 1 ),
+                                                 _mm256_loadu_si256( dst + 1 ));
+        _mm256_storeu_si256( dst, result0 );
+        _mm256_storeu_si256( dst + 1, result1 );
+    }
+    _mergeBlendRGBA8Scalar( dst, src, nPixels - i );
+}
+
+EQ_TARGET_AVX2
+inline __m256 _blendRGBA32FAVX2( const __m256 src, const __m256 dst )
+{
+    const __m256 colorMask = _mm256_castsi256_ps(
+        _mm256_set_epi32( 0, -1, -1, -1, 0, -1, -1, -1 ));
+    const __m256 alpha = _mm256_shuffle_ps( src, src,
+                                            _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm256_add_ps( _mm256_mul_ps( alpha, dst ),
+                          _mm256_and_ps( src, colorMask ));
+}
+
+EQ_TARGET_AVX2
+void _mergeBlendRGBA16FAVX2( void* dest, const void* source,
+                             const size_t nPixels )
+{
+    __m128i* dst = reinterpret_cast< __m128i* >( dest );
+    const __m128i* src = reinterpret_cast< const __m128i* >( source );
+
+    size_t i = 0;
+    for( ; i + 2 <= nPixels; i += 2, ++dst, ++src )
+    {
+        const __m256 result = _blendRGBA32FAVX2(
+            _mm256_cvtph_ps( _mm_loadu_si128( src )),
+            _mm256_cvtph_ps( _mm_loadu_si128( dst )));
+        _mm_storeu_si128( dst, _mm256_cvtps_ph( result, 0 /*nearest*/ ));
+    }
+    _mergeBlendRGBA16FScalar( dst, src, nPixels - i );
+}
+
+EQ_TARGET_AVX2
+void _mergeBlendRGBA32FAVX2( void* dest, const void* source,
+                             const size_t nPixels )
+{
+    float* dst = reinterpret_cast< float* >( dest );
+    const float* src = reinterpret_cast< const float* >( source );
+
+    size_t i = 0;
+    for( ; i + 2 <= nPixels; i += 2, dst += 8, src += 8 )
+        _mm256_storeu_ps( dst, _blendRGBA32FAVX2( _mm256_loadu_ps( src ),
+                                                  _mm256_loadu_ps( dst )));
+    _mergeBlendRGBA32FScalar( dst, src, nPixels - i );
+}
+#else
+SIMD _detectSIMD() { return SIMD_NONE; }
+#endif
+
+MergeKernels _makeKernels( const SIMD simd )
+{
+    MergeKernels kernels;
+    kernels.simd = SIMD_NONE;
+    kernels.mergeDepth = _mergeDepthScalar;
+    kernels.mergeBlendRGBA8 = _mergeBlendRGBA8Scalar;
+    kernels.mergeBlendRGBA16F = _mergeBlendRGBA16FScalar;
+    kernels.mergeBlendRGBA32F = _mergeBlendRGBA32FScalar;
+
+#ifdef EQ_CPU_X86
+    if( simd >= SIMD_SSE2 )
+    {
+        kernels.simd = SIMD_SSE2;
+        kernels.mergeDepth = _mergeDepthSSE2;
+        kernels.mergeBlendRGBA8 = _mergeBlendRGBA8SSE2;
+        kernels.mergeBlendRGBA32F = _mergeBlendRGBA32FSSE2;
+    }
+    if( simd >= SIMD_AVX2 )
+    {
+        kernels.simd = SIMD_AVX2;
+        kernels.mergeDepth = _mergeDepthAVX2;
+        kernels.mergeBlendRGBA8 = _mergeBlendRGBA8AVX2;
+        kernels.mergeBlendRGBA16F = _mergeBlendRGBA16FAVX2;
+        kernels.mergeBlendRGBA32F = _mergeBlendRGBA32FAVX2;
+    }
+#endif
+    return kernels;
+}
+
+// Initialized once at load time, read-only afterwards
+static const SIMD _simd = _detectSIMD();
+static const MergeKernels _kernels[] = { _makeKernels( SIMD_NONE ),
+                                         _makeKernels( SIMD_SSE2 ),
+                                         _makeKernels( SIMD_AVX2 ) };
+}
+
+SIMD getSIMD()
+{
+    return _simd;
+}
+
+const char* getSIMDName( const SIMD simd )
+{
+    switch( simd )
+    {
+        case SIMD_SSE2: return "SSE2";
+        case SIMD_AVX2: return "AVX2";
+        case SIMD_NONE:
+        default:        return "scalar";
+    }
+}
+
+MergeBlendFunc MergeKernels::getMergeBlend( const size_t pixelSize ) const
+{
+    switch( pixelSize )
+    {
+        case 4:  return mergeBlendRGBA8;
+        case 8:  return mergeBlendRGBA16F;
+        case 16: return mergeBlendRGBA32F;
+        default: return 0;
+    }
+}
+
+const MergeKernels& getMergeKernels( const SIMD simd )
+{
+    return _kernels[ std::min( simd, _simd ) ];
+}
+
+const MergeKernels& getMergeKernels()
+{
+    return _kernels[ _simd ];
+}
+
+void computeTiles( const int32_t w, const int32_t h, const size_t pixelSize,
+                   Tiles& tiles )
+{
+    tiles.clear();
+    if( w <= 0 || h <= 0 )
+        return;
+
+    const int32_t maxArea = int32_t( _tileCacheSize /
+                                     std::max( pixelSize, size_t( 1 )));
+    const int32_t tileWidth = std::min( w, _maxTileWidth );
+    const int32_t tileHeight = std::max( maxArea / tileWidth, 1 );
+
+    for( int32_t y = 0; y < h; y += tileHeight )
+    {
+        for( int32_t x = 0; x < w; x += tileWidth )
+        {
+            Tile tile;
+            tile.x = x;
+            tile.y = y;
+            tile.w = std::min( tileWidth, w - x );
+            tile.h = std::min( tileHeight, h - y );
+            tiles.push_back( tile );
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_CPUCOMPOSITOR_H
+#define EQ_DETAIL_CPUCOMPOSITOR_H
+
+#include <eq/client/api.h>
+#include <lunchbox/types.h>
+#include <vector>
+
+namespace eq
+{
+namespace detail
+{
+/** The instruction set extensions usable by the CPU compositing kernels. */
+enum SIMD
+{
+    SIMD_NONE, //!< Portable scalar code
+    SIMD_SSE2, //!< 128 bit integer SSE2
+    SIMD_AVX2  //!< 256 bit integer AVX2 and F16C conversions
+};
+
+/** @return the best instruction set supported by the CPU and the build. */
+EQ_API SIMD getSIMD();
+
+/** @return the name of the given instruction set, for logging. */
+EQ_API const char* getSIMDName( const SIMD simd );
+
+/**
+ * Z-compare and select one span of pixels.
+ *
+ * For each pixel, copies color and depth from the source to the destination if
+ * the source depth is strictly smaller than the destination depth. The result
+ * is bit-identical for all implementations.
+ */
+typedef void (*MergeDepthFunc)( uint32_t* destColor, uint32_t* destDepth,
+                                const uint32_t* color, const uint32_t* depth,
+                                const size_t nPixels );
+
+/**
+ * Blend one span of premultiplied RGBA pixels onto the destination.
+ *
+ * Computes dest.rgb = src.rgb + src.a * dest.rgb and dest.a = src.a * dest.a,
+ * which corresponds to glBlendFuncSeparate( GL_ONE, GL_SRC_ALPHA, GL_ZERO,
+ * GL_SRC_ALPHA ). The 8 bit kernels saturate and are bit-identical for all
+ * implementations. The float kernels do not clamp, and the 16 bit float kernels
+ * may differ in the rounding of the last bit between implementations.
+ */
+typedef void (*MergeBlendFunc)( void* dest, const void* src,
+                                const size_t nPixels );
+
+/** The set of compositing kernels for one instruction set. */
+struct MergeKernels
+{
+    SIMD simd;
+    MergeDepthFunc mergeDepth;
+    MergeBlendFunc mergeBlendRGBA8;    //!< 4 x uint8_t, alpha last
+    MergeBlendFunc mergeBlendRGBA16F;  //!< 4 x half float, alpha last
+    MergeBlendFunc mergeBlendRGBA32F;  //!< 4 x float, alpha last
+
+    /** @return the blend kernel for the given pixel size, or 0. */
+    MergeBlendFunc getMergeBlend( const size_t pixelSize ) const;
+};
+
+/**
+ * @return the kernels for the given instruction set, or the best kernels
+ *         available on this machine if the instruction set is not supported.
+ */
+EQ_API const MergeKernels& getMergeKernels( const SIMD simd );
+
+/** @return the best kernels available on this machine. */
+EQ_API const MergeKernels& getMergeKernels();
+
+/** A rectangular part of an image, processed as one unit of work. */
+struct Tile
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+};
+typedef std::vector< Tile > Tiles;
+
+/**
+ * Split an image into tiles for a cache-friendly, parallel merge.
+ *
+ * Tiles span at most a fixed amount of memory per input and output buffer, so
+ * that the working set of one tile stays in the per-core cache.
+ *
+ * @param w the image width.
+ * @param h the image height.
+ * @param pixelSize the combined size of all buffers touched per pixel.
+ * @param tiles the output tile list.
+ */
+void computeTiles( const int32_t w, const int32_t h, const size_t pixelSize,
+                   Tiles& tiles );
+}
+}
+
+#endif // EQ_DETAIL_CPUCOMPOSITOR_H
@@ -0,0 +1,445 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "rgbFile.h"
+
+#include "cpuCompositor.h"
+#include "simd.h"
+#include "../half.h"
+
+#include <eq/fabric/pixelViewport.h>
+#include <lunchbox/debug.h>
+#include <lunchbox/file.h>
+#include <lunchbox/plugins/compressor.h>
+
+#include <fstream>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+#define SWAP_SHORT(v) ( v = (v&0xff) << 8 | (v&0xff00) >> 8 )
+#define SWAP_INT(v)   ( v = (v&0xff) << 24 | (v&0xff00) << 8 |      \
+                        (v&0xff0000) >> 8 | (v&0xff000000) >> 24)
+
+/** The largest run of a RLE packet. */
+const size_t _maxRun = 127;
+
+void _putBE( uint8_t* out, const uint32_t value )
+{
+    out[0] = uint8_t( value >> 24 );
+    out[1] = uint8_t( value >> 16 );
+    out[2] = uint8_t( value >> 8 );
+    out[3] = uint8_t( value );
+}
+
+uint32_t _getBE( const uint8_t* in )
+{
+    return uint32_t( in[0] ) << 24 | uint32_t( in[1] ) << 16 |
+           uint32_t( in[2] ) << 8 | uint32_t( in[3] );
+}
+
+/** @return true if the next three bytes are equal. */
+bool _isRun( const uint8_t* in, const uint8_t* end )
+{
+    return in + 2 < end && in[0] == in[1] && in[1] == in[2];
+}
+
+/**
+ * RLE-encode one row of one channel. Runs of three or more equal bytes are
+ * stored as repeat packets, everything else as literal packets.
+ */
+uint8_t* _encodeRow( const uint8_t* in, const size_t width, uint8_t* out )
+{
+    const uint8_t* const end = in + width;
+    while( in < end )
+    {
+        const uint8_t* const start = in;
+        if( _isRun( in, end ))
+        {
+            const uint8_t value = *in;
+            while( in < end && size_t( in - start ) < _maxRun && *in == value )
+                ++in;
+            *out++ = uint8_t( in - start );
+            *out++ = value;
+        }
+        else
+        {
+            while( in < end && size_t( in - start ) < _maxRun &&
+                   !_isRun( in, end ))
+            {
+                ++in;
+            }
+            const size_t n = in - start;
+            *out++ = uint8_t( 0x80 | n );
+            memcpy( out, start, n );
+            out += n;
+        }
+    }
+    *out++ = 0;
+    return out;
+}
+
+/** @return the worst-case size of one encoded row. */
+size_t _getMaxRowSize( const size_t width )
+{
+    return width + ( width + _maxRun - 1 ) / _maxRun + 1;
+}
+
+template< typename T, size_t nChannels >
+void _planarize( uint8_t* planes, const uint8_t* data, const size_t nPixels,
+                 const unsigned* plane )
+{
+    const T* in = reinterpret_cast< const T* >( data );
+    T* out[ nChannels ];
+    for( size_t c = 0; c < nChannels; ++c )
+        out[ c ] = reinterpret_cast< T* >( planes ) + plane[ c ] * nPixels;
+
+    for( size_t i = 0; i < nPixels; ++i, in += nChannels )
+        for( size_t c = 0; c < nChannels; ++c )
+            out[ c ][ i ] = in[ c ];
+}
+
+#ifdef EQ_CPU_X86
+// Transposes 16 RGBA pixels into 16 bytes per channel with three rounds of
+// byte interleaves, followed by one round of 64 bit interleaves.
+EQ_TARGET_SSE2
+void _planarizeRGBA8SSE2( uint8_t* planes, const uint8_t* data,
+                          const size_t nPixels, const unsigned* plane )
+{
+    uint8_t* out[ 4 ];
+    for( size_t c = 0; c < 4; ++c )
+        out[ c ] = planes + plane[ c ] * nPixels;
+
+    const __m128i* in = reinterpret_cast< const __m128i* >( data );
+    size_t i = 0;
+    for( ; i + 16 <= nPixels; i += 16, in += 4 )
+    {
+        const __m128i a0 = _mm_loadu_si128( in );
+        const __m128i a1 = _mm_loadu_si128( in + 1 );
+        const __m128i a2 = _mm_loadu_si128( in + 2 );
+        const __m128i a3 = _mm_loadu_si128( in + 3 );
+
+        const __m128i b0 = _mm_unpacklo_epi8( a0, a1 );
+        const __m128i b1 = _mm_unpackhi_epi8( a0, a1 );
+        const __m128i b2 = _mm_unpacklo_epi8( a2, a3 );
+        const __m128i b3 = _mm_unpackhi_epi8( a2, a3 );
+
+        const __m128i c0 = _mm_unpacklo_epi8( b0, b1 );
+        const __m128i c1 = _mm_unpackhi_epi8( b0, b1 );
+        const __m128i c2 = _mm_unpacklo_epi8( b2, b3 );
+        const __m128i c3 = _mm_unpackhi_epi8( b2, b3 );
+
+        const __m128i d0 = _mm_unpacklo_epi8( c0, c1 ); // 8 x c0, 8 x c1
+        const __m128i d1 = _mm_unpackhi_epi8( c0, c1 ); // 8 x c2, 8 x c3
+        const __m128i d2 = _mm_unpacklo_epi8( c2, c3 );
+        const __m128i d3 = _mm_unpackhi_epi8( c2, c3 );
+
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( out[0] + i ),
+                          _mm_unpacklo_epi64( d0, d2 ));
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( out[1] + i ),
+                          _mm_unpackhi_epi64( d0, d2 ));
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( out[2] + i ),
+                          _mm_unpacklo_epi64( d1, d3 ));
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( out[3] + i ),
+                          _mm_unpackhi_epi64( d1, d3 ));
+    }
+
+    const uint8_t* tail = data + i * 4;
+    for( ; i < nPixels; ++i, tail += 4 )
+        for( size_t c = 0; c < 4; ++c )
+            out[ c ][ i ] = tail[ c ];
+}
+#endif
+
+/** Convert float or half float channels in place to 8 bit. */
+void _toUnsignedByte( lunchbox::Bufferb& planes, const size_t bpc )
+{
+    LBASSERTINFO( bpc == 2 || bpc == 4, bpc );
+    const size_t nValues = planes.getSize() / bpc;
+    uint8_t* out = planes.getData();
+
+    if( bpc == 2 )
+    {
+        const uint16_t* in = reinterpret_cast< const uint16_t* >( out );
+        for( size_t i = 0; i < nValues; ++i )
+            out[i] = uint8_t( half_to_float( in[i] ) * 255.f );
+    }
+    else
+    {
+        const float* in = reinterpret_cast< const float* >( out );
+        for( size_t i = 0; i < nValues; ++i )
+            out[i] = uint8_t( in[i] * 255.f );
+    }
+    planes.resize( nValues );
+}
+}
+
+void RGBHeader::convert()
+{
+#if defined(__i386__) || defined(__amd64__) || defined (__ia64) || \
+    defined(__x86_64) || defined(_WIN32)
+    SWAP_SHORT(magic);
+    SWAP_SHORT(nDimensions);
+    SWAP_SHORT(width);
+    SWAP_SHORT(height);
+    SWAP_SHORT(depth);
+    SWAP_INT(minValue);
+    SWAP_INT(maxValue);
+    SWAP_INT(colorMode);
+#endif
+}
+
+PlanarizeFunc getPlanarize( const size_t bpc, const size_t nChannels,
+                            const SIMD simd )
+{
+    switch( bpc * 8 + nChannels )
+    {
+        case 1 * 8 + 3: return _planarize< uint8_t, 3 >;
+        case 1 * 8 + 4:
+#ifdef EQ_CPU_X86
+            if( simd >= SIMD_SSE2 && getSIMD() >= SIMD_SSE2 )
+                return _planarizeRGBA8SSE2;
+#endif
+            return _planarize< uint8_t, 4 >;
+        case 2 * 8 + 3: return _planarize< uint16_t, 3 >;
+        case 2 * 8 + 4: return _planarize< uint16_t, 4 >;
+        case 4 * 8 + 3: return _planarize< uint32_t, 3 >;
+        case 4 * 8 + 4: return _planarize< uint32_t, 4 >;
+        default:        return 0;
+    }
+}
+
+bool RGBWriter::write( const std::string& filename, const uint8_t* data,
+                       const PixelViewport& pvp, const uint32_t format,
+                       const bool compress )
+{
+    const size_t nPixels = pvp.w * pvp.h;
+    if( nPixels == 0 || !data )
+        return false;
+
+    RGBHeader header;
+    header.width  = pvp.w;
+    header.height = pvp.h;
+
+    switch( format )
+    {
+        case EQ_COMPRESSOR_DATATYPE_RGB10_A2:
+            header.maxValue = 1023;
+        case EQ_COMPRESSOR_DATATYPE_BGRA:
+        case EQ_COMPRESSOR_DATATYPE_BGRA_UINT_8_8_8_8_REV:
+        case EQ_COMPRESSOR_DATATYPE_RGBA:
+        case EQ_COMPRESSOR_DATATYPE_RGBA_UINT_8_8_8_8_REV:
+            header.bytesPerChannel = 1;
+            header.depth = 4;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_BGR:
+        case EQ_COMPRESSOR_DATATYPE_RGB:
+            header.bytesPerChannel = 1;
+            header.depth = 3;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_BGRA32F:
+        case EQ_COMPRESSOR_DATATYPE_RGBA32F:
+            header.bytesPerChannel = 4;
+            header.depth = 4;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_BGR32F:
+        case EQ_COMPRESSOR_DATATYPE_RGB32F:
+            header.bytesPerChannel = 4;
+            header.depth = 3;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_BGRA16F:
+        case EQ_COMPRESSOR_DATATYPE_RGBA16F:
+            header.bytesPerChannel = 2;
+            header.depth = 4;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_BGR16F:
+        case EQ_COMPRESSOR_DATATYPE_RGB16F:
+            header.bytesPerChannel = 2;
+            header.depth = 3;
+            break;
+        case EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT:
+            header.bytesPerChannel = 4;
+            header.depth = 1;
+            break;
+
+        default:
+            LBERROR << "Unknown image pixel data type" << std::endl;
+            return false;
+    }
+
+    // Swap red & blue where needed
+    bool swapRB = false;
+    switch( format )
+    {
+        case EQ_COMPRESSOR_DATATYPE_RGB10_A2:
+        case EQ_COMPRESSOR_DATATYPE_RGBA:
+        case EQ_COMPRESSOR_DATATYPE_RGBA_UINT_8_8_8_8_REV:
+        case EQ_COMPRESSOR_DATATYPE_RGB:
+        case EQ_COMPRESSOR_DATATYPE_RGBA32F:
+        case EQ_COMPRESSOR_DATATYPE_RGB32F:
+        case EQ_COMPRESSOR_DATATYPE_RGBA16F:
+        case EQ_COMPRESSOR_DATATYPE_RGB16F:
+            swapRB = true;
+    }
+
+    if( header.depth == 1 ) // depth
+    {
+        LBASSERT( (header.bytesPerChannel % 4) == 0 );
+        header.depth = 4;
+        header.bytesPerChannel /= 4;
+    }
+    LBASSERT( header.bytesPerChannel > 0 );
+
+    strncpy( header.filename, filename.c_str(), 80 );
+
+    if( header.bytesPerChannel > 2 )
+        LBWARN << static_cast< int >( header.bytesPerChannel )
+               << " bytes per channel not supported by RGB spec" << std::endl;
+
+    // Each channel is saved separately, in the order R, G, B and A
+    const size_t bpc = header.bytesPerChannel;
+    const size_t nChannels = header.depth;
+    static const unsigned rgba[] = { 0, 1, 2, 3 };
+    static const unsigned bgra[] = { 2, 1, 0, 3 };
+    const PlanarizeFunc planarize = getPlanarize( bpc, nChannels, getSIMD( ));
+    LBASSERT( planarize );
+
+    _planes.resize( nPixels * nChannels * bpc );
+    planarize( _planes.getData(), data, nPixels, swapRB ? rgba : bgra );
+
+    if( !_write( filename, header, compress ))
+        return false;
+
+    if( bpc == 1 )
+        return true;
+    // else also write 8bpp version
+
+    const std::string smallFilename = lunchbox::getDirname( filename ) + "/s_" +
+                                      lunchbox::getFilename( filename );
+    _toUnsignedByte( _planes, bpc );
+    header.bytesPerChannel = 1;
+    header.maxValue = 255;
+    return _write( smallFilename, header, compress );
+}
+
+bool RGBWriter::_write( const std::string& filename, RGBHeader& header,
+                        const bool compress )
+{
+    std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary );
+    if( !file.is_open( ))
+    {
+        LBERROR << "Can't open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    const uint8_t* data = _planes.getData();
+    size_t size = _planes.getSize();
+
+    header.compression = ( compress && header.bytesPerChannel == 1 ) ? 1 : 0;
+    if( header.compression )
+    {
+        // offset and length tables of all rows, followed by the rows
+        const size_t width = header.width;
+        const size_t nRows = size_t( header.height ) * header.depth;
+        const size_t tableSize = nRows * 2 * sizeof( uint32_t );
+        _rle.resize( tableSize + nRows * _getMaxRowSize( width ));
+
+        uint8_t* const tables = _rle.getData();
+        uint8_t* out = tables + tableSize;
+        const uint8_t* in = _planes.getData();
+        for( size_t i = 0; i < nRows; ++i, in += width )
+        {
+            uint8_t* const row = out;
+            out = _encodeRow( in, width, out );
+            _putBE( tables + i * 4,
+                    uint32_t( sizeof( RGBHeader ) + ( row - tables )));
+            _putBE( tables + ( nRows + i ) * 4, uint32_t( out - row ));
+        }
+        data = tables;
+        size = out - tables;
+    }
+
+    header.convert();
+    file.write( reinterpret_cast< const char* >( &header ), sizeof( header ));
+    header.convert();
+    file.write( reinterpret_cast< const char* >( data ), size );
+
+    if( !file )
+    {
+        LBERROR << "Can't write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool decodeRLE( const RGBHeader& header, const uint8_t* data,
+                const size_t size, lunchbox::Bufferb& planes )
+{
+    const size_t width = header.width;
+    const size_t nRows = size_t( header.height ) * header.depth;
+    const size_t tableEnd = sizeof( RGBHeader ) + nRows * 2 * sizeof(uint32_t);
+    if( header.bytesPerChannel != 1 || size < tableEnd )
+        return false;
+
+    planes.resize( nRows * width );
+    const uint8_t* const tables = data + sizeof( RGBHeader );
+    uint8_t* out = planes.getData();
+
+    for( size_t i = 0; i < nRows; ++i )
+    {
+        const size_t offset = _getBE( tables + i * 4 );
+        const size_t length = _getBE( tables + ( nRows + i ) * 4 );
+        if( offset < tableEnd || offset > size || length > size - offset )
+            return false;
+
+        const uint8_t* in = data + offset;
+        const uint8_t* const end = in + length;
+        uint8_t* const rowEnd = out + width;
+        while( in < end )
+        {
+            const uint8_t packet = *in++;
+            const size_t n = packet & 0x7f;
+            if( n == 0 )
+                break;
+            if( n > size_t( rowEnd - out ))
+                return false;
+
+            if( packet & 0x80 )
+            {
+                if( n > size_t( end - in ))
+                    return false;
+                memcpy( out, in, n );
+                in += n;
+            }
+            else
+            {
+                if( in == end )
+                    return false;
+                memset( out, *in++, n );
+            }
+            out += n;
+        }
+        if( out != rowEnd )
+            return false;
+    }
+    return true;
+}
+
+}
+}
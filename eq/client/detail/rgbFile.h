@@ -0,0 +1,145 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_RGBFILE_H
+#define EQ_DETAIL_RGBFILE_H
+
+#include "cpuCompositor.h" // SIMD enum
+
+#include <eq/client/api.h>
+#include <eq/client/types.h>
+#include <lunchbox/buffer.h> // member
+
+#include <cstring>
+
+namespace eq
+{
+namespace detail
+{
+#ifdef _WIN32
+#  pragma pack(1)
+#endif
+/** @cond IGNORE */
+/** The 512 byte header of a SGI rgb file. */
+struct RGBHeader
+{
+    RGBHeader()
+    {
+        memset( this, 0, sizeof( RGBHeader ));
+        magic           = 474;
+        bytesPerChannel = 1;
+        nDimensions     = 3;
+        maxValue        = 255;
+    }
+
+    /**
+     * Convert to and from big endian by swapping bytes on little endian
+     * machines.
+     */
+    void convert();
+
+    unsigned short magic;
+    char compression;
+    char bytesPerChannel;
+    unsigned short nDimensions;
+    unsigned short width;
+    unsigned short height;
+    unsigned short depth;
+    unsigned minValue;
+    unsigned maxValue;
+    char unused[4];
+    char filename[80];
+    unsigned colorMode;
+    char fill[404];
+}
+/** @endcond */
+#ifndef _WIN32
+  __attribute__((packed))
+#endif
+;
+#ifdef _WIN32
+#  pragma pack()
+#endif
+
+/**
+ * Planarize interleaved pixels, storing source channel c into the output
+ * plane plane[c]. Each plane holds nPixels values.
+ */
+typedef void (*PlanarizeFunc)( uint8_t* planes, const uint8_t* data,
+                               const size_t nPixels, const unsigned* plane );
+
+/**
+ * @return the planarize kernel for the given bytes per channel and number of
+ *         channels using at most the given instruction set, or 0 if the
+ *         layout is not supported. The result is bit-identical for all
+ *         instruction sets.
+ */
+EQ_API PlanarizeFunc getPlanarize( const size_t bpc, const size_t nChannels,
+                                   const SIMD simd );
+
+/**
+ * Writes pixel data as SGI rgb files.
+ *
+ * The pixels are planarized into one channel after another in a single pass,
+ * optionally run-length encoded, and written using one write per file. The
+ * scratch memory is reused by subsequent writes of the same writer. Not
+ * thread safe.
+ */
+class RGBWriter
+{
+public:
+    RGBWriter() {}
+
+    /**
+     * Write the pixels of one image buffer.
+     *
+     * Images with more than one byte per channel additionally write a 8 bit
+     * per channel version prefixed with 's_'.
+     *
+     * @param filename the output file name.
+     * @param data the pixel data in the given external format.
+     * @param pvp the size of the pixel data.
+     * @param format the external format of the pixel data.
+     * @param compress use RLE compression for images with 8 bit channels.
+     * @return true if the image was written, false on error.
+     */
+    bool write( const std::string& filename, const uint8_t* data,
+                const PixelViewport& pvp, const uint32_t format,
+                const bool compress );
+
+private:
+    lunchbox::Bufferb _planes; //!< planar pixels, one channel after another
+    lunchbox::Bufferb _rle;    //!< offset and length tables and RLE rows
+
+    bool _write( const std::string& filename, RGBHeader& header,
+                 const bool compress );
+};
+
+/**
+ * Decode the RLE compressed channels of a SGI rgb file.
+ *
+ * @param header the header of the file, converted to host byte order.
+ * @param data the file contents, including the header.
+ * @param size the size of the file contents.
+ * @param planes the output, receiving one channel after another.
+ * @return true on success, false if the file is corrupt.
+ */
+bool decodeRLE( const RGBHeader& header, const uint8_t* data,
+                const size_t size, lunchbox::Bufferb& planes );
+}
+}
+
+#endif // EQ_DETAIL_RGBFILE_H
@@ -0,0 +1,42 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_SIMD_H
+#define EQ_DETAIL_SIMD_H
+
+// Runtime-dispatched SIMD kernels are compiled with per-function target
+// attributes on GCC and clang, and with the always-available intrinsics on
+// Visual Studio. Other compilers and architectures use the scalar code only.
+// Use getSIMD() from cpuCompositor.h to select the kernels at runtime.
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ))
+#  if defined( __clang__ ) || __GNUC__ > 4 || \
+    ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 )
+#    include <cpuid.h>
+#    include <immintrin.h>
+#    define EQ_CPU_X86
+#    define EQ_TARGET_SSE2 __attribute__(( target( "sse2" )))
+#    define EQ_TARGET_AVX2 __attribute__(( target( "avx2,f16c" )))
+#  endif
+#elif defined( _MSC_VER ) && _MSC_VER >= 1700 && \
+    ( defined( _M_IX86 ) || defined( _M_X64 ))
+#  include <intrin.h>
+#  include <immintrin.h>
+#  define EQ_CPU_X86
+#  define EQ_TARGET_SSE2
+#  define EQ_TARGET_AVX2
+#endif
+
+#endif // EQ_DETAIL_SIMD_H
@@ -0,0 +1,183 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "statisticQueue.h"
+
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/object.h>
+#include <co/objectOCommand.h>
+#include <lunchbox/scopedMutex.h>
+
+#include <cstring>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** Statistics a thread may queue between two flushes. */
+const int32_t _ringSize = 2048;
+
+/** @return true if the statistic type uses the plugins and ratio fields. */
+bool _hasCompression( const Statistic::Type type )
+{
+    return type == Statistic::CHANNEL_FRAME_COMPRESS ||
+           type == Statistic::CHANNEL_ASYNC_READBACK ||
+           type == Statistic::CHANNEL_READBACK;
+}
+
+void _write( co::DataOStream& os, const StatisticQueue::Item& item )
+{
+    const Statistic& stat = item.statistic;
+    LBASSERT( stat.endTime >= stat.startTime );
+
+    // The duration of a sample easily fits into 32 bits
+    os << item.serial << uint32_t( stat.type ) << stat.frameNumber
+       << stat.task << stat.startTime
+       << uint32_t( stat.endTime - stat.startTime );
+
+    if( _hasCompression( stat.type ))
+        os << stat.plugins[0] << stat.plugins[1] << stat.ratio;
+    else if( stat.type == Statistic::PIPE_IDLE )
+        os << stat.idleTime << stat.totalTime;
+    else if( stat.type == Statistic::WINDOW_FPS )
+        os << stat.currentFPS << stat.averageFPS;
+}
+
+void _read( co::DataIStream& is, StatisticQueue::Item& item )
+{
+    Statistic& stat = item.statistic;
+    ::memset( &stat, 0, sizeof( stat ));
+
+    uint32_t type = 0;
+    uint32_t duration = 0;
+    is >> item.serial >> type >> stat.frameNumber >> stat.task
+       >> stat.startTime >> duration;
+    stat.type = Statistic::Type( type );
+    stat.endTime = stat.startTime + duration;
+
+    if( _hasCompression( stat.type ))
+        is >> stat.plugins[0] >> stat.plugins[1] >> stat.ratio;
+    else if( stat.type == Statistic::PIPE_IDLE )
+        is >> stat.idleTime >> stat.totalTime;
+    else if( stat.type == Statistic::WINDOW_FPS )
+        is >> stat.currentFPS >> stat.averageFPS;
+}
+}
+
+StatisticQueue::StatisticQueue()
+        : _dropped( 0 )
+{}
+
+StatisticQueue::~StatisticQueue()
+{
+    for( Rings::const_iterator i = _rings.begin(); i != _rings.end(); ++i )
+        delete *i;
+    _rings.clear();
+}
+
+void StatisticQueue::push( const Event& event )
+{
+    Ring* ring = _ring.get();
+    if( !ring )
+    {
+        ring = new Ring( _ringSize );
+        _ring = ring;
+
+        lunchbox::ScopedMutex<> mutex( _lock );
+        _rings.push_back( ring );
+    }
+
+    Item item;
+    item.serial = event.serial;
+    item.originator = event.originator;
+    item.statistic = event.statistic;
+    if( !ring->push( item ))
+        ++_dropped;
+}
+
+size_t StatisticQueue::flush( co::Object& object, co::NodePtr node,
+                              const uint32_t cmd )
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+
+    _items.clear();
+    Item item;
+    for( Rings::const_iterator i = _rings.begin(); i != _rings.end(); ++i )
+        while( (*i)->pop( item ))
+            _items.push_back( item );
+
+    const int32_t dropped = _dropped;
+    if( dropped > 0 )
+    {
+        LBWARN << "Dropped " << dropped << " statistics, flushed too late"
+               << std::endl;
+        _dropped -= dropped;
+    }
+
+    if( _items.empty() || !node )
+        return 0;
+
+    std::vector< const Item* > named;
+    for( Items::const_iterator i = _items.begin(); i != _items.end(); ++i )
+        if( _sent.insert( i->serial ).second )
+            named.push_back( &(*i) );
+
+    co::ObjectOCommand command = object.send( node, cmd );
+    command << uint32_t( named.size( ));
+    for( std::vector< const Item* >::const_iterator i = named.begin();
+         i != named.end(); ++i )
+    {
+        const Item* namedItem = *i;
+        command << namedItem->serial << namedItem->originator
+                << std::string( namedItem->statistic.resourceName );
+    }
+
+    command << uint32_t( _items.size( ));
+    for( Items::const_iterator i = _items.begin(); i != _items.end(); ++i )
+        _write( command, *i );
+    return _items.size();
+}
+
+void StatisticQueue::read( co::DataIStream& is, Items& items )
+{
+    uint32_t nNames = 0;
+    is >> nNames;
+    for( uint32_t i = 0; i < nNames; ++i )
+    {
+        uint32_t serial = 0;
+        is >> serial;
+        Originator& originator = _originators[ serial ];
+        is >> originator.first >> originator.second;
+    }
+
+    uint32_t nItems = 0;
+    is >> nItems;
+    items.resize( nItems );
+    for( Items::iterator i = items.begin(); i != items.end(); ++i )
+    {
+        _read( is, *i );
+        const Originator& originator = _originators[ i->serial ];
+        i->originator = originator.first;
+        ::strncpy( i->statistic.resourceName, originator.second.c_str(), 31 );
+    }
+}
+
+}
+}
@@ -0,0 +1,99 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_STATISTICQUEUE_H
+#define EQ_DETAIL_STATISTICQUEUE_H
+
+#include <eq/client/event.h> // Statistic member
+
+#include <co/types.h>
+#include <lunchbox/atomic.h>     // member
+#include <lunchbox/lfQueue.h>    // member
+#include <lunchbox/lock.h>       // member
+#include <lunchbox/perThread.h>  // member
+#include <map>
+#include <set>
+#include <vector>
+
+namespace eq
+{
+namespace detail
+{
+/**
+ * Collects the statistics of all threads for batched transmission.
+ *
+ * Each producing thread appends to its own lock-free, single-producer ring
+ * buffer, which is registered on the first statistic of the thread. Once per
+ * frame the queue is flushed: all rings are drained and their statistics are
+ * sent as one command. The encoding omits the fields not used by the
+ * receiving type, and the identifier and resource name of an originator are
+ * only sent with the first batch containing it.
+ *
+ * The receiving side decodes the batch and restores the originators and
+ * resource names.
+ */
+class StatisticQueue
+{
+public:
+    /** A queued statistic of an originator. */
+    struct Item
+    {
+        uint32_t serial;      //!< the originator serial id
+        uint128_t originator; //!< the originator identifier
+        Statistic statistic;
+    };
+    typedef std::vector< Item > Items;
+
+    StatisticQueue();
+    ~StatisticQueue();
+
+    /**
+     * Queue the statistic of a statistic event. Lock-free except for the first
+     * call of a thread.
+     */
+    void push( const Event& event );
+
+    /**
+     * Send all queued statistics as one command to the given node.
+     *
+     * Nothing is sent if no statistics are queued. Thread safe.
+     * @return the number of sent statistics.
+     */
+    size_t flush( co::Object& object, co::NodePtr node, const uint32_t cmd );
+
+    /** Decode a batch sent by flush(). Not thread safe. */
+    void read( co::DataIStream& is, Items& items );
+
+private:
+    typedef lunchbox::LFQueue< Item > Ring;
+    typedef std::vector< Ring* > Rings;
+
+    lunchbox::PerThread< Ring, lunchbox::perThreadNoDelete< Ring > > _ring;
+    Rings _rings; //!< all rings, owned by the queue
+    Items _items; //!< flush buffer
+    std::set< uint32_t > _sent; //!< serials with a transmitted originator
+    lunchbox::Lock _lock; //!< protects the flush state and the registry
+    lunchbox::a_int32_t _dropped; //!< pushed on a full ring
+
+    /** The identifier and resource name of the received serials. */
+    typedef std::pair< uint128_t, std::string > Originator;
+    std::map< uint32_t, Originator > _originators;
+};
+}
+}
+
+#endif // EQ_DETAIL_STATISTICQUEUE_H
@@ -89,12 +89,14 @@ set(CLIENT_HEADERS
   eye.h
   frame.h
   frameData.h
+  frameRecorder.h
   gl.h
   glException.h
   glWindow.h
   glXTypes.h
   global.h
   image.h
+  imageWriter.h
   init.h
   layout.h
   log.h
@@ -125,6 +127,15 @@ set(CLIENT_HEADERS
 set(CLIENT_SOURCES
   ${SAGE_SOURCES}
   detail/channel.ipp
+  detail/compressionPolicy.cpp
+  detail/compressionPolicy.h
+  detail/cpuCompositor.cpp
+  detail/cpuCompositor.h
+  detail/rgbFile.cpp
+  detail/rgbFile.h
+  detail/simd.h
+  detail/statisticQueue.cpp
+  detail/statisticQueue.h
   canvas.cpp
   channel.cpp
   channelStatistics.cpp
@@ -141,6 +152,7 @@ set(CLIENT_SOURCES
   exitVisitor.h
   frame.cpp
   frameData.cpp
+  frameRecorder.cpp
   frameVisitor.h
   gl.cpp
   glException.cpp
@@ -149,6 +161,7 @@ set(CLIENT_SOURCES
   half.h
   half.cpp
   image.cpp
+  imageWriter.cpp
   init.cpp
   initVisitor.h
   jitter.cpp
@@ -145,6 +145,7 @@ void FrameData::clear()
     _imageCache.insert( _imageCache.end(), _images.begin(), _images.end( ));
     _imageCacheLock.unset();
     _images.clear();
+    _commands.clear();
 }
 
 void FrameData::flush()
@@ -348,6 +349,7 @@ void FrameData::setReady( const co::ObjectVersion& frameData,
     LBASSERT( _version == frameData.version.low( ));
 
     _images.swap( _pendingImages );
+    _commands.swap( _pendingCommands );
     _data = data;
     _setReady( frameData.version.low());
 
@@ -397,17 +399,20 @@ void FrameData::removeListener( lunchbox::Monitor<uint32_t>& listener )
     _listeners->erase( i );
 }
 
-bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
-                          const PixelViewport& pvp, const Zoom& zoom,
-                          const uint32_t buffers_, const bool useAlpha,
-                          uint8_t* data )
+namespace
+{
+/**
+ * Set the pixel data of an image from transmitted image data.
+ * @return true if the image references the data, false if it was copied.
+ */
+bool _setImageData( Image* image, const PixelViewport& pvp, const Zoom& zoom,
+                    const uint32_t buffers_, const bool useAlpha,
+                    uint8_t* data )
 {
-    Image* image = _allocImage( Frame::TYPE_MEMORY, DrawableConfig(),
-                                false /* set quality */ );
-
     image->setPixelViewport( pvp );
     image->setAlphaUsage( useAlpha );
 
+    bool referenced = false;
     Frame::Buffer buffers[] = { Frame::BUFFER_COLOR, Frame::BUFFER_DEPTH };
     for( unsigned i = 0; i < 2; ++i )
     {
@@ -416,7 +421,8 @@ bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
         if( buffers_ & buffer )
         {
             PixelData pixelData;
-            const ImageHeader* header = reinterpret_cast<ImageHeader*>( data );
+            const FrameData::ImageHeader* header =
+                reinterpret_cast< FrameData::ImageHeader* >( data );
             pixelData.internalFormat  = header->internalFormat;
             pixelData.externalFormat  = header->externalFormat;
             pixelData.pixelSize       = header->pixelSize;
@@ -427,7 +433,7 @@ bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
                 pixelData.compressorName > EQ_COMPRESSOR_NONE;
 
             const uint32_t nChunks    = header->nChunks;
-            data += sizeof( ImageHeader );
+            data += sizeof( FrameData::ImageHeader );
 
             if( pixelData.isCompressed )
             {
@@ -455,12 +461,47 @@ bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
 
             image->setZoom( zoom );
             image->setQuality( buffer, header->quality );
-            image->setPixelData( buffer, pixelData );
+            if( pixelData.isCompressed )
+                image->setPixelData( buffer, pixelData );
+            else
+            {
+                // reference pixels in the given buffer, no copy
+                image->setPixelDataReference( buffer, pixelData );
+                referenced = true;
+            }
         }
     }
+    return referenced;
+}
+}
+
+Image* FrameData::newImage( const PixelViewport& pvp, const Zoom& zoom,
+                            const uint32_t buffers, const bool useAlpha,
+                            uint8_t* data )
+{
+    Image* image = _allocImage( Frame::TYPE_MEMORY, DrawableConfig(),
+                                false /* set quality */ );
+    _setImageData( image, pvp, zoom, buffers, useAlpha, data );
+    _images.push_back( image );
+    return image;
+}
+
+bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
+                          const PixelViewport& pvp, const Zoom& zoom,
+                          const uint32_t buffers, const bool useAlpha,
+                          uint8_t* data, const co::ICommand& command )
+{
+    Image* image = _allocImage( Frame::TYPE_MEMORY, DrawableConfig(),
+                                false /* set quality */ );
+
+    // pixels referenced in the command buffer are valid until clear()
+    const bool useCommand = _setImageData( image, pvp, zoom, buffers, useAlpha,
+                                           data );
 
     LBASSERT( _readyVersion < frameDataVersion.version.low( ));
     _pendingImages.push_back( image );
+    if( useCommand )
+        _pendingCommands.push_back( command );
     return true;
 }
 
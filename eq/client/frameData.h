@@ -27,6 +27,7 @@
 #include <eq/fabric/range.h>         // member
 #include <eq/fabric/subPixel.h>      // member
 
+#include <co/iCommand.h>             // member
 #include <co/object.h>               // base class
 #include <lunchbox/monitor.h>         // member
 #include <lunchbox/spinLock.h>        // member
@@ -202,6 +203,23 @@ namespace server { class FrameData; }
         EQ_API Image* newImage( const Frame::Type type,
                                 const DrawableConfig& config );
 
+        /**
+         * Allocate and add a new main memory image from transmitted data.
+         *
+         * The data holds an ImageHeader followed by the sizes and data of all
+         * chunks for each of the given buffers, as sent to the receiving nodes
+         * of an output frame. Compressed pixel data is decompressed.
+         * Uncompressed pixel data is referenced and has to stay valid until
+         * the image is released by clear(). Used to replay recorded frames.
+         *
+         * @return the image.
+         * @sa FrameRecording
+         * @version 1.5.2
+         */
+        EQ_API Image* newImage( const PixelViewport& pvp, const Zoom& zoom,
+                                const uint32_t buffers, const bool useAlpha,
+                                uint8_t* data );
+
         /** Clear the frame by recycling the attached images. @version 1.0 */
         EQ_API void clear();
 
@@ -317,11 +335,17 @@ namespace server { class FrameData; }
             EQ_API void deserialize( co::DataIStream& is );
         } _data;
 
-        /** @internal */
+        /**
+         * @internal
+         * Add an image received with the given command.
+         *
+         * Uncompressed pixel data is referenced in place, and the command
+         * is retained until the image is released by clear().
+         */
         bool addImage( const co::ObjectVersion& frameDataVersion,
                        const PixelViewport& pvp, const Zoom& zoom,
                        const uint32_t buffers, const bool useAlpha,
-                       uint8_t* data );
+                       uint8_t* data, const co::ICommand& command );
         void setReady( const co::ObjectVersion& frameData,
                        const FrameData::Data& data ); //!< @internal
 
@@ -339,6 +363,10 @@ namespace server { class FrameData; }
 
         Images _pendingImages;
 
+        typedef std::vector< co::ICommand > Commands;
+        Commands _commands; //!< Buffers referenced by _images
+        Commands _pendingCommands; //!< Buffers referenced by _pendingImages
+
         uint64_t _version; //!< The current version
 
         typedef lunchbox::Monitor< uint64_t > Monitor;
@@ -0,0 +1,404 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "frameRecorder.h"
+
+#include "log.h"
+
+#include <lunchbox/atomic.h>
+#include <lunchbox/buffer.h>
+#include <lunchbox/lock.h>
+#include <lunchbox/memoryMap.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/thread.h>
+
+#include <fstream>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+// File layout: FileHeader, records aligned to 8 bytes, index, FileFooter.
+const uint32_t _magic = 0x65714652; // 'eqFR'
+const uint32_t _version = 1;
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct FileFooter
+{
+    uint64_t indexOffset; //!< the offset of nRecords uint64_t record offsets
+    uint64_t nRecords;
+    uint32_t magic;
+    uint32_t version;
+};
+
+/** The number of records queued before append() blocks. */
+const size_t _maxJobs = 16;
+
+uint64_t _align( const uint64_t offset )
+{
+    return ( offset + 7 ) & ~uint64_t( 7 );
+}
+
+/** One queued record, recycled after writing. */
+struct Job
+{
+    FrameRecord record;
+    lunchbox::Bufferb data;
+};
+typedef lunchbox::MTQueue< Job* > JobQueue;
+}
+
+class FrameRecorder : public lunchbox::Thread
+{
+public:
+    FrameRecorder()
+        : offset( 0 )
+        , recording( 0 )
+        , _pending( 0 )
+    {
+        start();
+    }
+
+    virtual ~FrameRecorder()
+    {
+        _queued.push( 0 ); // exit thread after writing all queued records
+        join();
+        for( std::vector< Job* >::const_iterator i = _jobs.begin();
+             i != _jobs.end(); ++i )
+        {
+            delete *i;
+        }
+    }
+
+    /** Copy the record and queue it for the writer thread. */
+    bool append( const FrameRecord& record, const void* data )
+    {
+        if( !recording )
+            return false;
+
+        Job* job = 0;
+        if( !_free.tryPop( job ))
+        {
+            lunchbox::ScopedMutex<> mutex( _jobsLock );
+            if( _jobs.size() < _maxJobs )
+            {
+                job = new Job;
+                _jobs.push_back( job );
+            }
+        }
+        if( !job )
+            job = _free.pop(); // writer busy, wait for a free job
+
+        job->record = record;
+        job->data.replace( data, record.size );
+        ++_pending;
+        _queued.push( job );
+        return true;
+    }
+
+    /** Wait until all queued records are written. */
+    void flush() { _pending.waitEQ( 0 ); }
+
+    std::ofstream file;
+    std::vector< uint64_t > offsets;
+    uint64_t offset;
+    mutable lunchbox::Lock lock; //!< protects the file and the index
+    lunchbox::a_int32_t recording; //!< open and no write error
+
+protected:
+    virtual void run()
+    {
+        lunchbox::Thread::setName( "FrameRecorder" );
+        while( Job* job = _queued.pop( ))
+        {
+            _write( *job );
+            _free.push( job );
+            --_pending;
+        }
+    }
+
+private:
+    std::vector< Job* > _jobs;
+    lunchbox::Lock _jobsLock; //!< protects _jobs
+    JobQueue _queued; //!< jobs to write, 0 stops the thread
+    JobQueue _free;   //!< written jobs available for reuse
+    lunchbox::Monitor< size_t > _pending; //!< number of queued jobs
+
+    void _write( const Job& job )
+    {
+        static const char padding[8] = { 0 };
+
+        lunchbox::ScopedMutex<> mutex( lock );
+        if( !file.is_open() || !file.good( ))
+            return;
+
+        const FrameRecord& record = job.record;
+        const uint64_t end = offset + sizeof( record ) + record.size;
+        const uint64_t next = _align( end );
+
+        file.write( reinterpret_cast< const char* >( &record ),
+                    sizeof( record ));
+        file.write( reinterpret_cast< const char* >( job.data.getData( )),
+                    record.size );
+        file.write( padding, next - end );
+        if( !file.good( ))
+        {
+            LBERROR << "Failed to write frame recording, stopping"
+                    << std::endl;
+            recording = 0;
+            return;
+        }
+
+        offsets.push_back( offset );
+        offset = next;
+    }
+};
+
+class FrameRecording
+{
+public:
+    FrameRecording() : data( 0 ) {}
+
+    lunchbox::MemoryMap map;
+    const uint8_t* data;
+    std::vector< uint64_t > offsets;
+
+    /** Use the index written on close, if it is valid. */
+    bool readIndex( const size_t size )
+    {
+        if( size < sizeof( FileHeader ) + sizeof( FileFooter ))
+            return false;
+
+        const FileFooter* footer = reinterpret_cast< const FileFooter* >(
+            data + size - sizeof( FileFooter ));
+        if( footer->magic != _magic || footer->version != _version ||
+            footer->indexOffset > size - sizeof( FileFooter ) ||
+            ( footer->indexOffset & 7 ))
+        {
+            return false;
+        }
+
+        const uint64_t indexSize = size - sizeof( FileFooter ) -
+                                   footer->indexOffset;
+        if( indexSize % sizeof( uint64_t ) ||
+            indexSize / sizeof( uint64_t ) != footer->nRecords )
+        {
+            return false;
+        }
+
+        const uint64_t* index = reinterpret_cast< const uint64_t* >(
+            data + footer->indexOffset );
+        offsets.assign( index, index + footer->nRecords );
+        for( size_t i = 0; i < offsets.size(); ++i )
+        {
+            if( !isValid( offsets[i], footer->indexOffset ))
+            {
+                offsets.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Reconstruct the index from the records. */
+    void scanRecords( const size_t size )
+    {
+        offsets.clear();
+        uint64_t offset = sizeof( FileHeader );
+        while( isValid( offset, size ))
+        {
+            offsets.push_back( offset );
+            const FrameRecord* record =
+                reinterpret_cast< const FrameRecord* >( data + offset );
+            offset = _align( offset + sizeof( FrameRecord ) + record->size );
+        }
+    }
+
+    /** @return true if the given record is within the first size bytes. */
+    bool isValid( const uint64_t offset, const uint64_t size ) const
+    {
+        if( offset < sizeof( FileHeader ) || ( offset & 7 ) ||
+            offset > size || size - offset < sizeof( FrameRecord ))
+        {
+            return false;
+        }
+        const FrameRecord* record =
+            reinterpret_cast< const FrameRecord* >( data + offset );
+        return record->size <= size - offset - sizeof( FrameRecord );
+    }
+};
+}
+
+FrameRecorder::FrameRecorder()
+    : _impl( new detail::FrameRecorder )
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    close();
+    delete _impl;
+}
+
+bool FrameRecorder::open( const std::string& filename )
+{
+    close();
+
+    lunchbox::ScopedMutex<> mutex( _impl->lock );
+    _impl->file.open( filename.c_str(),
+                      std::ios::out | std::ios::binary | std::ios::trunc );
+    if( !_impl->file.is_open( ))
+    {
+        LBERROR << "Can't open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    const detail::FileHeader header = { detail::_magic, detail::_version, 0 };
+    _impl->file.write( reinterpret_cast< const char* >( &header ),
+                       sizeof( header ));
+    _impl->offset = sizeof( header );
+    _impl->offsets.clear();
+    if( !_impl->file.good( ))
+        return false;
+
+    _impl->recording = 1;
+    return true;
+}
+
+void FrameRecorder::close()
+{
+    _impl->recording = 0;
+    _impl->flush();
+
+    lunchbox::ScopedMutex<> mutex( _impl->lock );
+    if( !_impl->file.is_open( ))
+        return;
+
+    const detail::FileFooter footer = { _impl->offset, _impl->offsets.size(),
+                                        detail::_magic, detail::_version };
+    if( !_impl->offsets.empty( ))
+        _impl->file.write( reinterpret_cast< const char* >(
+                               &_impl->offsets.front( )),
+                           _impl->offsets.size() * sizeof( uint64_t ));
+    _impl->file.write( reinterpret_cast< const char* >( &footer ),
+                       sizeof( footer ));
+    if( !_impl->file.good( ))
+        LBWARN << "Failed to write index of frame recording" << std::endl;
+
+    _impl->file.close();
+    _impl->offsets.clear();
+}
+
+bool FrameRecorder::isOpen() const
+{
+    lunchbox::ScopedMutex<> mutex( _impl->lock );
+    return _impl->file.is_open();
+}
+
+bool FrameRecorder::append( const FrameRecord& record, const void* data )
+{
+    return _impl->append( record, data );
+}
+
+void FrameRecorder::flush()
+{
+    _impl->flush();
+}
+
+size_t FrameRecorder::getNumRecords() const
+{
+    lunchbox::ScopedMutex<> mutex( _impl->lock );
+    return _impl->offsets.size();
+}
+
+FrameRecording::FrameRecording()
+    : _impl( new detail::FrameRecording )
+{
+}
+
+FrameRecording::~FrameRecording()
+{
+    close();
+    delete _impl;
+}
+
+bool FrameRecording::open( const std::string& filename )
+{
+    close();
+
+    _impl->data = static_cast< const uint8_t* >( _impl->map.map( filename ));
+    if( !_impl->data )
+    {
+        LBERROR << "Can't open " << filename << " for reading" << std::endl;
+        return false;
+    }
+
+    const size_t size = _impl->map.getSize();
+    const detail::FileHeader* header =
+        reinterpret_cast< const detail::FileHeader* >( _impl->data );
+    if( size < sizeof( detail::FileHeader ) ||
+        header->magic != detail::_magic || header->version != detail::_version)
+    {
+        LBERROR << filename << " is not a frame recording" << std::endl;
+        close();
+        return false;
+    }
+
+    if( !_impl->readIndex( size ))
+    {
+        LBWARN << "Rebuilding missing index of " << filename << std::endl;
+        _impl->scanRecords( size );
+    }
+    return true;
+}
+
+void FrameRecording::close()
+{
+    _impl->map.unmap();
+    _impl->data = 0;
+    _impl->offsets.clear();
+}
+
+size_t FrameRecording::getNumRecords() const
+{
+    return _impl->offsets.size();
+}
+
+const FrameRecord& FrameRecording::getRecord( const size_t index ) const
+{
+    LBASSERT( index < _impl->offsets.size( ));
+    return *reinterpret_cast< const FrameRecord* >(
+        _impl->data + _impl->offsets[ index ] );
+}
+
+const uint8_t* FrameRecording::getData( const size_t index ) const
+{
+    LBASSERT( index < _impl->offsets.size( ));
+    return _impl->data + _impl->offsets[ index ] + sizeof( FrameRecord );
+}
+
+}
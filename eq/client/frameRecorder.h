@@ -0,0 +1,158 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_FRAMERECORDER_H
+#define EQ_FRAMERECORDER_H
+
+#include <eq/client/api.h>
+#include <eq/client/types.h>
+#include <eq/fabric/pixelViewport.h> // member
+#include <eq/fabric/zoom.h>          // member
+
+namespace eq
+{
+namespace detail { class FrameRecorder; class FrameRecording; }
+
+    /**
+     * The header of one recorded image, followed by its image data.
+     *
+     * The image data is stored as transmitted to the receiving node, that is,
+     * one FrameData::ImageHeader followed by the size and data of all chunks
+     * for each buffer. All values are stored in native byte order.
+     */
+    struct FrameRecord
+    {
+        uint128_t frameDataID; //!< the output frame data of the image
+        uint64_t size;         //!< the size of the image data
+        uint32_t frameNumber;  //!< the frame number of the image
+        uint32_t buffers;      //!< the Frame::Buffer mask of the image data
+        PixelViewport pvp;     //!< the pixel viewport of the image
+        Zoom zoom;             //!< the zoom of the image
+        uint32_t useAlpha;     //!< 1 if the alpha channel is used, 0 if not
+        uint32_t reserved;
+    };
+
+    /**
+     * Records images into a single, indexed file.
+     *
+     * The records are appended to the file as they arrive. The index of all
+     * records is written by close(). Recordings without index, e.g., of a
+     * crashed process, can still be read by FrameRecording.
+     *
+     * The file is written by a background thread. Appending a record copies
+     * its data into a queue, which blocks only if the disk falls behind by a
+     * fixed number of records.
+     *
+     * Nodes record all received images into a file per node if the
+     * environment variable EQ_RECORD_FRAMES is set to a file name prefix.
+     */
+    class FrameRecorder
+    {
+    public:
+        /** Construct a new frame recorder. @version 1.5.2 */
+        EQ_API FrameRecorder();
+
+        /** Close and destruct the frame recorder. @version 1.5.2 */
+        EQ_API ~FrameRecorder();
+
+        /**
+         * Open a new recording, overwriting an existing file.
+         * @return true on success, false on error.
+         * @version 1.5.2
+         */
+        EQ_API bool open( const std::string& filename );
+
+        /**
+         * Write all queued images and the index, and close the recording.
+         * @version 1.5.2
+         */
+        EQ_API void close();
+
+        /** @return true if a recording is open. @version 1.5.2 */
+        EQ_API bool isOpen() const;
+
+        /**
+         * Queue one image for appending to the recording. Thread safe.
+         *
+         * The data is copied and may be released after the call.
+         *
+         * @param record the header of the image.
+         * @param data the image data, record.size bytes.
+         * @return true if the image was queued, false if no recording is open
+         *         or if writing failed.
+         * @version 1.5.2
+         */
+        EQ_API bool append( const FrameRecord& record, const void* data );
+
+        /** Wait until all queued images are written. @version 1.5.2 */
+        EQ_API void flush();
+
+        /** @return the number of written images. @version 1.5.2 */
+        EQ_API size_t getNumRecords() const;
+
+    private:
+        FrameRecorder( const FrameRecorder& );
+        FrameRecorder& operator = ( const FrameRecorder& );
+        detail::FrameRecorder* const _impl;
+    };
+
+    /**
+     * Provides random access to the images of a recording.
+     *
+     * The recording is memory-mapped. The image data is used in place, e.g.,
+     * by FrameData::newImage(), and is valid until the recording is closed.
+     */
+    class FrameRecording
+    {
+    public:
+        /** Construct a new frame recording reader. @version 1.5.2 */
+        EQ_API FrameRecording();
+
+        /** Close and destruct the reader. @version 1.5.2 */
+        EQ_API ~FrameRecording();
+
+        /**
+         * Map a recording.
+         *
+         * The index of a recording without index is reconstructed from the
+         * records, ignoring a truncated last record.
+         *
+         * @return true on success, false on error.
+         * @version 1.5.2
+         */
+        EQ_API bool open( const std::string& filename );
+
+        /** Unmap the recording. @version 1.5.2 */
+        EQ_API void close();
+
+        /** @return the number of recorded images. @version 1.5.2 */
+        EQ_API size_t getNumRecords() const;
+
+        /** @return the header of the given image. @version 1.5.2 */
+        EQ_API const FrameRecord& getRecord( const size_t index ) const;
+
+        /** @return the data of the given image. @version 1.5.2 */
+        EQ_API const uint8_t* getData( const size_t index ) const;
+
+    private:
+        FrameRecording( const FrameRecording& );
+        FrameRecording& operator = ( const FrameRecording& );
+        detail::FrameRecording* const _impl;
+    };
+}
+
+#endif // EQ_FRAMERECORDER_H
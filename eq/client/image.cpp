@@ -20,10 +20,10 @@
 #include "image.h"
 
 #include "gl.h"
-#include "half.h"
 #include "log.h"
 #include "pixelData.h"
 #include "windowSystem.h"
+#include "detail/rgbFile.h"
 
 #include <eq/util/frameBufferObject.h>
 #include <eq/util/objectManager.h>
@@ -207,6 +207,52 @@ public:
     const Memory& getMemory( const eq::Frame::Buffer buffer ) const
         { return getAttachment( buffer ).memory; }
 
+    uint32_t getCompressorFlags( const eq::Frame::Buffer buffer ) const
+    {
+        uint32_t flags = EQ_COMPRESSOR_DATA_2D;
+        if( ignoreAlpha && getMemory( buffer ).hasAlpha )
+        {
+            LBASSERT( buffer == eq::Frame::BUFFER_COLOR );
+            flags |= EQ_COMPRESSOR_IGNORE_ALPHA;
+        }
+        return flags;
+    }
+
+    /** Set the pixel data parameters, excluding the pixels. */
+    void setupMemory( const eq::Frame::Buffer buffer, const PixelData& pixels )
+    {
+        Memory& memory = getMemory( buffer );
+        memory.externalFormat = pixels.externalFormat;
+        memory.internalFormat = pixels.internalFormat;
+        memory.pixelSize = pixels.pixelSize;
+        memory.pvp       = pixels.pvp;
+        memory.state     = Memory::INVALID;
+        memory.isCompressed = false;
+        memory.hasAlpha = false;
+
+        const EqCompressorInfos& transferrers =
+            findTransferers( buffer, 0 /*GLEW context*/ );
+        if( transferrers.empty( ))
+        {
+            LBWARN << "No upload engines found for given pixel data"
+                   << std::endl;
+            return;
+        }
+
+        memory.hasAlpha =
+            transferrers.front().capabilities & EQ_COMPRESSOR_IGNORE_ALPHA;
+#ifndef NDEBUG
+        for( EqCompressorInfosCIter i = transferrers.begin();
+             i != transferrers.end(); ++i )
+        {
+            LBASSERTINFO( memory.hasAlpha ==
+                          bool( i->capabilities & EQ_COMPRESSOR_IGNORE_ALPHA ),
+                          "Uploaders don't agree on alpha state of external " <<
+                          "format: " << transferrers.front() << " != " << *i );
+        }
+#endif
+    }
+
     EqCompressorInfos findTransferers( const eq::Frame::Buffer buffer,
                                        const GLEWContext* gl ) const
     {
@@ -841,34 +887,8 @@ void Image::validatePixelData( const Frame::Buffer buffer )
 
 void Image::setPixelData( const Frame::Buffer buffer, const PixelData& pixels )
 {
+    _impl->setupMemory( buffer, pixels );
     Memory& memory = _impl->getMemory( buffer );
-    memory.externalFormat = pixels.externalFormat;
-    memory.internalFormat = pixels.internalFormat;
-    memory.pixelSize = pixels.pixelSize;
-    memory.pvp       = pixels.pvp;
-    memory.state     = Memory::INVALID;
-    memory.isCompressed = false;
-    memory.hasAlpha = false;
-
-    const EqCompressorInfos& transferrers = _impl->findTransferers( buffer,
-                                                           0 /*GLEW context*/ );
-    if( transferrers.empty( ))
-        LBWARN << "No upload engines found for given pixel data" << std::endl;
-    else
-    {
-        memory.hasAlpha =
-            transferrers.front().capabilities & EQ_COMPRESSOR_IGNORE_ALPHA;
-#ifndef NDEBUG
-        for( EqCompressorInfosCIter i = transferrers.begin();
-             i != transferrers.end(); ++i )
-        {
-            LBASSERTINFO( memory.hasAlpha ==
-                          bool( i->capabilities & EQ_COMPRESSOR_IGNORE_ALPHA ),
-                          "Uploaders don't agree on alpha state of external " <<
-                          "format: " << transferrers.front() << " != " << *i );
-        }
-#endif
-    }
 
     const uint32_t size = getPixelDataSize( buffer );
     LBASSERT( size > 0 );
@@ -996,17 +1016,12 @@ void Image::useCompressor( const Frame::Buffer buffer, const uint32_t name )
     _impl->getMemory( buffer ).compressorName = name;
 }
 
-const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
+uint32_t Image::selectCompressor( const Frame::Buffer buffer )
 {
-    LBASSERT( getPixelDataSize( buffer ) > 0 );
-
     Attachment& attachment = _impl->getAttachment( buffer );
     Memory& memory = attachment.memory;
-    if( memory.isCompressed || memory.compressorName == EQ_COMPRESSOR_NONE )
-    {
-        LBASSERT( memory.compressorName != EQ_COMPRESSOR_AUTO );
-        return memory;
-    }
+    if( memory.compressorName == EQ_COMPRESSOR_NONE )
+        return EQ_COMPRESSOR_NONE;
 
     lunchbox::Compressor& compressor = attachment.compressor[attachment.active];
 
@@ -1039,16 +1054,27 @@ const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
     memory.compressorName = compressor.getInfo().name;
     LBASSERT( memory.compressorName != EQ_COMPRESSOR_AUTO );
     LBASSERT( memory.compressorName != EQ_COMPRESSOR_INVALID );
-    if( memory.compressorName == EQ_COMPRESSOR_NONE )
-        return memory;
+    return memory.compressorName;
+}
 
-    memory.compressorFlags = EQ_COMPRESSOR_DATA_2D;
-    if( _impl->ignoreAlpha && memory.hasAlpha )
+const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
+{
+    LBASSERT( getPixelDataSize( buffer ) > 0 );
+
+    Attachment& attachment = _impl->getAttachment( buffer );
+    Memory& memory = attachment.memory;
+    if( memory.isCompressed || memory.compressorName == EQ_COMPRESSOR_NONE )
     {
-        LBASSERT( buffer == Frame::BUFFER_COLOR );
-        memory.compressorFlags |= EQ_COMPRESSOR_IGNORE_ALPHA;
+        LBASSERT( memory.compressorName != EQ_COMPRESSOR_AUTO );
+        return memory;
     }
 
+    if( selectCompressor( buffer ) == EQ_COMPRESSOR_NONE )
+        return memory;
+
+    lunchbox::Compressor& compressor = attachment.compressor[attachment.active];
+    memory.compressorFlags = _impl->getCompressorFlags( buffer );
+
     uint64_t inDims[4];
     memory.pvp.convertToPlugin( inDims );
     compressor.compress( memory.pixels, inDims, memory.compressorFlags );
@@ -1064,291 +1090,92 @@ const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
     return memory;
 }
 
-
-//---------------------------------------------------------------------------
-// File IO
-//---------------------------------------------------------------------------
-bool Image::writeImages( const std::string& filenameTemplate ) const
-{
-    return( writeImage( filenameTemplate + "_color.rgb", Frame::BUFFER_COLOR) &&
-            writeImage( filenameTemplate + "_depth.rgb", Frame::BUFFER_DEPTH ));
-}
-
-namespace
+void Image::compressPixelData( const Frame::Buffer buffer,
+                               const int32_t y, const int32_t h,
+                               lunchbox::Compressor& compressor,
+                               PixelData& result ) const
 {
-#define SWAP_SHORT(v) ( v = (v&0xff) << 8 | (v&0xff00) >> 8 )
-#define SWAP_INT(v)   ( v = (v&0xff) << 24 | (v&0xff00) << 8 |      \
-                        (v&0xff0000) >> 8 | (v&0xff000000) >> 24)
+    const Memory& memory = _impl->getMemory( buffer );
+    LBASSERT( memory.compressorName != EQ_COMPRESSOR_AUTO );
+    LBASSERT( y >= 0 && h > 0 && y + h <= memory.pvp.h );
+
+    const size_t rowSize = memory.pvp.w * memory.pixelSize;
+    result.internalFormat = memory.internalFormat;
+    result.externalFormat = memory.externalFormat;
+    result.pixelSize = memory.pixelSize;
+    result.pvp = PixelViewport( memory.pvp.x, memory.pvp.y + y,
+                                memory.pvp.w, h );
+    result.pixels = reinterpret_cast< uint8_t* >( memory.pixels ) + y * rowSize;
+    result.compressorName = memory.compressorName;
+    result.compressorFlags = _impl->getCompressorFlags( buffer );
+    result.isCompressed = false;
+    result.compressedSize.clear();
+    result.compressedData.clear();
+
+    if( result.compressorName == EQ_COMPRESSOR_NONE )
+        return;
 
-#ifdef _WIN32
-#  pragma pack(1)
-#endif
-/** @cond IGNORE */
-struct RGBHeader
-{
-    RGBHeader()
+    if( !compressor.isGood() ||
+        compressor.getInfo().name != result.compressorName )
     {
-        memset( this, 0, sizeof( RGBHeader ));
-        magic           = 474;
-        bytesPerChannel = 1;
-        nDimensions     = 3;
-        maxValue        = 255;
+        compressor.setup( co::Global::getPluginRegistry(),
+                          result.compressorName );
+        if( !compressor.isGood( ))
+        {
+            LBWARN << "Can't allocate compressor 0x" << std::hex
+                   << result.compressorName << std::dec << std::endl;
+            compressor.clear();
+            result.compressorName = EQ_COMPRESSOR_NONE;
+            return;
+        }
     }
 
-    /**
-     * Convert to and from big endian by swapping bytes on little endian
-     * machines.
-     */
-    void convert()
-    {
-#if defined(__i386__) || defined(__amd64__) || defined (__ia64) || \
-    defined(__x86_64) || defined(_WIN32)
-            SWAP_SHORT(magic);
-            SWAP_SHORT(nDimensions);
-            SWAP_SHORT(width);
-            SWAP_SHORT(height);
-            SWAP_SHORT(depth);
-            SWAP_INT(minValue);
-            SWAP_INT(maxValue);
-            SWAP_INT(colorMode);
-#endif
-    }
+    uint64_t inDims[4];
+    result.pvp.convertToPlugin( inDims );
+    compressor.compress( result.pixels, inDims, result.compressorFlags );
 
-    unsigned short magic;
-    char compression;
-    char bytesPerChannel;
-    unsigned short nDimensions;
-    unsigned short width;
-    unsigned short height;
-    unsigned short depth;
-    unsigned minValue;
-    unsigned maxValue;
-    char unused[4];
-    char filename[80];
-    unsigned colorMode;
-    char fill[404];
+    const unsigned numResults = compressor.getNumResults();
+    result.compressedSize.resize( numResults );
+    result.compressedData.resize( numResults );
+
+    for( unsigned i = 0; i < numResults ; ++i )
+        compressor.getResult( i, &result.compressedData[i],
+                              &result.compressedSize[i] );
+    result.isCompressed = true;
 }
-/** @endcond */
-#ifndef _WIN32
-  __attribute__((packed))
-#endif
-;
 
-void put32f( std::ostream& os, const char* ptr )
+
+void Image::setPixelDataReference( const Frame::Buffer buffer,
+                                   const PixelData& pixels )
 {
-    const float& value = *(float*)(ptr);
-    const uint8_t byte = uint8_t( value * 255.f );
-    os.write( (const char*)&byte, 1 );
+    LBASSERT( pixels.compressorName <= EQ_COMPRESSOR_NONE );
+    LBASSERT( pixels.pixels );
+
+    _impl->setupMemory( buffer, pixels );
+    Memory& memory = _impl->getMemory( buffer );
+    memory.pixels = pixels.pixels;
+    memory.state = Memory::VALID;
 }
-void put16f( std::ostream& os, const char* ptr )
+
+//---------------------------------------------------------------------------
+// File IO
+//---------------------------------------------------------------------------
+bool Image::writeImages( const std::string& filenameTemplate ) const
 {
-    const uint16_t& value = *(uint16_t*)(ptr);
-    const float f = half_to_float( value );
-    put32f( os, (const char*)&f );
-}
+    return( writeImage( filenameTemplate + "_color.rgb", Frame::BUFFER_COLOR) &&
+            writeImage( filenameTemplate + "_depth.rgb", Frame::BUFFER_DEPTH ));
 }
 
 bool Image::writeImage( const std::string& filename,
                         const Frame::Buffer buffer ) const
 {
     const Memory& memory = _impl->getMemory( buffer );
-
-    const PixelViewport& pvp = memory.pvp;
-    const size_t nPixels = pvp.w * pvp.h;
-
-    if( nPixels == 0 || memory.state != Memory::VALID )
+    if( memory.state != Memory::VALID )
         return false;
 
-    std::ofstream image( filename.c_str(), std::ios::out | std::ios::binary );
-    if( !image.is_open( ))
-    {
-        LBERROR << "Can't open " << filename << " for writing" << std::endl;
-        return false;
-    }
-
-    RGBHeader header;
-    header.width  = pvp.w;
-    header.height = pvp.h;
-
-    switch( getExternalFormat( buffer ))
-    {
-        case EQ_COMPRESSOR_DATATYPE_RGB10_A2:
-            header.maxValue = 1023;
-        case EQ_COMPRESSOR_DATATYPE_BGRA:
-        case EQ_COMPRESSOR_DATATYPE_BGRA_UINT_8_8_8_8_REV:
-        case EQ_COMPRESSOR_DATATYPE_RGBA:
-        case EQ_COMPRESSOR_DATATYPE_RGBA_UINT_8_8_8_8_REV:
-            header.bytesPerChannel = 1;
-            header.depth = 4;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_BGR:
-        case EQ_COMPRESSOR_DATATYPE_RGB:
-            header.bytesPerChannel = 1;
-            header.depth = 3;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_BGRA32F:
-        case EQ_COMPRESSOR_DATATYPE_RGBA32F:
-            header.bytesPerChannel = 4;
-            header.depth = 4;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_BGR32F:
-        case EQ_COMPRESSOR_DATATYPE_RGB32F:
-            header.bytesPerChannel = 4;
-            header.depth = 3;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_BGRA16F:
-        case EQ_COMPRESSOR_DATATYPE_RGBA16F:
-            header.bytesPerChannel = 2;
-            header.depth = 4;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_BGR16F:
-        case EQ_COMPRESSOR_DATATYPE_RGB16F:
-            header.bytesPerChannel = 2;
-            header.depth = 3;
-            break;
-        case EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT:
-            header.bytesPerChannel = 4;
-            header.depth = 1;
-            break;
-
-        default:
-            LBERROR << "Unknown image pixel data type" << std::endl;
-            return false;
-    }
-
-    // Swap red & blue where needed
-    bool swapRB = false;
-    switch( getExternalFormat( buffer ))
-    {
-        case EQ_COMPRESSOR_DATATYPE_RGB10_A2:
-        case EQ_COMPRESSOR_DATATYPE_RGBA:
-        case EQ_COMPRESSOR_DATATYPE_RGBA_UINT_8_8_8_8_REV:
-        case EQ_COMPRESSOR_DATATYPE_RGB:
-        case EQ_COMPRESSOR_DATATYPE_RGBA32F:
-        case EQ_COMPRESSOR_DATATYPE_RGB32F:
-        case EQ_COMPRESSOR_DATATYPE_RGBA16F:
-        case EQ_COMPRESSOR_DATATYPE_RGB16F:
-            swapRB = true;
-    }
-
-    if( header.depth == 1 ) // depth
-    {
-        LBASSERT( (header.bytesPerChannel % 4) == 0 );
-        header.depth = 4;
-        header.bytesPerChannel /= 4;
-    }
-    LBASSERT( header.bytesPerChannel > 0 );
-
-    strncpy( header.filename, filename.c_str(), 80 );
-
-    if( header.bytesPerChannel > 2 )
-        LBWARN << static_cast< int >( header.bytesPerChannel )
-               << " bytes per channel not supported by RGB spec" << std::endl;
-
-    header.convert();
-    image.write( reinterpret_cast<const char *>( &header ), sizeof( header ));
-    header.convert();
-
-    // Each channel is saved separately
-    const uint8_t bpc = header.bytesPerChannel;
-    const uint16_t nChannels = header.depth;
-    const size_t depth  = nChannels * bpc;
-    const size_t nBytes = nPixels * depth;
-    const char* data = reinterpret_cast<const char*>( getPixelPointer( buffer));
-
-    if( nChannels == 3 || nChannels == 4 )
-    {
-        // channel one is R or B
-        if ( swapRB )
-            for( size_t j = 0 * bpc; j < nBytes; j += depth )
-                image.write( &data[j], bpc );
-        else
-            for( size_t j = 2 * bpc; j < nBytes; j += depth )
-                image.write( &data[j], bpc );
-
-        // channel two is G
-        for( size_t j = 1 * bpc; j < nBytes; j += depth )
-            image.write( &data[j], bpc );
-
-        // channel three is B or G
-        if ( swapRB )
-            for( size_t j = 2 * bpc; j < nBytes; j += depth )
-                image.write( &data[j], bpc );
-        else
-            for( size_t j = 0; j < nBytes; j += depth )
-                image.write( &data[j], bpc );
-
-        // channel four is Alpha
-        if( nChannels == 4 )
-            for( size_t j = 3 * bpc; j < nBytes; j += depth )
-                image.write( &data[j], bpc );
-    }
-    else
-    {
-        for( size_t i = 0; i < nChannels; i += bpc )
-           for( size_t j = i * bpc; j < nBytes; j += depth )
-              image.write(&data[j], bpc );
-    }
-    image.close();
-
-    if( header.bytesPerChannel == 1 )
-        return true;
-    // else also write 8bpp version
-
-    const std::string smallFilename = lunchbox::getDirname( filename ) + "/s_" +
-                                      lunchbox::getFilename( filename );
-    image.open( smallFilename.c_str(), std::ios::out | std::ios::binary );
-    if( !image.is_open( ))
-    {
-        LBERROR << "Can't open " << smallFilename << " for writing" <<std::endl;
-        return false;
-    }
-
-    header.bytesPerChannel = 1;
-    header.maxValue = 255;
-    header.convert();
-    image.write( reinterpret_cast<const char *>( &header ), sizeof( header ));
-    header.convert();
-
-    LBASSERTINFO( bpc == 2 || bpc == 4, bpc );
-    const bool twoBPC = bpc == 2;
-
-    if( nChannels == 3 || nChannels == 4 )
-    {
-        // channel one is R or B
-        if ( swapRB )
-            for( size_t j = 0 * bpc; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-        else
-            for( size_t j = 2 * bpc; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-
-        // channel two is G
-        for( size_t j = 1 * bpc; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-
-        // channel three is B or G
-        if ( swapRB )
-            for( size_t j = 2 * bpc; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-        else
-            for( size_t j = 0; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-
-         // channel four is Alpha
-        if( nChannels == 4 )
-            for( size_t j = 3 * bpc; j < nBytes; j += depth )
-                twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-    }
-    else
-    {
-        for( size_t i = 0; i < nChannels; i += bpc )
-           for( size_t j = i * bpc; j < nBytes; j += depth )
-               twoBPC ? put16f( image, &data[j] ) : put32f( image, &data[j] );
-    }
-    image.close();
-
-    return true;
+    detail::RGBWriter writer;
+    return writer.write( filename, getPixelPointer( buffer ), memory.pvp,
+                         getExternalFormat( buffer ), false );
 }
 
 bool Image::readImage( const std::string& filename, const Frame::Buffer buffer )
@@ -1363,15 +1190,14 @@ bool Image::readImage( const std::string& filename, const Frame::Buffer buffer )
     }
 
     const size_t size = image.getSize();
-    if( size < sizeof( RGBHeader ))
+    if( size < sizeof( detail::RGBHeader ))
     {
         LBWARN << "Image " << filename << " too small" << std::endl;
         return false;
     }
 
-    RGBHeader header;
+    detail::RGBHeader header;
     memcpy( &header, addr, sizeof( header ));
-    addr += sizeof( header );
 
     header.convert();
 
@@ -1385,7 +1211,8 @@ bool Image::readImage( const std::string& filename, const Frame::Buffer buffer )
         LBERROR << "Zero-sized image " << filename << std::endl;
         return false;
     }
-    if( header.compression != 0)
+    if( header.compression != 0 &&
+        ( header.compression != 1 || header.bytesPerChannel != 1 ))
     {
         LBERROR << "Unsupported compression " << filename << std::endl;
         return false;
@@ -1417,12 +1244,26 @@ bool Image::readImage( const std::string& filename, const Frame::Buffer buffer )
     const size_t  nComponents = nPixels * nChannels;
     const size_t  nBytes  = nComponents * bpc;
 
-    if( size < sizeof( RGBHeader ) + nBytes )
+    lunchbox::Bufferb planes;
+    if( header.compression )
     {
-        LBERROR << "Image " << filename << " too small" << std::endl;
-        return false;
+        if( !detail::decodeRLE( header, addr, size, planes ))
+        {
+            LBERROR << "Corrupt RLE data in " << filename << std::endl;
+            return false;
+        }
+        addr = planes.getData();
+    }
+    else
+    {
+        if( size < sizeof( detail::RGBHeader ) + nBytes )
+        {
+            LBERROR << "Image " << filename << " too small" << std::endl;
+            return false;
+        }
+        LBASSERT( size == sizeof( detail::RGBHeader ) + nBytes );
+        addr += sizeof( header );
     }
-    LBASSERT( size == sizeof( RGBHeader ) + nBytes );
 
     switch( buffer )
     {
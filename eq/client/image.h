@@ -23,6 +23,8 @@
 #include <eq/client/frame.h>         // for Frame::Buffer enum
 #include <eq/client/types.h>
 
+namespace lunchbox { class Compressor; }
+
 namespace eq
 {
 namespace detail { class Image; }
@@ -351,7 +353,11 @@ namespace detail { class Image; }
         /** Write all valid pixel data as separate images. @version 1.0 */
         EQ_API bool writeImages( const std::string& filenameTemplate ) const;
 
-        /** Read pixel data from an uncompressed rgb image file. @version 1.0 */
+        /**
+         * Read pixel data from an uncompressed or RLE compressed rgb image
+         * file.
+         * @version 1.0
+         */
         EQ_API bool readImage( const std::string& filename,
                                const Frame::Buffer buffer );
 
@@ -376,6 +382,41 @@ namespace detail { class Image; }
         findTransferers( const Frame::Buffer buffer, const GLEWContext* gl )
             const;
 
+        /**
+         * @internal
+         * Select the compressor used for transmitting the given buffer.
+         *
+         * Resolves EQ_COMPRESSOR_AUTO as done by compressPixelData().
+         * @return the compressor name, or EQ_COMPRESSOR_NONE.
+         */
+        EQ_API uint32_t selectCompressor( const Frame::Buffer buffer );
+
+        /**
+         * @internal
+         * Compress a band of rows of the pixel data.
+         *
+         * The band [y, y+h[ relative to the pixel viewport is compressed with
+         * the compressor chosen by selectCompressor(), which has to be called
+         * beforehand. The given compressor instance is set up as needed and
+         * holds the compressed data referenced by the result. Different bands
+         * may be compressed concurrently using different compressor instances.
+         */
+        EQ_API void compressPixelData( const Frame::Buffer buffer,
+                                       const int32_t y, const int32_t h,
+                                       lunchbox::Compressor& compressor,
+                                       PixelData& result ) const;
+
+        /**
+         * @internal
+         * Set uncompressed pixel data of the given buffer without copying it.
+         *
+         * The image references the memory of the given pixel data, which has
+         * to stay valid and unmodified until the pixel data of the buffer is
+         * set, validated or flushed again.
+         */
+        EQ_API void setPixelDataReference( const Frame::Buffer buffer,
+                                           const PixelData& data );
+
         /** @internal Re-allocate, if needed, a compressor instance. */
         EQ_API bool allocCompressor( const Frame::Buffer buffer,
                                      const uint32_t name );
@@ -0,0 +1,207 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "imageWriter.h"
+
+#include "image.h"
+#include "log.h"
+#include "pixelData.h"
+#include "detail/rgbFile.h"
+
+#include <lunchbox/atomic.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/thread.h>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** One queued image buffer. */
+struct Job
+{
+    Job() : format( 0 ), compress( false ) {}
+
+    std::string filename;
+    lunchbox::Bufferb pixels;
+    PixelViewport pvp;
+    uint32_t format;
+    bool compress;
+};
+typedef lunchbox::MTQueue< Job* > JobQueue;
+}
+
+class ImageWriter : public lunchbox::Thread
+{
+public:
+    ImageWriter( const size_t nBuffers, const size_t bufferSize )
+        : compress( false )
+        , nDropped( 0 )
+        , nFailed( 0 )
+        , _pending( 0 )
+    {
+        LBASSERT( nBuffers > 0 );
+        for( size_t i = 0; i < nBuffers; ++i )
+        {
+            Job* job = new Job;
+            job->pixels.reserve( bufferSize );
+            _jobs.push_back( job );
+            _free.push( job );
+        }
+        start();
+    }
+
+    virtual ~ImageWriter()
+    {
+        _queued.push( 0 ); // exit thread after writing all queued images
+        join();
+        for( std::vector< Job* >::const_iterator i = _jobs.begin();
+             i != _jobs.end(); ++i )
+        {
+            delete *i;
+        }
+    }
+
+    bool write( const Image& image, const Frame::Buffer buffer,
+                const std::string& filename )
+    {
+        if( !image.hasPixelData( buffer ))
+            return false;
+
+        Job* job = 0;
+        if( !_free.tryPop( job ))
+        {
+            ++nDropped;
+            LBLOG( LOG_ASSEMBLY ) << "Writer busy, dropping " << filename
+                                  << std::endl;
+            return false;
+        }
+
+        const PixelData& pixels = image.getPixelData( buffer );
+        job->filename = filename;
+        // reuses the allocation of the job if the pixel data fits
+        job->pixels.replace( pixels.pixels, image.getPixelDataSize( buffer ));
+        job->pvp = pixels.pvp;
+        job->format = pixels.externalFormat;
+        job->compress = compress;
+
+        ++_pending;
+        _queued.push( job );
+        return true;
+    }
+
+    void flush() { _pending.waitEQ( 0 ); }
+
+    bool compress;
+    size_t nDropped;
+    lunchbox::a_int32_t nFailed; //!< updated by the writer thread
+
+protected:
+    virtual void run()
+    {
+        lunchbox::Thread::setName( "ImageWriter" );
+        while( Job* job = _queued.pop( ))
+        {
+            if( !_writer.write( job->filename, job->pixels.getData(),
+                                job->pvp, job->format, job->compress ))
+            {
+                ++nFailed;
+                LBWARN << "Failed to write image " << job->filename
+                       << std::endl;
+            }
+            _free.push( job );
+            --_pending;
+        }
+    }
+
+private:
+    std::vector< Job* > _jobs;
+    JobQueue _queued; //!< jobs to write, 0 stops the thread
+    JobQueue _free;   //!< preallocated jobs available for writing
+    lunchbox::Monitor< size_t > _pending; //!< number of queued jobs
+    RGBWriter _writer; //!< used by the writer thread only
+};
+}
+
+ImageWriter::ImageWriter( const size_t nBuffers, const size_t bufferSize )
+    : _impl( new detail::ImageWriter( nBuffers, bufferSize ))
+{
+}
+
+ImageWriter::~ImageWriter()
+{
+    delete _impl;
+}
+
+void ImageWriter::setCompression( const bool enabled )
+{
+    _impl->compress = enabled;
+}
+
+bool ImageWriter::getCompression() const
+{
+    return _impl->compress;
+}
+
+bool ImageWriter::writeImage( const Image& image, const Frame::Buffer buffer,
+                              const std::string& filename )
+{
+    return _impl->write( image, buffer, filename );
+}
+
+bool ImageWriter::writeImages( const Image& image,
+                               const std::string& filenameTemplate )
+{
+    bool queued = false;
+    bool dropped = false;
+    if( image.hasPixelData( Frame::BUFFER_COLOR ))
+    {
+        if( _impl->write( image, Frame::BUFFER_COLOR,
+                          filenameTemplate + "_color.rgb" ))
+            queued = true;
+        else
+            dropped = true;
+    }
+    if( image.hasPixelData( Frame::BUFFER_DEPTH ))
+    {
+        if( _impl->write( image, Frame::BUFFER_DEPTH,
+                          filenameTemplate + "_depth.rgb" ))
+            queued = true;
+        else
+            dropped = true;
+    }
+    return queued && !dropped;
+}
+
+void ImageWriter::flush()
+{
+    _impl->flush();
+}
+
+size_t ImageWriter::getNumDropped() const
+{
+    return _impl->nDropped;
+}
+
+size_t ImageWriter::getNumFailed() const
+{
+    return size_t( int32_t( _impl->nFailed ));
+}
+
+}
@@ -0,0 +1,121 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_IMAGEWRITER_H
+#define EQ_IMAGEWRITER_H
+
+#include <eq/client/api.h>
+#include <eq/client/frame.h>         // for Frame::Buffer enum
+#include <eq/client/types.h>
+
+namespace eq
+{
+namespace detail { class ImageWriter; }
+
+    /**
+     * Writes images asynchronously as rgb files.
+     *
+     * The pixel data of an image is copied into one of a fixed number of
+     * buffers, and written by a background thread. When all buffers are in
+     * use, for example because the disk is slower than the rendering, the
+     * image is dropped instead of stalling the caller. The buffers are
+     * allocated with the given size by the constructor, and grow when an
+     * image is queued whose pixel data does not fit. Queueing images of a
+     * constant size does not allocate memory after the first frames.
+     *
+     * The writer is intended to capture frames during rendering, e.g., from
+     * Channel::frameReadback. All methods have to be called from the same
+     * thread.
+     */
+    class ImageWriter
+    {
+    public:
+        /**
+         * Construct a new image writer and start its writer thread.
+         *
+         * @param nBuffers the number of images which can be queued.
+         * @param bufferSize the size in bytes to allocate for each buffer,
+         *                   e.g., Image::getPixelDataSize() of the images to
+         *                   be written. 0 allocates on first use.
+         * @version 1.5.2
+         */
+        EQ_API explicit ImageWriter( const size_t nBuffers = 4,
+                                     const size_t bufferSize = 0 );
+
+        /** Write all queued images and destruct the writer. @version 1.5.2 */
+        EQ_API ~ImageWriter();
+
+        /**
+         * Enable run-length encoding of subsequently queued images.
+         *
+         * Only images with 8 bit channels are compressed. Compressed files are
+         * smaller and faster to write for images with uniform areas, and are
+         * supported by Image::readImage and other rgb readers. Default off.
+         * @version 1.5.2
+         */
+        EQ_API void setCompression( const bool enabled );
+
+        /** @return true if images are compressed. @version 1.5.2 */
+        EQ_API bool getCompression() const;
+
+        /**
+         * Queue the pixel data of one image buffer for writing.
+         *
+         * @param image the image holding the pixel data.
+         * @param buffer the buffer to write.
+         * @param filename the output file name.
+         * @return true if the image was queued, false if it has no pixel data
+         *         for the given buffer or if it was dropped.
+         * @version 1.5.2
+         */
+        EQ_API bool writeImage( const Image& image, const Frame::Buffer buffer,
+                                const std::string& filename );
+
+        /**
+         * Queue all valid pixel data of an image as separate files.
+         *
+         * The color and depth buffers are written to filenameTemplate with
+         * '_color.rgb' and '_depth.rgb' appended, respectively.
+         *
+         * @return true if all valid buffers were queued, false if the image
+         *         has no pixel data or if a buffer was dropped.
+         * @version 1.5.2
+         */
+        EQ_API bool writeImages( const Image& image,
+                                 const std::string& filenameTemplate );
+
+        /** Wait until all queued images are written. @version 1.5.2 */
+        EQ_API void flush();
+
+        /** @return the number of images dropped so far. @version 1.5.2 */
+        EQ_API size_t getNumDropped() const;
+
+        /**
+         * @return the number of queued images which could not be written so
+         *         far, e.g., due to a full disk or an invalid path.
+         * @version 1.5.2
+         */
+        EQ_API size_t getNumFailed() const;
+
+    private:
+        ImageWriter( const ImageWriter& );
+        ImageWriter& operator = ( const ImageWriter& );
+        detail::ImageWriter* const _impl;
+    };
+}
+
+#endif // EQ_IMAGEWRITER_H
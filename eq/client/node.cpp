@@ -24,6 +24,7 @@
 #include "error.h"
 #include "exception.h"
 #include "frameData.h"
+#include "frameRecorder.h"
 #include "global.h"
 #include "log.h"
 #include "nodeFactory.h"
@@ -38,6 +39,7 @@
 #include <co/barrier.h>
 #include <co/connection.h>
 #include <co/objectICommand.h>
+#include <co/queueSlave.h>
 #include <lunchbox/scopedMutex.h>
 
 namespace eq
@@ -47,6 +49,15 @@ typedef co::CommandFunc<Node> NodeFunc;
 typedef fabric::Node< Config, Node, Pipe, NodeVisitor > Super;
 /** @endcond */
 
+struct Node::Private
+{
+    Private() : recorder( 0 ) {}
+    ~Private() { delete recorder; }
+
+    /** Records received images if EQ_RECORD_FRAMES is set. */
+    FrameRecorder* recorder;
+};
+
 Node::Node( Config* parent )
         : Super( parent )
 #pragma warning(push)
@@ -56,12 +67,14 @@ Node::Node( Config* parent )
         , _state( STATE_STOPPED )
         , _finishedFrame( 0 )
         , _unlockedFrame( 0 )
+        , _private( new Private )
 {
 }
 
 Node::~Node()
 {
     LBASSERT( getPipes().empty( ));
+    delete _private;
 }
 
 void Node::attach( const UUID& id, const uint32_t instanceID )
@@ -175,6 +188,25 @@ void Node::releaseFrameData( FrameDataPtr data )
     _frameDatas->erase( i );
 }
 
+co::QueueSlave* Node::getQueue( const UUID& queueID )
+{
+    if( queueID == 0 )
+        return 0;
+
+    lunchbox::ScopedMutex<> mutex( _queues );
+    co::QueueSlave* queue = _queues.data[ queueID ];
+    if( !queue )
+    {
+        queue = new co::QueueSlave;
+        ClientPtr client = getClient();
+        LBCHECK( client->mapObject( queue, queueID ));
+
+        _queues.data[ queueID ] = queue;
+    }
+
+    return queue;
+}
+
 void Node::waitInitialized() const
 {
     _state.waitGE( STATE_INIT_FAILED );
@@ -259,6 +291,7 @@ void Node::_frameFinish( const uint128_t& frameID,
     frameFinish( frameID, frameNumber );
     LBLOG( LOG_TASKS ) << "---- Finished Frame --- " << frameNumber
                        << std::endl;
+    getConfig()->flushStatistics();
 
     if( _unlockedFrame < frameNumber )
     {
@@ -391,6 +424,17 @@ void Node::_flushObjects()
         }
         _barriers->clear();
     }
+    {
+        lunchbox::ScopedMutex<> mutex( _queues );
+        for( QueueHash::const_iterator i = _queues->begin();
+             i != _queues->end(); ++i )
+        {
+            co::QueueSlave* queue = i->second;
+            client->unmapObject( queue );
+            delete queue;
+        }
+        _queues->clear();
+    }
 
     lunchbox::ScopedMutex<> mutex( _frameDatas );
     for( FrameDataHashCIter i = _frameDatas->begin();
@@ -494,6 +538,18 @@ bool Node::_cmdConfigInit( co::ICommand& cmd )
     _setAffinity();
 
     transmitter.start();
+
+    const char* recordPrefix = getenv( "EQ_RECORD_FRAMES" );
+    if( recordPrefix && !_private->recorder )
+    {
+        const std::string filename = std::string( recordPrefix ) + "_" +
+                                     getID().getShortString() + ".eqr";
+        _private->recorder = new FrameRecorder;
+        if( _private->recorder->open( filename ))
+            LBINFO << "Recording received images to " << filename
+                   << std::endl;
+    }
+
     setError( ERROR_NONE );
     const uint64_t result = configInit( initID );
 
@@ -525,6 +581,8 @@ bool Node::_cmdConfigExit( co::ICommand& cmd )
     transmitter.getQueue().push( co::ICommand( )); // wake up to exit
     transmitter.join();
     _flushObjects();
+    if( _private->recorder )
+        _private->recorder->close();
 
     getConfig()->send( getLocalNode(),
                        fabric::CMD_CONFIG_DESTROY_NODE ) << getID();
@@ -622,8 +680,9 @@ bool Node::_cmdFrameDataTransmit( co::ICommand& cmd )
     const uint32_t buffers = command.get< uint32_t >();
     const uint32_t frameNumber = command.get< uint32_t >();
     const bool useAlpha = command.get< bool >();
+    const uint64_t size = command.getRemainingBufferSize();
     const uint8_t* data = reinterpret_cast< const uint8_t* >(
-                command.getRemainingBuffer( command.getRemainingBufferSize( )));
+                                            command.getRemainingBuffer( size ));
 
     LBLOG( LOG_ASSEMBLY )
         << "received image data for " << frameDataVersion << ", buffers "
@@ -634,6 +693,20 @@ bool Node::_cmdFrameDataTransmit( co::ICommand& cmd )
     FrameDataPtr frameData = getFrameData( frameDataVersion );
     LBASSERT( !frameData->isReady() );
 
+    if( _private->recorder )
+    {
+        FrameRecord record;
+        record.frameDataID = frameDataVersion.identifier;
+        record.size = size;
+        record.frameNumber = frameNumber;
+        record.buffers = buffers;
+        record.pvp = pvp;
+        record.zoom = zoom;
+        record.useAlpha = useAlpha ? 1 : 0;
+        record.reserved = 0;
+        _private->recorder->append( record, data );
+    }
+
     NodeStatistics event( Statistic::NODE_FRAME_DECOMPRESS, this,
                           frameNumber );
 
@@ -641,7 +714,8 @@ bool Node::_cmdFrameDataTransmit( co::ICommand& cmd )
     // pointers, we have to go non-const at some point, even though we do not
     // modify the data.
     LBCHECK( frameData->addImage( frameDataVersion, pvp, zoom, buffers,
-                                  useAlpha, const_cast< uint8_t* >( data )));
+                                  useAlpha, const_cast< uint8_t* >( data ),
+                                  cmd ));
     return true;
 }
 
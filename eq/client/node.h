@@ -88,6 +88,18 @@ namespace eq
         /** @internal Release the frame data instance. */
         void releaseFrameData( FrameDataPtr data );
 
+        /**
+         * @internal
+         * Get a tile queue.
+         *
+         * The queue is shared by all pipes of the node, so that tiles
+         * prefetched from the server are rendered by the first idle channel.
+         *
+         * @param queueID the queue identifier.
+         * @return the queue.
+         */
+        co::QueueSlave* getQueue( const UUID& queueID );
+
         /** @internal Wait for the node to be initialized. */
         EQ_API void waitInitialized() const;
 
@@ -287,6 +299,10 @@ namespace eq
         /** All frame datas used by the node during rendering. */
         lunchbox::Lockable< FrameDataHash > _frameDatas;
 
+        typedef stde::hash_map< uint128_t, co::QueueSlave* > QueueHash;
+        /** All tile queues used by the node's channels during rendering. */
+        lunchbox::Lockable< QueueHash > _queues;
+
         struct Private;
         Private* _private; // placeholder for binary-compatible changes
 
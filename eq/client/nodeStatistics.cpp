@@ -75,7 +75,7 @@ NodeStatistics::~NodeStatistics()
     event.statistic.endTime = config->getTime();
     if( event.statistic.endTime <= event.statistic.startTime )
         event.statistic.endTime = event.statistic.startTime + 1;
-    config->sendEvent( event.type ) << event;
+    config->sendStatistic( event );
 }
 
 }
@@ -48,7 +48,6 @@
 #include <eq/fabric/task.h>
 
 #include <co/objectICommand.h>
-#include <co/queueSlave.h>
 #include <co/worker.h>
 #include <sstream>
 
@@ -79,12 +78,10 @@ enum State
 typedef stde::hash_map< uint128_t, Frame* > FrameHash;
 typedef stde::hash_map< uint128_t, FrameDataPtr > FrameDataHash;
 typedef stde::hash_map< uint128_t, View* > ViewHash;
-typedef stde::hash_map< uint128_t, co::QueueSlave* > QueueHash;
 typedef FrameHash::const_iterator FrameHashCIter;
 typedef FrameDataHash::const_iterator FrameDataHashCIter;
 typedef ViewHash::const_iterator ViewHashCIter;
 typedef ViewHash::iterator ViewHashIter;
-typedef QueueHash::const_iterator QueueHashCIter;
 }
 
 namespace detail
@@ -180,9 +177,6 @@ public:
     /** All views used by the pipe's channels during rendering. */
     ViewHash views;
 
-    /** All queues used by the pipe's channels during rendering. */
-    QueueHash queues;
-
     /** The pipe thread. */
     RenderThread* thread;
 
@@ -557,34 +551,7 @@ void Pipe::flushFrames( ObjectManager* om )
 co::QueueSlave* Pipe::getQueue( const UUID& queueID )
 {
     LB_TS_THREAD( _pipeThread );
-    if( queueID == 0 )
-        return 0;
-
-    co::QueueSlave* queue = _impl->queues[ queueID ];
-    if( !queue )
-    {
-        queue = new co::QueueSlave;
-        ClientPtr client = getClient();
-        LBCHECK( client->mapObject( queue, queueID ));
-
-        _impl->queues[ queueID ] = queue;
-    }
-
-    return queue;
-}
-
-void Pipe::_flushQueues()
-{
-    LB_TS_THREAD( _pipeThread );
-    ClientPtr client = getClient();
-
-    for( QueueHashCIter i = _impl->queues.begin(); i !=_impl->queues.end(); ++i)
-    {
-        co::QueueSlave* queue = i->second;
-        client->unmapObject( queue );
-        delete queue;
-    }
-    _impl->queues.clear();
+    return getNode()->getQueue( queueID );
 }
 
 const View* Pipe::getView( const co::ObjectVersion& viewVersion ) const
@@ -1110,7 +1077,6 @@ bool Pipe::_cmdConfigExit( co::ICommand& cmd )
     // - application may need initialized pipe to exit
     // - configExit can't access views since all channels are gone already
     _flushViews();
-    _flushQueues();
     _impl->state = configExit() ? STATE_STOPPED : STATE_FAILED;
     return true;
 }
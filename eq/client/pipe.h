@@ -121,7 +121,7 @@ namespace detail { class Pipe; class RenderThread; class ThreadAffinityVisitor;
         Frame* getFrame( const co::ObjectVersion& frameVersion,
                          const Eye eye, const bool output );
 
-        /** @internal @return the queue for the given identifier and version. */
+        /** @internal @return the node's queue for the given identifier. */
         co::QueueSlave* getQueue( const UUID& queueID );
 
         /** @internal Clear the frame cache and delete all frames. */
@@ -386,9 +386,6 @@ namespace detail { class Pipe; class RenderThread; class ThreadAffinityVisitor;
         /** @internal Clear the view cache and release all views. */
         void _flushViews();
 
-        /** @internal Clear the queue cache and release all queues. */
-        void _flushQueues();
-
         /* The command functions. */
         bool _cmdCreateWindow( co::ICommand& command );
         bool _cmdDestroyWindow( co::ICommand& command );
@@ -63,7 +63,7 @@ PipeStatistics::~PipeStatistics()
     if( event.statistic.endTime <= event.statistic.startTime )
         event.statistic.endTime = event.statistic.startTime + 1;
 
-    config->sendEvent( event.type ) << event;
+    config->sendStatistic( event );
 }
 
 }
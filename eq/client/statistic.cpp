@@ -81,6 +81,10 @@ static StatisticData _statisticData[] =
    "finish frame", Vector3f( .5f, .5f, .5f ) },
  { Statistic::CONFIG_WAIT_FINISH_FRAME,
    "wait finish",  Vector3f( 1.0f, 0.f, 0.f ) },
+ { Statistic::CONFIG_UPDATE_FRAME,
+   "server update", Vector3f( .5f, .5f, 1.f ) },
+ { Statistic::NODE_FRAME_TASKS,
+   "tasks",        Vector3f( .5f, .5f, 1.f ) },
  { Statistic::ALL,
    "ALL EVENTS",   Vector3f( 0.0f, 0.f, 0.f ) }} ;
 }
@@ -108,6 +112,8 @@ std::ostream& operator << ( std::ostream& os, const Statistic& event )
     os << event.resourceName << ": " << event.type << ' ' << event.frameNumber
        << ' ' << event.task << ' ' << event.startTime << " - " << event.endTime
        << ' ' << event.idleTime << '/' << event.totalTime;
+    if( event.type == Statistic::NODE_FRAME_TASKS )
+        os << ' ' << event.size << " bytes";
     return os;
 }
 
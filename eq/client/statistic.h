@@ -63,6 +63,10 @@ namespace eq
             CONFIG_FINISH_FRAME, //!< Sampling of Config::finishFrame
             /** Sampling of synchronization time during Config::finishFrame */
             CONFIG_WAIT_FINISH_FRAME,
+            /** Sampling of the task generation on the server */
+            CONFIG_UPDATE_FRAME,
+            /** Task generation of a node on the server, with the task size */
+            NODE_FRAME_TASKS,
             ALL          // must be last
         };
 
@@ -79,7 +83,7 @@ namespace eq
         float    ratio; //!< compression ratio (transfer, compression)
         float    currentFPS; //!< FPS of last frame (WINDOW_FPS)
         float    averageFPS; //!< Weighted sum averaging of FPS (WINDOW_FPS)
-        float    pad; //!< @internal
+        uint32_t size; //!< Transmitted bytes (NODE_FRAME_TASKS)
 
         char resourceName[32]; //!< A non-unique name of the originator
 
@@ -117,6 +121,7 @@ template<> inline void byteswap( eq::Statistic& value )
     byteswap( value.ratio );
     byteswap( value.currentFPS );
     byteswap( value.averageFPS );
+    byteswap( value.size );
 }
 }
 
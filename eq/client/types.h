@@ -40,7 +40,10 @@ class Config;
 class EventICommand;
 class Frame;
 class FrameData;
+class FrameRecorder;
+class FrameRecording;
 class Image;
+class ImageWriter;
 class Layout;
 class MessagePump;
 class Node;
@@ -92,6 +95,8 @@ using fabric::Range;
 using fabric::RenderContext;
 using fabric::SubPixel;
 using fabric::Tile;
+using fabric::TileTime;
+using fabric::TileTimes;
 using fabric::Viewport;
 using fabric::Wall;
 using fabric::Zoom;
@@ -642,11 +642,14 @@ bool Window::processEvent( const Event& event )
             // else fall through
         case Event::WINDOW_EXPOSE:
         case Event::WINDOW_CLOSE:
-        case Event::STATISTIC:
         case Event::MAGELLAN_AXIS:
         case Event::MAGELLAN_BUTTON:
             break;
 
+        case Event::STATISTIC:
+            getConfig()->sendStatistic( event );
+            return true;
+
         case Event::WINDOW_POINTER_GRAB:
             _grabbedChannels = _getEventChannels( event.pointer );
             break;
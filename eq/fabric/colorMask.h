@@ -41,6 +41,17 @@ namespace fabric
                    const bool a = true )
                 : red( r ), green( g ), blue( b ), alpha( a ) {}
 
+        /** @return true if the color masks are identical. @version 1.5.2 */
+        bool operator == ( const ColorMask& rhs ) const
+        {
+            return red == rhs.red && green == rhs.green && blue == rhs.blue &&
+                   alpha == rhs.alpha;
+        }
+
+        /** @return true if the color masks are not identical. @version 1.5.2*/
+        bool operator != ( const ColorMask& rhs ) const
+            { return !( *this == rhs ); }
+
         bool red;
         bool green;
         bool blue;
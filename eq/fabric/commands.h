@@ -90,6 +90,7 @@ namespace fabric
         CMD_CONFIG_SYNC_CLOCK,
         CMD_CONFIG_SWAP_OBJECT,
         CMD_CONFIG_CHECK_FRAME,
+        CMD_CONFIG_STATISTICS,
         CMD_CONFIG_CUSTOM = CMD_OBJECT_CUSTOM + 30
     };
 
@@ -36,6 +36,7 @@ class Equalizer
 public:
     Equalizer()
         : damping( .5f )
+        , historyDamping( 0.f )
         , boundaryf( std::numeric_limits<float>::epsilon( ))
         , resistancef( .0f )
         , assembleOnlyLimit( std::numeric_limits< float >::max( ))
@@ -67,6 +68,7 @@ public:
 
     Equalizer( const Equalizer& rhs )
         : damping( rhs.damping )
+        , historyDamping( rhs.historyDamping )
         , boundaryf( rhs.boundaryf )
         , resistancef( rhs.resistancef )
         , assembleOnlyLimit( rhs.assembleOnlyLimit )
@@ -79,6 +81,7 @@ public:
     {}
 
     float damping;
+    float historyDamping;
     float boundaryf;
     float resistancef;
     float assembleOnlyLimit;
@@ -145,6 +148,17 @@ float Equalizer::getDamping() const
     return _data->damping;
 }
 
+void Equalizer::setHistoryDamping( const float damping )
+{
+    LBASSERT( damping >= 0.f && damping < 1.f );
+    _data->historyDamping = damping;
+}
+
+float Equalizer::getHistoryDamping() const
+{
+    return _data->historyDamping;
+}
+
 void Equalizer::setFrameRate( const float frameRate )
 {
     _data->frameRate = frameRate;
@@ -219,18 +233,18 @@ const Vector2i& Equalizer::getTileSize() const
 
 void Equalizer::serialize( co::DataOStream& os ) const
 {
-    os << _data->damping << _data->boundaryf << _data->resistancef
-       << _data->assembleOnlyLimit << _data->frameRate << _data->boundary2i
-       << _data->resistance2i << _data->tilesize << _data->mode
-       << _data->frozen;
+    os << _data->damping << _data->historyDamping << _data->boundaryf
+       << _data->resistancef << _data->assembleOnlyLimit << _data->frameRate
+       << _data->boundary2i << _data->resistance2i << _data->tilesize
+       << _data->mode << _data->frozen;
 }
 
 void Equalizer::deserialize( co::DataIStream& is )
 {
-    is >> _data->damping >> _data->boundaryf >> _data->resistancef
-       >> _data->assembleOnlyLimit >> _data->frameRate >> _data->boundary2i
-       >> _data->resistance2i >> _data->tilesize >> _data->mode
-       >> _data->frozen;
+    is >> _data->damping >> _data->historyDamping >> _data->boundaryf
+       >> _data->resistancef >> _data->assembleOnlyLimit >> _data->frameRate
+       >> _data->boundary2i >> _data->resistance2i >> _data->tilesize
+       >> _data->mode >> _data->frozen;
 }
 
 void Equalizer::backup()
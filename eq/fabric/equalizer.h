@@ -78,6 +78,18 @@ namespace detail { class Equalizer; }
         /** @return the damping factor. */
         EQFABRIC_API float getDamping() const;
 
+        /**
+         * Set the damping of older load data for the LoadEqualizer.
+         *
+         * With a non-zero value, the load of the last frames is combined with
+         * a weight decaying by this factor per frame. Zero uses the last frame
+         * only.
+         */
+        EQFABRIC_API void setHistoryDamping( const float damping );
+
+        /** @return the damping of older load data. */
+        EQFABRIC_API float getHistoryDamping() const;
+
         /** Set the average frame rate for the DFREqualizer. */
         EQFABRIC_API void setFrameRate( const float frameRate );
 
@@ -42,6 +42,7 @@ set(EQ_FABRIC_PUBLIC_HEADERS
   projection.h
   range.h
   renderContext.h
+  renderContextCache.h
   segment.h
   server.h
   subPixel.h
@@ -90,6 +91,7 @@ set(EQ_FABRIC_SOURCES
   projection.cpp
   range.cpp
   renderContext.cpp
+  renderContextCache.cpp
   subPixel.cpp
   swapBarrier.cpp
   viewport.cpp
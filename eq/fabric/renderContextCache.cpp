@@ -0,0 +1,162 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "renderContextCache.h"
+
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+
+namespace eq
+{
+namespace fabric
+{
+namespace
+{
+/** The groups of fields of a RenderContext which are transmitted together. */
+enum DirtyBits
+{
+    DIRTY_FRUSTUM       = 1 << 0, // frustum, ortho and transforms
+    DIRTY_VIEW          = 1 << 1,
+    DIRTY_VIEWPORT      = 1 << 2, // pvp, pixel, overdraw, vp and offset
+    DIRTY_DECOMPOSITION = 1 << 3, // range, subpixel, zoom, period and phase
+    DIRTY_BUFFER        = 1 << 4, // buffer, taskID, eye and buffer mask
+    DIRTY_ALL           = 0x1f
+};
+
+uint32_t _getDirty( const RenderContext& old, const RenderContext& context )
+{
+    uint32_t dirty = 0;
+    if( !( old.frustum == context.frustum ) ||
+        !( old.ortho == context.ortho ) ||
+        old.headTransform != context.headTransform ||
+        old.orthoTransform != context.orthoTransform )
+    {
+        dirty |= DIRTY_FRUSTUM;
+    }
+    if( old.view != context.view )
+        dirty |= DIRTY_VIEW;
+    if( old.pvp != context.pvp || old.pixel != context.pixel ||
+        old.overdraw != context.overdraw || old.vp != context.vp ||
+        old.offset != context.offset )
+    {
+        dirty |= DIRTY_VIEWPORT;
+    }
+    if( old.range != context.range || old.subpixel != context.subpixel ||
+        old.zoom != context.zoom || old.period != context.period ||
+        old.phase != context.phase )
+    {
+        dirty |= DIRTY_DECOMPOSITION;
+    }
+    if( old.buffer != context.buffer || old.taskID != context.taskID ||
+        old.eye != context.eye || old.bufferMask != context.bufferMask )
+    {
+        dirty |= DIRTY_BUFFER;
+    }
+    return dirty;
+}
+}
+
+RenderContextCache::RenderContextCache()
+        : _position( 0 )
+        , _synchronized( true )
+{}
+
+void RenderContextCache::clear()
+{
+    _contexts.clear();
+    _position = 0;
+    _synchronized = true;
+}
+
+void RenderContextCache::write( co::DataOStream& os,
+                                const RenderContext& context )
+{
+    uint32_t dirty = DIRTY_ALL;
+    if( _position < _contexts.size( ))
+    {
+        RenderContext& cached = _contexts[ _position ];
+        dirty = _getDirty( cached, context );
+        os << dirty;
+        if( dirty != DIRTY_ALL )
+            os << cached.frameID; // base of the delta
+        cached = context;
+    }
+    else
+    {
+        os << dirty;
+        _contexts.push_back( context );
+    }
+    ++_position;
+
+    os << context.frameID;
+    if( dirty & DIRTY_FRUSTUM )
+        os << context.frustum << context.ortho << context.headTransform
+           << context.orthoTransform;
+    if( dirty & DIRTY_VIEW )
+        os << context.view;
+    if( dirty & DIRTY_VIEWPORT )
+        os << context.pvp << context.pixel << context.overdraw << context.vp
+           << context.offset;
+    if( dirty & DIRTY_DECOMPOSITION )
+        os << context.range << context.subpixel << context.zoom
+           << context.period << context.phase;
+    if( dirty & DIRTY_BUFFER )
+        os << context.buffer << context.taskID << context.eye
+           << context.bufferMask;
+}
+
+const RenderContext& RenderContextCache::read( co::DataIStream& is )
+{
+    uint32_t dirty = 0;
+    is >> dirty;
+
+    uint128_t base;
+    if( dirty != DIRTY_ALL )
+        is >> base;
+
+    if( _position >= _contexts.size( ))
+        _contexts.push_back( RenderContext( ));
+
+    RenderContext& cached = _contexts[ _position++ ];
+    if( dirty != DIRTY_ALL && cached.frameID != base && _synchronized )
+    {
+        LBERROR << "Render context " << _position - 1 << " of "
+                << _contexts.size() << " does not match the transmitted "
+                << "delta, render contexts are out of sync" << std::endl;
+        _synchronized = false;
+    }
+
+    is >> cached.frameID;
+    if( dirty & DIRTY_FRUSTUM )
+        is >> cached.frustum >> cached.ortho >> cached.headTransform
+           >> cached.orthoTransform;
+    if( dirty & DIRTY_VIEW )
+        is >> cached.view;
+    if( dirty & DIRTY_VIEWPORT )
+        is >> cached.pvp >> cached.pixel >> cached.overdraw >> cached.vp
+           >> cached.offset;
+    if( dirty & DIRTY_DECOMPOSITION )
+        is >> cached.range >> cached.subpixel >> cached.zoom >> cached.period
+           >> cached.phase;
+    if( dirty & DIRTY_BUFFER )
+        is >> cached.buffer >> cached.taskID >> cached.eye
+           >> cached.bufferMask;
+    return cached;
+}
+
+}
+}
@@ -0,0 +1,77 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQFABRIC_RENDERCONTEXTCACHE_H
+#define EQFABRIC_RENDERCONTEXTCACHE_H
+
+#include <eq/fabric/renderContext.h> // member
+#include <eq/fabric/api.h>
+
+#include <co/types.h>
+#include <vector>
+
+namespace eq
+{
+namespace fabric
+{
+    /**
+     * @internal
+     * Delta-encodes the render contexts of the frame tasks of a channel.
+     *
+     * The server and the render client each keep the contexts of the last
+     * frame, indexed by their position in the task stream of the channel. A
+     * context is transmitted as the frame identifier and the fields which
+     * changed since the context at the same position in the last frame. Tasks
+     * without a cached context, e.g., after initialization or when the
+     * compound configuration changed, are transmitted in full.
+     *
+     * Both sides have to rewind() the cache at the same task, which is the
+     * channel frame start, and have to clear() it on (re-)initialization.
+     * Each delta carries the frame identifier of its base context. A reader
+     * without this base context reports an error and is no longer
+     * synchronized until the next clear().
+     */
+    class RenderContextCache
+    {
+    public:
+        EQFABRIC_API RenderContextCache();
+
+        /** Drop all cached contexts. */
+        EQFABRIC_API void clear();
+
+        /** Start the task stream of a new frame. */
+        void rewind() { _position = 0; }
+
+        /** Encode the next context of the task stream. */
+        EQFABRIC_API void write( co::DataOStream& os,
+                                 const RenderContext& context );
+
+        /** Decode and return the next context of the task stream. */
+        EQFABRIC_API const RenderContext& read( co::DataIStream& is );
+
+        /** @return false if a delta did not match the cached context. */
+        bool isSynchronized() const { return _synchronized; }
+
+    private:
+        std::vector< RenderContext > _contexts;
+        size_t _position;
+        bool _synchronized;
+    };
+}
+}
+
+#endif // EQFABRIC_RENDERCONTEXTCACHE_H
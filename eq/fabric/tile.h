@@ -38,6 +38,19 @@ namespace fabric
         PixelViewport pvp;
         Viewport vp;
     };
+
+    /** @internal The rendering time of one tile, fed back to the server. */
+    struct TileTime
+    {
+        TileTime() : time( 0.f ) {}
+        TileTime( const uint128_t& queue_, const PixelViewport& pvp_,
+                  const float time_ )
+                : queue( queue_ ), pvp( pvp_ ), time( time_ ) {}
+
+        uint128_t queue; //!< the identifier of the queue providing the tile
+        PixelViewport pvp; //!< the tile area as queued by the server
+        float time; //!< clear, draw and readback time in ms
+    };
 }
 }
 
@@ -50,6 +63,13 @@ template<> inline void byteswap( eq::fabric::Tile& tile )
     byteswap( tile.pvp );
     byteswap( tile.vp );
 }
+
+template<> inline void byteswap( eq::fabric::TileTime& value )
+{
+    byteswap( value.queue );
+    byteswap( value.pvp );
+    byteswap( value.time );
+}
 }
 
 #endif // EQFABRIC_TILE_H
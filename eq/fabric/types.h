@@ -50,6 +50,7 @@ class Wall;
 class Zoom;
 struct DrawableConfig;
 struct GPUInfo;
+struct TileTime;
 
 using lunchbox::uint128_t;
 using lunchbox::UUID;
@@ -79,6 +80,9 @@ typedef lunchbox::RefPtr< const Client > ConstClientPtr;
 typedef lunchbox::RefPtr< SwapBarrier > SwapBarrierPtr;
 typedef lunchbox::RefPtr< const SwapBarrier > SwapBarrierConstPtr;
 
+/** @internal A vector of tile render times */
+typedef std::vector< TileTime > TileTimes;
+
 struct CanvasPath;
 struct ChannelPath;
 struct LayoutPath;
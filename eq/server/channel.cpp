@@ -37,6 +37,7 @@
 
 #include <eq/fabric/commands.h>
 #include <eq/fabric/paths.h>
+#include <eq/fabric/tile.h>
 
 #include <co/objectICommand.h>
 
@@ -303,6 +304,7 @@ void Channel::configInit( const uint128_t& initID, const uint32_t frameNumber )
     LBLOG( LOG_INIT ) << "Init channel" << std::endl;
     getWindow()->send( fabric::CMD_WINDOW_CREATE_CHANNEL ) << getID();
     send( fabric::CMD_CHANNEL_CONFIG_INIT ) << initID;
+    _contexts.clear();
 }
 
 bool Channel::syncConfigInit()
@@ -372,8 +374,9 @@ bool Channel::update( const uint128_t& frameID, const uint32_t frameNumber )
 
     RenderContext context;
     _setupRenderContext( frameID, context );
-    send( fabric::CMD_CHANNEL_FRAME_START )
-            << context << getVersion() << frameNumber;
+    _contexts.rewind();
+    send( fabric::CMD_CHANNEL_FRAME_START, context )
+            << getVersion() << frameNumber;
     LBLOG( LOG_TASKS ) << "TASK channel " << getName() << " start frame  "
                        << frameNumber << std::endl;
 
@@ -397,7 +400,7 @@ bool Channel::update( const uint128_t& frameID, const uint32_t frameNumber )
         updated |= visitor.isUpdated();
     }
 
-    send( fabric::CMD_CHANNEL_FRAME_FINISH ) << context << frameNumber;
+    send( fabric::CMD_CHANNEL_FRAME_FINISH, context ) << frameNumber;
     LBLOG( LOG_TASKS ) << "TASK channel " << getName() << " finish frame  "
                            << frameNumber << std::endl;
     _lastDrawCompound = 0;
@@ -410,6 +413,14 @@ co::ObjectOCommand Channel::send( const uint32_t cmd )
     return getNode()->send( cmd, getID( ));
 }
 
+co::ObjectOCommand Channel::send( const uint32_t cmd,
+                                  const RenderContext& context )
+{
+    co::ObjectOCommand command( send( cmd ));
+    _contexts.write( command, context );
+    return command;
+}
+
 //---------------------------------------------------------------------------
 // Listener interface
 //---------------------------------------------------------------------------
@@ -432,14 +443,27 @@ void Channel::removeListener(  ChannelListener* listener )
 
 void Channel::_fireLoadData( const uint32_t frameNumber,
                              const Statistics& statistics,
-                             const Viewport& region )
+                             const Viewport& region, const Vectorub& costGrid )
+{
+    LB_TS_SCOPED( _serverThread );
+
+    for( ChannelListeners::const_iterator i = _listeners.begin();
+         i != _listeners.end(); ++i )
+    {
+        (*i)->notifyLoadData( this, frameNumber, statistics, region,
+                              costGrid );
+    }
+}
+
+void Channel::_fireTileData( const uint32_t frameNumber,
+                             const TileTimes& tileTimes )
 {
     LB_TS_SCOPED( _serverThread );
 
     for( ChannelListeners::const_iterator i = _listeners.begin();
          i != _listeners.end(); ++i )
     {
-        (*i)->notifyLoadData( this, frameNumber, statistics, region );
+        (*i)->notifyTileData( this, frameNumber, tileTimes );
     }
 }
 
@@ -474,8 +498,12 @@ bool Channel::_cmdFrameFinishReply( co::ICommand& cmd )
     const Viewport region = command.get< Viewport >();
     const uint32_t frameNumber = command.get< uint32_t >();
     const Statistics statistics = command.get< Statistics >();
+    const Vectorub costGrid = command.get< Vectorub >();
+    const TileTimes tileTimes = command.get< TileTimes >();
 
-    _fireLoadData( frameNumber, statistics, region );
+    _fireLoadData( frameNumber, statistics, region, costGrid );
+    if( !tileTimes.empty( ))
+        _fireTileData( frameNumber, tileTimes );
     return true;
 }
 
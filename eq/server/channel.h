@@ -26,6 +26,7 @@
 #include <eq/client/types.h>
 #include <eq/fabric/channel.h>       // base class
 #include <eq/fabric/pixelViewport.h> // member
+#include <eq/fabric/renderContextCache.h> // member
 #include <eq/fabric/viewport.h>      // member
 #include <lunchbox/monitor.h> // member
 
@@ -167,6 +168,10 @@ namespace server
         bool update( const uint128_t& frameID, const uint32_t frameNumber );
 
         co::ObjectOCommand send( const uint32_t cmd );
+
+        /** Send a task command starting with the delta-encoded context. */
+        co::ObjectOCommand send( const uint32_t cmd,
+                                 const RenderContext& context );
         //@}
 
         /** @name Channel listener interface. */
@@ -205,6 +210,9 @@ namespace server
         /** The last draw compound for this entity */
         const Compound* _lastDrawCompound;
 
+        /** The render contexts of the last frame's tasks. */
+        fabric::RenderContextCache _contexts;
+
         typedef std::vector< ChannelListener* > ChannelListeners;
         ChannelListeners _listeners;
 
@@ -221,7 +229,9 @@ namespace server
 
         void _fireLoadData( const uint32_t frameNumber,
                             const Statistics& statistics,
-                            const Viewport& region );
+                            const Viewport& region, const Vectorub& costGrid );
+        void _fireTileData( const uint32_t frameNumber,
+                            const TileTimes& tileTimes );
 
         /* command handler functions. */
         bool _cmdConfigInitReply( co::ICommand& command );
@@ -39,11 +39,25 @@ namespace server
          * @param frameNumber the frame number.
          * @param statistics the frame's statistic.
          * @param region the draw area wrt the channels viewport
+         * @param costGrid the coverage of the draw area on a square grid over
+         *                 the channel, or empty if the region is rectangular.
          */
         virtual void notifyLoadData( Channel* channel,
                                      const uint32_t frameNumber,
                                      const Statistics& statistics,
-                                     const Viewport& region ) = 0;
+                                     const Viewport& region,
+                                     const Vectorub& costGrid ) = 0;
+
+        /**
+         * Notify that the channel has rendered tiles from a tile queue.
+         *
+         * @param channel the channel
+         * @param frameNumber the frame number.
+         * @param tileTimes the rendering time of each tile.
+         */
+        virtual void notifyTileData( Channel* channel,
+                                     const uint32_t frameNumber,
+                                     const TileTimes& tileTimes ) {}
     };
 }
 }
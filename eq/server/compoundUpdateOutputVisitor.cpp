@@ -34,12 +34,30 @@
 #include <eq/fabric/iAttribute.h>
 #include <eq/fabric/tile.h>
 
+#include <algorithm>
+
 #define TILE_STRATEGY ZigzagStrategy
 
 namespace eq
 {
 namespace server
 {
+namespace
+{
+/** Orders tiles by descending cost, ties keep the strategy order. */
+class TileCostGreater
+{
+public:
+    explicit TileCostGreater( const TileQueue* queue ) : _queue( queue ) {}
+
+    bool operator()( const Vector2i& tile1, const Vector2i& tile2 ) const
+        { return _queue->getTileCost( tile1 ) > _queue->getTileCost( tile2 ); }
+
+private:
+    const TileQueue* _queue;
+};
+}
+
 CompoundUpdateOutputVisitor::CompoundUpdateOutputVisitor(
     const uint32_t frameNumber )
         : _frameNumber( frameNumber )
@@ -200,6 +218,14 @@ void CompoundUpdateOutputVisitor::_generateTiles( TileQueue* queue,
 
     tiles::TILE_STRATEGY strategy;
     strategy( tiles, dim );
+
+    // Most expensive tiles first, so that the cheap ones fill the gaps between
+    // the channels at the end of the frame
+    queue->setTileGrid( dim );
+    if( queue->hasTileCosts( ))
+        std::stable_sort( tiles.begin(), tiles.end(),
+                          TileCostGreater( queue ));
+
     _addTilesToQueue( queue, compound, tiles );
 }
 
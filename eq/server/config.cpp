@@ -21,6 +21,7 @@
 
 #include "canvas.h"
 #include "changeLatencyVisitor.h"
+#include "channel.h"
 #include "compound.h"
 #include "compoundVisitor.h"
 #include "configUpdateDataVisitor.h"
@@ -37,6 +38,7 @@
 
 #include <eq/client/error.h>
 #include <eq/client/event.h>
+#include <eq/client/statistic.h>
 
 #include <eq/fabric/commands.h>
 #include <eq/fabric/iAttribute.h>
@@ -46,6 +48,9 @@
 
 #include <lunchbox/sleep.h>
 
+#include <cstdio>
+#include <set>
+
 #include "channelStopFrameVisitor.h"
 #include "configDeregistrator.h"
 #include "configRegistrator.h"
@@ -53,6 +58,10 @@
 #include "configUpdateSyncVisitor.h"
 #include "nodeFailedVisitor.h"
 
+#ifdef _MSC_VER
+#  define snprintf _snprintf
+#endif
+
 namespace eq
 {
 namespace server
@@ -61,6 +70,66 @@ typedef co::CommandFunc<Config> ConfigFunc;
 using fabric::ON;
 using fabric::OFF;
 
+namespace
+{
+/** Collects the nodes, views and segments used by a compound tree. */
+class ResourceCollector : public CompoundVisitor
+{
+public:
+    virtual VisitorResult visit( const Compound* compound )
+    {
+        const Channel* channel = compound->getChannel();
+        if( channel )
+        {
+            resources.insert( channel->getNode( ));
+            if( channel->getView( ))
+                resources.insert( channel->getView( ));
+            if( channel->getSegment( ))
+                resources.insert( channel->getSegment( ));
+        }
+        return TRAVERSE_CONTINUE;
+    }
+
+    std::set< const void* > resources;
+};
+
+/**
+ * @return true if no two root compounds use a node, view or segment together.
+ *
+ * The update of a compound tree modifies the frames, tile queues, swap barriers
+ * and draw tasks of its channels, windows, pipes and nodes. A pixel viewport
+ * change also updates the frusta of all compounds of the channel's view, and
+ * the destination channels of a view or segment may be used by several root
+ * compounds, e.g., for a multi-segment canvas. Compound trees with disjoint
+ * nodes, views and segments can therefore be updated concurrently.
+ *
+ * The object registration of new swap barriers and the commit of the output
+ * frames of each tree remain concurrent, which is safe since the local node
+ * serializes object registration, and each tree commits its own frames.
+ */
+bool _areIndependent( const Compounds& compounds )
+{
+    if( compounds.size() < 2 )
+        return false;
+
+    std::set< const void* > used;
+    for( CompoundsCIter i = compounds.begin(); i != compounds.end(); ++i )
+    {
+        ResourceCollector collector;
+        (*i)->accept( collector );
+
+        for( std::set< const void* >::const_iterator j =
+                 collector.resources.begin(); j != collector.resources.end();
+             ++j )
+        {
+            if( !used.insert( *j ).second )
+                return false;
+        }
+    }
+    return true;
+}
+}
+
 Config::Config( ServerPtr parent )
         : Super( parent )
         , _currentFrame( 0 )
@@ -872,22 +941,32 @@ void Config::_startFrame( const uint128_t& frameID )
     LBLOG( lunchbox::LOG_ANY ) << "----- Start Frame ----- " << _currentFrame
                                << std::endl;
 
-    for( Compounds::const_iterator i = _compounds.begin();
-         i != _compounds.end(); ++i )
-    {
-        Compound* compound = *i;
-        compound->update( _currentFrame );
-    }
+    const int64_t updateStart = getServer()->getTime();
+    const int32_t nCompounds = int32_t( _compounds.size( ));
+    const bool independent = _areIndependent( _compounds );
+
+#pragma omp parallel for schedule( dynamic ) if( independent )
+    for( int32_t i = 0; i < nCompounds; ++i )
+        _compounds[ i ]->update( _currentFrame );
 
     ConfigUpdateDataVisitor configDataVisitor;
     accept( configDataVisitor );
 
+    // The task generation of a node only touches its own entities and send
+    // buffer, see Node::update()
     const Nodes& nodes = getNodes();
+    const int32_t nNodes = int32_t( nodes.size( ));
+
+#pragma omp parallel for schedule( dynamic )
+    for( int32_t i = 0; i < nNodes; ++i )
+        nodes[ i ]->update( frameID, _currentFrame );
+
+    _sendUpdateStatistic( updateStart );
+
     co::NodePtr appNode = findApplicationNetNode();
     for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
     {
-        Node* node = *i;
-        node->update( frameID, _currentFrame );
+        const Node* node = *i;
         if( node->isRunning() && node->isApplicationNode( ))
             appNode = 0; // release sent (see below)
     }
@@ -900,6 +979,60 @@ void Config::_startFrame( const uint128_t& frameID )
     notifyNodeFrameFinished( _currentFrame );
 }
 
+void Config::_sendUpdateStatistic( const int64_t startTime )
+{
+    co::NodePtr appNode = findApplicationNetNode();
+    if( !appNode )
+        return;
+
+    Event event;
+    event.type = Event::STATISTIC;
+    event.serial = getSerial();
+    event.originator = getID();
+    event.statistic.type = Statistic::CONFIG_UPDATE_FRAME;
+    event.statistic.frameNumber = _currentFrame;
+
+    const std::string& name = getName();
+    if( name.empty( ))
+        snprintf( event.statistic.resourceName, 32, "config" );
+    else
+        snprintf( event.statistic.resourceName, 32, "%s", name.c_str( ));
+    event.statistic.resourceName[31] = 0;
+
+    event.statistic.startTime = startTime;
+    event.statistic.endTime = getServer()->getTime();
+    if( event.statistic.endTime <= event.statistic.startTime )
+        event.statistic.endTime = event.statistic.startTime + 1;
+
+    send( appNode, fabric::CMD_CONFIG_EVENT ) << uint32_t( Event::STATISTIC )
+                                               << event;
+
+    // task generation time and size of each node
+    const Nodes& nodes = getNodes();
+    for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
+    {
+        const Node* node = *i;
+        if( !node->isRunning( ))
+            continue;
+
+        event.serial = node->getSerial();
+        event.originator = node->getID();
+        event.statistic.type = Statistic::NODE_FRAME_TASKS;
+        snprintf( event.statistic.resourceName, 32, "%s",
+                  node->getName().c_str( ));
+        event.statistic.resourceName[31] = 0;
+
+        event.statistic.startTime = node->getTaskStartTime();
+        event.statistic.endTime = node->getTaskEndTime();
+        if( event.statistic.endTime <= event.statistic.startTime )
+            event.statistic.endTime = event.statistic.startTime + 1;
+        event.statistic.size = uint32_t( node->getTaskSize( ));
+
+        send( appNode, fabric::CMD_CONFIG_EVENT )
+            << uint32_t( Event::STATISTIC ) << event;
+    }
+}
+
 void Config::_verifyFrameFinished( const uint32_t frameNumber )
 {
     const Nodes& nodes = getNodes();
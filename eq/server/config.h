@@ -254,6 +254,7 @@ namespace server
         bool _init( const uint128_t& initID );
 
         void _startFrame( const uint128_t& frameID );
+        void _sendUpdateStatistic( const int64_t startTime );
         void _flushAllFrames();
         //@}
 
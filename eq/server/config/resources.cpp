@@ -481,6 +481,10 @@ Compound* Resources::_addMonoCompound( Compound* root, const Channels& channels,
     }
     else if( name == EQ_SERVER_CONFIG_LAYOUT_DB_DS )
         compound = _addDSCompound( root, activeDBChannels );
+    else if( name == EQ_SERVER_CONFIG_LAYOUT_DB_BS )
+        compound = _addRadixKCompound( root, activeDBChannels, 2 );
+    else if( name == EQ_SERVER_CONFIG_LAYOUT_DB_RADIXK )
+        compound = _addRadixKCompound( root, activeDBChannels, 4 );
     else if( name == EQ_SERVER_CONFIG_LAYOUT_DB_2D )
     {
         LBASSERT( !multiProcess );
@@ -721,6 +725,169 @@ Compound* Resources::_addDSCompound( Compound* root, const Channels& channels )
     return compound;
 }
 
+namespace
+{
+/**
+ * Factor n into the group sizes of the radix-k compositing rounds.
+ *
+ * Prime factors are combined greedily as long as the group size does not
+ * exceed maxRadix. Prime factors larger than maxRadix form a direct-send round.
+ */
+std::vector< uint32_t > _computeRadices( uint32_t n, const uint32_t maxRadix )
+{
+    std::vector< uint32_t > factors;
+    for( uint32_t factor = 2; n > 1; )
+    {
+        if( n % factor == 0 )
+        {
+            factors.push_back( factor );
+            n /= factor;
+        }
+        else
+            ++factor;
+    }
+
+    std::vector< uint32_t > radices;
+    for( std::vector< uint32_t >::const_iterator i = factors.begin();
+         i != factors.end(); ++i )
+    {
+        if( !radices.empty() && radices.back() * *i <= maxRadix )
+            radices.back() *= *i;
+        else
+            radices.push_back( *i );
+    }
+    return radices;
+}
+
+/** @return the horizontal stripe [start, end[ of n stripes. */
+Viewport _getStripe( const uint32_t start, const uint32_t end,
+                     const uint32_t n )
+{
+    const float y = float( start ) / float( n );
+    if( end == n ) // last - correct rounding 'error'
+        return Viewport( 0.f, y, 1.f, 1.f - y );
+    return Viewport( 0.f, y, 1.f, float( end - start ) / float( n ));
+}
+
+std::string _getSwapFrameName( const size_t round, const size_t from,
+                               const size_t to )
+{
+    std::ostringstream frameName;
+    frameName << "swap" << round << ".tile" << to << ".channel" << from;
+    return frameName.str();
+}
+}
+
+Compound* Resources::_addRadixKCompound( Compound* root,
+                                         const Channels& channels,
+                                         const uint32_t maxRadix )
+{
+    const Channel* channel = root->getChannel();
+    const Layout* layout = channel->getLayout();
+    const std::string& name = layout->getName();
+
+    Compound* compound = new Compound( root );
+    compound->setName( name );
+
+    // Each source composites 1/n of the screen after log_k(n) exchange rounds.
+    // In round r, groups of k sources which hold the same region split it into
+    // k stripes, and each source assembles one stripe from all group members.
+    const Compounds& children = _addSources( compound, channels );
+    const uint32_t nChildren = uint32_t( children.size( ));
+    if( nChildren == 0 )
+        return compound;
+
+    const std::vector< uint32_t >& radices = _computeRadices( nChildren,
+                                                              maxRadix );
+    const uint32_t nRounds = uint32_t( radices.size( ));
+    const uint32_t step = 100000 / nChildren;
+
+    for( uint32_t i = 0; i < nChildren; ++i )
+    {
+        Compound* child = children[ i ];
+
+        // leaf draw compound, followed by one assemble compound per round
+        Compound* drawChild = new Compound( child );
+        if( i + 1 == nChildren ) // last - correct rounding 'error'
+            drawChild->setRange( Range( float( i * step ) / 100000.f, 1.f ));
+        else
+            drawChild->setRange( Range( float( i * step ) / 100000.f,
+                                        float(( i + 1 ) * step ) / 100000.f ));
+
+        Compound* current = drawChild;
+        uint32_t start = 0;           // region held by this source, in stripes
+        uint32_t size = nChildren;
+        uint32_t stride = 1;          // distance of group members
+
+        for( uint32_t round = 0; round < nRounds; ++round )
+        {
+            const uint32_t radix = radices[ round ];
+            const uint32_t digit = ( i / stride ) % radix;
+            const uint32_t first = i - digit * stride; // first group member
+            const uint32_t partSize = size / radix;
+
+            for( uint32_t j = 0; j < radix; ++j )
+            {
+                if( j == digit ) // own stripe, is in place
+                    continue;
+
+                const uint32_t peer = first + j * stride;
+                const uint32_t partStart = start + j * partSize;
+
+                Frame* outputFrame = new Frame;
+                outputFrame->setName( _getSwapFrameName( round, i, peer ));
+                outputFrame->setViewport( _getStripe( partStart,
+                                                      partStart + partSize,
+                                                      nChildren ));
+                outputFrame->setBuffers( eq::Frame::BUFFER_COLOR |
+                                         eq::Frame::BUFFER_DEPTH );
+                current->addOutputFrame( outputFrame );
+            }
+
+            // stripes from the other group members are assembled by the next
+            // round's compound, or by the source compound after the last round
+            Compound* assembler = child;
+            if( round + 1 < nRounds )
+            {
+                const uint32_t groupSize = stride * radix;
+                const uint32_t groupStart = i - ( i % groupSize );
+
+                assembler = new Compound( child );
+                assembler->setTasks( fabric::TASK_ASSEMBLE |
+                                     fabric::TASK_READBACK );
+                assembler->setRange( Range(
+                    float( groupStart ) / float( nChildren ),
+                    float( groupStart + groupSize ) / float( nChildren )));
+            }
+
+            for( uint32_t j = 0; j < radix; ++j )
+            {
+                if( j == digit )
+                    continue;
+
+                Frame* inputFrame = new Frame;
+                inputFrame->setName( _getSwapFrameName( round,
+                                                        first + j * stride, i ));
+                assembler->addInputFrame( inputFrame );
+            }
+
+            start += digit * partSize;
+            size = partSize;
+            stride *= radix;
+            current = assembler;
+        }
+
+        // assembled color stripe output, if not already in place
+        if( child->getChannel() != compound->getChannel( ))
+        {
+            Frame* output = child->getOutputFrames().front();
+            output->setViewport( _getStripe( start, start + 1, nChildren ));
+        }
+    }
+
+    return compound;
+}
+
 static Channels _filterLocalChannels( const Channels& input,
                                       const Compound& filter )
 {
@@ -27,6 +27,8 @@
 #define EQ_SERVER_CONFIG_LAYOUT_DB_STATIC   "StaticDB"
 #define EQ_SERVER_CONFIG_LAYOUT_DB_DYNAMIC  "DynamicDB"
 #define EQ_SERVER_CONFIG_LAYOUT_DB_DS       "DBDirectSend"
+#define EQ_SERVER_CONFIG_LAYOUT_DB_BS       "DBBinarySwap"
+#define EQ_SERVER_CONFIG_LAYOUT_DB_RADIXK   "DBRadixK"
 #define EQ_SERVER_CONFIG_LAYOUT_DB_2D       "DB_2D"
 #define EQ_SERVER_CONFIG_LAYOUT_SUBPIXEL    "Subpixel"
 
@@ -58,6 +60,9 @@ private:
     static Compound* _addDBCompound( Compound* root, const Channels& channels,
                                      fabric::ConfigParams params );
     static Compound* _addDSCompound( Compound* root, const Channels& channels );
+    static Compound* _addRadixKCompound( Compound* root,
+                                         const Channels& channels,
+                                         const uint32_t maxRadix );
     static Compound* _addDB2DCompound( Compound* root, const Channels& channels,
                                        fabric::ConfigParams params );
     static Compound* _addSubpixelCompound( Compound* root, const Channels& );
@@ -21,6 +21,7 @@
 #include "../compoundVisitor.h"
 #include "../config.h"
 #include "../log.h"
+#include "../tileQueue.h"
 
 #include <eq/client/statistic.h>
 #include <eq/fabric/zoom.h>
@@ -31,9 +32,52 @@ namespace eq
 namespace server
 {
 
+namespace
+{
+/** Collects the topmost compounds providing output frames. */
+class TargetFinder : public CompoundVisitor
+{
+public:
+    TargetFinder( Compounds& targets ) : _targets( targets ) {}
+
+    virtual VisitorResult visit( Compound* compound )
+    {
+        if( !compound->getParent() || compound->getOutputFrames().empty() ||
+            !compound->getChannel( ))
+        {
+            return TRAVERSE_CONTINUE;
+        }
+
+        _targets.push_back( compound );
+        return TRAVERSE_PRUNE;
+    }
+
+private:
+    Compounds& _targets;
+};
+
+/** Collects all output tile queues. */
+class TileQueueFinder : public CompoundVisitor
+{
+public:
+    TileQueueFinder( TileQueues& queues ) : _queues( queues ) {}
+
+    virtual VisitorResult visit( Compound* compound )
+    {
+        const TileQueues& queues = compound->getOutputTileQueues();
+        _queues.insert( _queues.end(), queues.begin(), queues.end( ));
+        return TRAVERSE_CONTINUE;
+    }
+
+private:
+    TileQueues& _queues;
+};
+
+/** Number of tiles each channel should render per frame. */
+static const float _tilesPerChannel = 8.f;
+}
+
 DFREqualizer::DFREqualizer()
-        : _current ( getFrameRate( ))
-        , _lastTime( 0 )
 {
     LBINFO << "New DFREqualizer @" << (void*)this << std::endl;
 }
@@ -46,46 +90,117 @@ DFREqualizer::~DFREqualizer()
 
 void DFREqualizer::attach( Compound* compound )
 {
-    Compound* oldCompound = getCompound();
-    if( oldCompound )
+    _clearTargets();
+    Equalizer::attach( compound );
+}
+
+void DFREqualizer::_updateTargets()
+{
+    // Rebuilt each frame to follow compounds added anywhere below the root
+    _targets.clear();
+    Compound* compound = getCompound();
+    if( compound->getParent( ))
+        _targets.push_back( compound );
+    else
+    {
+        TargetFinder finder( _targets );
+        compound->accept( finder );
+    }
+
+    // Subscribe to channel load notification of new targets
+    Timings timings;
+    for( CompoundsCIter i = _targets.begin(); i != _targets.end(); ++i )
     {
-        Channel*  channel   = oldCompound->getChannel();
+        Channel* channel = (*i)->getChannel();
         LBASSERT( channel );
+        Timings::iterator j = _timings.find( channel );
+        if( j != _timings.end( ))
+        {
+            timings.insert( *j );
+            _timings.erase( j );
+            continue;
+        }
 
-        // Unsubscribe to channel load notification
-        channel->removeListener( this );
+        channel->addListener( this );
+        timings[ channel ].current = getFrameRate();
     }
 
-    Equalizer::attach( compound );
+    // Unsubscribe from channels which are no longer targets
+    for( Timings::const_iterator i = _timings.begin(); i != _timings.end();
+         ++i )
+    {
+        i->first->removeListener( this );
+    }
+    _timings.swap( timings );
+}
 
-    if( compound )
+void DFREqualizer::_clearTargets()
+{
+    // Unsubscribe to channel load notification
+    for( Timings::const_iterator i = _timings.begin(); i != _timings.end();
+         ++i )
     {
-        Channel* channel = compound->getChannel();
-        LBASSERT( channel );
+        i->first->removeListener( this );
+    }
+    _timings.clear();
+    _targets.clear();
+}
 
-        // Subscribe to channel load notification
-        if( compound->getParent() && channel )
-            channel->addListener( this );
+float DFREqualizer::_getCurrent() const
+{
+    float current = getFrameRate();
+    for( Timings::const_iterator i = _timings.begin(); i != _timings.end();
+         ++i )
+    {
+        current = LB_MIN( current, i->second.current );
     }
+    return current;
 }
 
 void DFREqualizer::notifyUpdatePre( Compound* compound,
                                     const uint32_t frameNumber )
 {
     LBASSERT( compound == getCompound( ));
+    _updateTargets();
 
     if( isFrozen() || !compound->isActive() || !isActive( ))
     {
-        compound->setZoom( Zoom::NONE );
+        for( CompoundsCIter i = _targets.begin(); i != _targets.end(); ++i )
+            (*i)->setZoom( Zoom::NONE );
         return;
     }
 
     LBASSERT( getDamping() >= 0.f );
     LBASSERT( getDamping() <= 1.f );
 
-    const float factor = ( sqrtf( _current / getFrameRate( )) - 1.f ) *
+    const float factor = ( sqrtf( _getCurrent() / getFrameRate( )) - 1.f ) *
                          getDamping() + 1.f;
 
+    for( CompoundsCIter i = _targets.begin(); i != _targets.end(); ++i )
+        _updateZoom( *i, factor );
+    _updateTileSize( compound );
+}
+
+void DFREqualizer::_updateTileSize( Compound* compound )
+{
+    TileQueues queues;
+    TileQueueFinder finder( queues );
+    compound->accept( finder );
+
+    // Size tiles for a good load balance within the frame budget, with enough
+    // work per tile to amortize the per-tile overhead
+    const float tileTime = 1000.f / getFrameRate() / _tilesPerChannel;
+    for( TileQueuesCIter i = queues.begin(); i != queues.end(); ++i )
+    {
+        TileQueue* queue = *i;
+        if( queue->fitTileSize( tileTime ))
+            LBLOG( LOG_LB1 ) << "Tile size of " << queue->getName() << " now "
+                             << queue->getTileSize() << std::endl;
+    }
+}
+
+void DFREqualizer::_updateZoom( Compound* compound, const float factor )
+{
     Zoom newZoom( compound->getZoom( ));
     newZoom *= factor;
 
@@ -94,6 +209,8 @@ void DFREqualizer::notifyUpdatePre( Compound* compound,
     // clip zoom factor to min( 128px ), max( channel pvp )
     const Compound*          parent = compound->getParent();
     const eq::PixelViewport& pvp    = parent->getInheritPixelViewport();
+    if( !pvp.hasArea( ))
+        return;
 
     const Channel*           channel    = compound->getChannel();
     const eq::PixelViewport& channelPVP = channel->getPixelViewport();
@@ -114,13 +231,19 @@ void DFREqualizer::notifyUpdatePre( Compound* compound,
 
 void DFREqualizer::notifyLoadData( Channel* channel, const uint32_t frameNumber,
                                    const Statistics& statistics,
-                                   const Viewport& region )
+                                   const Viewport& region,
+                                   const Vectorub& costGrid )
 {
+    Timings::iterator i = _timings.find( channel );
+    if( i == _timings.end( ))
+        return;
+    Timing& timing = i->second;
+
     // gather and notify load data
     int64_t endTime = 0;
-    for( size_t i = 0; i < statistics.size(); ++i )
+    for( size_t j = 0; j < statistics.size(); ++j )
     {
-        const eq::Statistic& data = statistics[i];
+        const eq::Statistic& data = statistics[j];
         switch( data.type )
         {
             case eq::Statistic::CHANNEL_CLEAR:
@@ -138,13 +261,13 @@ void DFREqualizer::notifyLoadData( Channel* channel, const uint32_t frameNumber,
     if( endTime == 0 )
         return;
 
-    const int64_t time = endTime - _lastTime;
-    _lastTime = endTime;
+    const int64_t time = endTime - timing.lastTime;
+    timing.lastTime = endTime;
 
-    if( _lastTime <= 0 || time <= 0 )
+    if( timing.lastTime <= 0 || time <= 0 )
         return;
 
-    _current = 1000.0f / static_cast< float >( time );
+    timing.current = 1000.0f / static_cast< float >( time );
     LBLOG( LOG_LB1 ) << "Frame " << frameNumber << " channel "
                      << channel->getName() << " time " << time << std::endl;
 }
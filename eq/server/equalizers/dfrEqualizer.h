@@ -31,7 +31,19 @@ namespace server
     class DFREqualizer;
     std::ostream& operator << ( std::ostream& os, const DFREqualizer* );
 
-    /** Tries to maintain a constant frame rate by adapting the compound zoom.*/
+    /**
+     * Tries to maintain a constant frame rate by adapting the compound zoom
+     * and the tile size.
+     *
+     * Attached to a compound with a parent, the equalizer zooms this compound.
+     * Attached to a root compound, for example the compound of all segments of
+     * a canvas, it zooms all topmost compounds providing output frames below
+     * it by the same factor, driven by the slowest of their channels.
+     *
+     * The tiles of all tile queues below the compound are sized so that each
+     * channel renders about eight tiles within the frame time, based on the
+     * measured tile costs.
+     */
     class DFREqualizer : public Equalizer, protected ChannelListener
     {
     public:
@@ -50,17 +62,34 @@ namespace server
         virtual void notifyLoadData( Channel* channel,
                                      const uint32_t frameNumber,
                                      const Statistics& statistics,
-                                     const Viewport& region );
+                                     const Viewport& region,
+                                     const Vectorub& costGrid );
 
         virtual uint32_t getType() const { return fabric::DFR_EQUALIZER; }
 
     protected:
-        virtual void notifyChildAdded( Compound* compound, Compound* child ){}
-        virtual void notifyChildRemove( Compound* compound, Compound* child ){}
+        virtual void notifyChildAdded( Compound* compound, Compound* child )
+            {}
+        virtual void notifyChildRemove( Compound* compound, Compound* child )
+            { _clearTargets(); }
 
     private:
-        float _current; //!< Framerate of the last finished frame
-        int64_t _lastTime; //!< Last frames' timestamp
+        struct Timing
+        {
+            Timing() : current( 0.f ), lastTime( 0 ) {}
+            float current; //!< Framerate of the last finished frame
+            int64_t lastTime; //!< Last frames' timestamp
+        };
+        typedef std::map< Channel*, Timing > Timings;
+
+        Compounds _targets; //!< The compounds zoomed by this equalizer
+        Timings _timings; //!< Per channel of the targets
+
+        void _updateTargets();
+        void _clearTargets();
+        float _getCurrent() const;
+        void _updateZoom( Compound* compound, const float factor );
+        void _updateTileSize( Compound* compound );
     };
 
 }
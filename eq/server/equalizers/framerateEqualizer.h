@@ -75,7 +75,8 @@ namespace server
             virtual void notifyLoadData( Channel* channel,
                                          const uint32_t frameNumber,
                                          const Statistics& statistics,
-                                         const Viewport& region );
+                                         const Viewport& region,
+                                         const Vectorub& costGrid );
 
             FramerateEqualizer* parent;
             uint32_t period;
@@ -25,6 +25,8 @@
 #include <eq/client/statistic.h>
 #include <lunchbox/debug.h>
 
+#include <cmath>
+
 namespace eq
 {
 namespace server
@@ -36,6 +38,12 @@ std::ostream& operator << ( std::ostream& os, const LoadEqualizer::Node* );
 // level, a relative split position is determined by balancing the left subtree
 // against the right subtree.
 
+namespace
+{
+// Maximum number of frames combined in the load data with history damping
+static const size_t _historySize = 8;
+}
+
 LoadEqualizer::LoadEqualizer()
         : _tree( 0 )
 {
@@ -54,6 +62,7 @@ LoadEqualizer::~LoadEqualizer()
     _tree = 0;
 
     _history.clear();
+    _pastHistory.clear();
 }
 
 void LoadEqualizer::notifyUpdatePre( Compound* compound,
@@ -148,7 +157,8 @@ void LoadEqualizer::_clearTree( Node* node )
 void LoadEqualizer::notifyLoadData( Channel* channel,
                                     const uint32_t frameNumber,
                                     const Statistics& statistics,
-                                    const Viewport& region )
+                                    const Viewport& region,
+                                    const Vectorub& costGrid )
 {
     LBLOG( LOG_LB2 ) << statistics.size()
                      << " samples from "<< channel->getName()
@@ -217,6 +227,7 @@ void LoadEqualizer::notifyLoadData( Channel* channel,
             if( startTime == std::numeric_limits< int64_t >::max( ))
                 return;
 
+            const Viewport vp = data.vp;
             data.vp.apply( region ); // Update ROI
             data.time = endTime - startTime;
             data.time = LB_MAX( data.time, 1 );
@@ -226,6 +237,9 @@ void LoadEqualizer::notifyLoadData( Channel* channel,
                              << data.assembleTime << ") for "
                              << channel->getName() << " " << data.vp << ", "
                              << data.range << " @ " << frameNumber << std::endl;
+
+            if( !costGrid.empty() && getMode() != MODE_DB )
+                _applyCostGrid( items, j - items.begin(), vp, costGrid );
             return;
 
             // Note: if the same channel is used twice as a child, the
@@ -251,6 +265,18 @@ void LoadEqualizer::_updateAssembleTime( Data& data, const Statistic& stat )
     }
 }
 
+bool LoadEqualizer::_isComplete( const LBFrameData& frameData )
+{
+    const LBDatas& items = frameData.second;
+    for( LBDatas::const_iterator i = items.begin(); i != items.end(); ++i )
+    {
+        const Data& data = *i;
+        if( data.time < 0 )
+            return false;
+    }
+    return true;
+}
+
 void LoadEqualizer::_checkHistory()
 {
     // 1. Find youngest complete load data set
@@ -259,25 +285,26 @@ void LoadEqualizer::_checkHistory()
          i != _history.rend() && useFrame == 0; ++i )
     {
         const LBFrameData& frameData = *i;
-        const LBDatas& items = frameData.second;
-        bool isComplete = true;
-
-        for( LBDatas::const_iterator j = items.begin();
-             j != items.end() && isComplete; ++j )
-        {
-            const Data& data = *j;
-
-            if( data.time < 0 )
-                isComplete = false;
-        }
-
-        if( isComplete )
+        if( _isComplete( frameData ))
             useFrame = frameData.first;
     }
 
-    // 2. delete old, unneeded data sets
+    // 2. delete old, unneeded data sets, keep complete ones for the history
     while( !_history.empty() && _history.front().first < useFrame )
+    {
+        const LBFrameData& frameData = _history.front();
+        if( getHistoryDamping() > 0.f && frameData.first > 0 &&
+            _isComplete( frameData ))
+        {
+            _pastHistory.push_back( frameData );
+            if( _pastHistory.size() >= _historySize )
+                _pastHistory.pop_front();
+        }
         _history.pop_front();
+    }
+
+    if( getHistoryDamping() <= 0.f )
+        _pastHistory.clear();
 
     if( _history.empty( )) // insert fake set
     {
@@ -296,6 +323,85 @@ void LoadEqualizer::_checkHistory()
     }
 }
 
+void LoadEqualizer::_getLoadData( LBDatas& items ) const
+{
+    LBASSERT( !_history.empty( ));
+    items = _history.front().second;
+
+    // Add past data with exponentially decaying weight, newest first
+    const float damping = getHistoryDamping();
+    float weight = 1.f;
+    float totalWeight = 1.f;
+    for( std::deque< LBFrameData >::const_reverse_iterator i =
+             _pastHistory.rbegin(); i != _pastHistory.rend(); ++i )
+    {
+        weight *= damping;
+        totalWeight += weight;
+
+        const LBDatas& pastItems = i->second;
+        for( LBDatas::const_iterator j = pastItems.begin();
+             j != pastItems.end(); ++j )
+        {
+            items.push_back( *j );
+            items.back().weight *= weight;
+        }
+    }
+
+    // normalize weights to keep the time of one frame
+    for( LBDatas::iterator i = items.begin(); i != items.end(); ++i )
+        i->weight /= totalWeight;
+
+    _removeEmpty( items );
+}
+
+void LoadEqualizer::_applyCostGrid( LBDatas& items, const size_t index,
+                                    const Viewport& vp, const Vectorub& grid )
+{
+    const size_t size = size_t( std::sqrt( float( grid.size( ))) + .5f );
+    if( size * size != grid.size( ))
+    {
+        LBWARN << "Ignoring non-square cost grid of " << grid.size()
+               << " cells" << std::endl;
+        return;
+    }
+
+    float total = 0.f;
+    for( size_t i = 0; i < grid.size(); ++i )
+        total += grid[ i ];
+    if( total <= 0.f )
+        return;
+
+    const Data data = items[ index ];
+    const float cellSize = 1.f / float( size );
+    bool first = true;
+
+    for( size_t y = 0; y < size; ++y )
+    {
+        for( size_t x = 0; x < size; ++x )
+        {
+            const uint8_t coverage = grid[ y * size + x ];
+            if( coverage == 0 )
+                continue;
+
+            Data cell = data;
+            cell.vp = vp;
+            cell.vp.apply( Viewport( float( x ) * cellSize,
+                                     float( y ) * cellSize,
+                                     cellSize, cellSize ));
+            cell.weight = data.weight * float( coverage ) / total;
+
+            if( first )
+            {
+                items[ index ] = cell;
+                first = false;
+                continue;
+            }
+            cell.assembleTime = 0; // accounted once with the first cell
+            items.push_back( cell );
+        }
+    }
+}
+
 float LoadEqualizer::_getTotalResources( ) const
 {
     const Compounds& children = getCompound()->getChildren();
@@ -360,7 +466,7 @@ void LoadEqualizer::_updateLeaf( Node* node )
         return; // OPT
     }
 
-    const float time = float( _getTotalTime( ));
+    const float time = _getTotalTime();
     const float assembleTime = float( _getAssembleTime( ));
     if( assembleTime == 0.f || node->resources == 0.f )
         return;
@@ -484,17 +590,16 @@ void LoadEqualizer::_updateNode( Node* node, const Viewport& vp,
     }
 }
 
-int64_t LoadEqualizer::_getTotalTime()
+float LoadEqualizer::_getTotalTime()
 {
-    const LBFrameData& frameData = _history.front();
-    LBDatas items = frameData.second;
-    _removeEmpty( items );
+    LBDatas items;
+    _getLoadData( items );
 
-    int64_t totalTime = 0;
+    float totalTime = 0.f;
     for( LBDatas::const_iterator i = items.begin(); i != items.end(); ++i )
     {
         const Data& data = *i;
-        totalTime += data.time;
+        totalTime += float( data.time ) * data.weight;
     }
     return totalTime;
 }
@@ -528,8 +633,8 @@ void LoadEqualizer::_computeSplit()
                      << std::endl << _tree;
 
     // sort load items for each of the split directions
-    LBDatas items( frameData.second );
-    _removeEmpty( items );
+    LBDatas items;
+    _getLoadData( items );
 
     LBDatas sortedData[3] = { items, items, items };
 
@@ -557,7 +662,7 @@ void LoadEqualizer::_computeSplit()
 #endif
     }
 
-    const float time = float( _getTotalTime( ));
+    const float time = _getTotalTime();
     LBLOG( LOG_LB2 ) << "Render time " << time << " for "
                      << _tree->resources << " resources" << std::endl;
     _computeSplit( _tree, time, sortedData, Viewport(), Range( ));
@@ -672,7 +777,8 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
                     {
                         const float percentage = ( width / data.vp.w ) *
                                                  ( yContrib / data.vp.h );
-                        currentTime += ( data.time * percentage );
+                        currentTime += ( data.time * data.weight *
+                                         percentage );
 
                         LBLOG( LOG_LB2 ) << data.vp << " contributes "
                                          << yContrib << " in " << vp.h << " ("
@@ -840,7 +946,8 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
                     {
                         const float percentage = ( height / data.vp.h ) *
                                                  ( xContrib / data.vp.w );
-                        currentTime += ( data.time * percentage );
+                        currentTime += ( data.time * data.weight *
+                                         percentage );
 
                         LBLOG( LOG_LB2 ) << data.vp << " contributes "
                                          << xContrib << " in " << vp.w << " ("
@@ -965,6 +1072,8 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
                      i != workingSet.end(); ++i )
                 {
                     const Data& data = *i;
+                    if( data.range.start > splitPos )
+                        currentPos = LB_MIN( currentPos, data.range.start );
                     currentPos = LB_MIN( currentPos, data.range.end );
                 }
 
@@ -990,7 +1099,8 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
                     LBASSERTINFO( data.range.end >= currentPos,
                                   data.range.end << " < " << currentPos);
 #endif
-                    currentTime += data.time * size / data.range.getSize();
+                    currentTime += data.time * data.weight * size /
+                                   data.range.getSize();
                 }
 
                 LBLOG( LOG_LB2 ) << splitPos << "..." << currentPos << ": t="
@@ -1120,6 +1230,9 @@ std::ostream& operator << ( std::ostream& os, const LoadEqualizer* lb )
     if( lb->getDamping() != 0.5f )
         os << "    damping " << lb->getDamping() << std::endl;
 
+    if( lb->getHistoryDamping() != 0.f )
+        os << "    history_damping " << lb->getHistoryDamping() << std::endl;
+
     if( lb->getBoundary2i() != Vector2i( 1, 1 ) )
         os << "    boundary [ " << lb->getBoundary2i().x() << " "
            << lb->getBoundary2i().y() << " ]" << std::endl;
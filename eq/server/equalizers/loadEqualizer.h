@@ -53,7 +53,8 @@ namespace server
         virtual void notifyLoadData( Channel* channel,
                                      const uint32_t frameNumber,
                                      const Statistics& statistics,
-                                     const Viewport& region );
+                                     const Viewport& region,
+                                     const Vectorub& costGrid );
 
         virtual uint32_t getType() const { return fabric::LOAD_EQUALIZER; }
 
@@ -91,7 +92,7 @@ namespace server
         struct Data
         {
             Data() : channel( 0 ), taskID( 0 ), destTaskID( 0 )
-                   , time( -1 ), assembleTime( 0 ) {}
+                   , time( -1 ), assembleTime( 0 ), weight( 1.f ) {}
             Channel*     channel;
             uint32_t     taskID;
             uint32_t     destTaskID;
@@ -99,6 +100,7 @@ namespace server
             eq::Range    range;
             int64_t      time;
             int64_t      assembleTime;
+            float        weight; //!< of time in the combined load data
         };
 
         typedef std::vector< Data > LBDatas;
@@ -106,6 +108,9 @@ namespace server
 
         std::deque< LBFrameData > _history;
 
+        /** Older complete load data for the history damping, oldest first. */
+        std::deque< LBFrameData > _pastHistory;
+
         //-------------------- Methods --------------------
         /** @return true if we have a valid LB tree */
         Node* _buildTree( const Compounds& children );
@@ -117,7 +122,7 @@ namespace server
         void _clearTree( Node* node );
 
         /** get the total time used by the rendering. */
-        int64_t _getTotalTime();
+        float _getTotalTime();
 
         /** get the assembly time used by the compound which use
             the destination Channel. */
@@ -126,6 +131,27 @@ namespace server
         /** Obsolete _history so that front-most item is youngest available. */
         void _checkHistory();
 
+        /** @return true if all load data of the frame has been received. */
+        static bool _isComplete( const LBFrameData& frameData );
+
+        /**
+         * Get the non-empty load data used to compute the split.
+         *
+         * Combines the front-most _history with the past history, weighted by
+         * the history damping.
+         */
+        void _getLoadData( LBDatas& items ) const;
+
+        /**
+         * Split the load data item at index into the cells of the cost grid.
+         *
+         * Each covered cell gets a part of the item's time proportional to
+         * its coverage, so that the split follows the actual screen-space
+         * distribution of the rendering within the channel.
+         */
+        static void _applyCostGrid( LBDatas& items, const size_t index,
+                                    const Viewport& vp, const Vectorub& grid );
+
         /** Update all node fields influencing the split */
         void _update( Node* node, const Viewport& vp, const Range& range );
         void _updateLeaf( Node* node );
@@ -133,7 +159,7 @@ namespace server
 
         /** Adjust the split of each node based on the front-most _history. */
         void _computeSplit();
-        void _removeEmpty( LBDatas& items );
+        static void _removeEmpty( LBDatas& items );
 
         void _computeSplit( Node* node, const float time, LBDatas* sortedData,
                             const eq::Viewport& vp, const eq::Range& range );
@@ -18,6 +18,7 @@
  */
 
 #include "types.h"
+#include "channel.h"
 #include "compound.h"
 #include "config.h"
 #include "tileQueue.h"
@@ -27,6 +28,8 @@
 
 #include "tileEqualizer.h"
 
+#include <eq/fabric/tile.h>
+
 namespace eq
 {
 namespace server
@@ -48,10 +51,13 @@ class InputQueueCreator : public CompoundVisitor
 {
 public:
     InputQueueCreator( const eq::fabric::Vector2i& size,
-                       const std::string& name )
+                       const std::string& name, ChannelListener* listener,
+                       Channels& channels )
         : CompoundVisitor()
         , _tileSize( size )
         , _name( name )
+        , _listener( listener )
+        , _channels( channels )
     {}
 
     /** Visit a leaf compound. */
@@ -72,12 +78,22 @@ public:
         input->setAutoObsolete( compound->getConfig()->getLatency( ));
 
         compound->addInputTileQueue( input );
+
+        // receive tile render times for the output queue
+        Channel* channel = compound->getChannel();
+        if( channel )
+        {
+            channel->addListener( _listener );
+            _channels.push_back( channel );
+        }
         return TRAVERSE_CONTINUE;
     }
 
 private:
     const eq::fabric::Vector2i& _tileSize;
     const std::string& _name;
+    ChannelListener* _listener;
+    Channels& _channels;
 };
 
 class InputQueueDestroyer : public CompoundVisitor
@@ -119,15 +135,28 @@ TileEqualizer::TileEqualizer()
 
 TileEqualizer::TileEqualizer( const TileEqualizer& from )
     : Equalizer( from )
+    , ChannelListener( from )
     , _created( from._created )
     , _name( from._name )
 {
 }
 
+TileEqualizer::~TileEqualizer()
+{
+    for( ChannelsCIter i = _channels.begin(); i != _channels.end(); ++i )
+        (*i)->removeListener( this );
+    _channels.clear();
+}
+
+std::string TileEqualizer::_getQueueName() const
+{
+    return std::string( "queue." ) + _name;
+}
+
 void TileEqualizer::_createQueues( Compound* compound )
 {
     _created = true;
-    const std::string name = std::string( "queue." ) + _name;
+    const std::string name = _getQueueName();
     if( !_findQueue( name, compound->getOutputTileQueues( )))
     {
         TileQueue* output = new TileQueue;
@@ -140,13 +169,17 @@ void TileEqualizer::_createQueues( Compound* compound )
         compound->addOutputTileQueue( output );
     }
 
-    InputQueueCreator creator( getTileSize(), name );
+    InputQueueCreator creator( getTileSize(), name, this, _channels );
     compound->accept( creator );
 }
 
 void TileEqualizer::_destroyQueues( Compound* compound )
 {
-    const std::string name = std::string( "queue." ) + _name;
+    for( ChannelsCIter i = _channels.begin(); i != _channels.end(); ++i )
+        (*i)->removeListener( this );
+    _channels.clear();
+
+    const std::string name = _getQueueName();
     TileQueue* q = _findQueue( name, compound->getOutputTileQueues() );
     if ( q )
     {
@@ -172,6 +205,28 @@ void TileEqualizer::notifyUpdatePre( Compound* compound,
         _destroyQueues( compound );
 }
 
+void TileEqualizer::notifyTileData( Channel* channel,
+                                    const uint32_t frameNumber,
+                                    const TileTimes& tileTimes )
+{
+    Compound* compound = getCompound();
+    if( !compound )
+        return;
+
+    TileQueue* queue = _findQueue( _getQueueName(),
+                                   compound->getOutputTileQueues( ));
+    if( !queue )
+        return;
+
+    for( TileTimes::const_iterator i = tileTimes.begin();
+         i != tileTimes.end(); ++i )
+    {
+        const TileTime& tileTime = *i;
+        if( queue->hasQueueMaster( tileTime.queue ))
+            queue->addTileTime( tileTime.pvp, tileTime.time );
+    }
+}
+
 std::ostream& operator << ( std::ostream& os, const TileEqualizer* lb )
 {
     if( lb )
@@ -20,6 +20,7 @@
 #define EQS_TILEEQUALIZER_H
 
 #include "equalizer.h"
+#include "../channelListener.h" // base class
 
 namespace eq
 {
@@ -29,17 +30,27 @@ namespace server
 class TileEqualizer;
 std::ostream& operator << ( std::ostream& os, const TileEqualizer* );
 
-class TileEqualizer : public Equalizer
+class TileEqualizer : public Equalizer, protected ChannelListener
 {
 public:
     EQSERVER_API TileEqualizer();
     TileEqualizer( const TileEqualizer& from );
-    ~TileEqualizer() {}
+    ~TileEqualizer();
 
     /** @sa CompoundListener::notifyUpdatePre */
     virtual void notifyUpdatePre( Compound* compound,
                                   const uint32_t frameNumber );
 
+    /** @sa ChannelListener::notifyLoadData */
+    virtual void notifyLoadData( Channel* channel, const uint32_t frameNumber,
+                                 const Statistics& statistics,
+                                 const Viewport& region,
+                                 const Vectorub& costGrid ) {}
+
+    /** @sa ChannelListener::notifyTileData */
+    virtual void notifyTileData( Channel* channel, const uint32_t frameNumber,
+                                 const TileTimes& tileTimes );
+
     virtual void toStream( std::ostream& os ) const { os << this; }
     void setName( const std::string& name ) { _name = name; }
 
@@ -56,9 +67,13 @@ private:
 
     void _destroyQueues( Compound* compound );
     void _createQueues( Compound* compound );
+    std::string _getQueueName() const;
 
     bool _created;
     std::string _name;
+
+    /** The channels reporting tile render times to this equalizer. */
+    Channels _channels;
 };
 
 } //server
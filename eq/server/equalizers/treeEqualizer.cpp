@@ -138,7 +138,8 @@ void TreeEqualizer::_clearTree( Node* node )
 void TreeEqualizer::notifyLoadData( Channel* channel,
                                     const uint32_t frameNumber,
                                     const Statistics& statistics,
-                                    const Viewport& region )
+                                    const Viewport& region,
+                                    const Vectorub& costGrid )
 {
     _notifyLoadData( _tree, channel, statistics );
 }
@@ -53,7 +53,8 @@ namespace server
         virtual void notifyLoadData( Channel* channel,
                                      const uint32_t frameNumber,
                                      const Statistics& statistics,
-                                     const Viewport& region );
+                                     const Viewport& region,
+                                     const Vectorub& costGrid );
 
         virtual uint32_t getType() const { return fabric::TREE_EQUALIZER; }
 
@@ -580,7 +580,8 @@ bool ViewEqualizer::Listener::Load::operator == ( const Load& rhs ) const
 void ViewEqualizer::Listener::notifyLoadData( Channel* channel,
                                               const uint32_t frameNumber,
                                               const Statistics& statistics,
-                                              const Viewport& region )
+                                              const Viewport& region,
+                                              const Vectorub& costGrid )
 {
     Load& load = _getLoad( frameNumber );
     if( load == Load::NONE )
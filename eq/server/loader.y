@@ -200,6 +200,7 @@
 %token EQTOKEN_VIEWEQUALIZER
 %token EQTOKEN_TILEEQUALIZER
 %token EQTOKEN_DAMPING
+%token EQTOKEN_HISTORY_DAMPING
 %token EQTOKEN_CONNECTION
 %token EQTOKEN_NAME
 %token EQTOKEN_TYPE
@@ -1237,6 +1238,8 @@ dfrEqualizerField:
 loadEqualizerFields: /* null */ | loadEqualizerFields loadEqualizerField
 loadEqualizerField:
     EQTOKEN_DAMPING FLOAT            { loadEqualizer->setDamping( $2 ); }
+    | EQTOKEN_HISTORY_DAMPING FLOAT
+                           { loadEqualizer->setHistoryDamping( $2 ); }
     | EQTOKEN_BOUNDARY '[' UNSIGNED UNSIGNED ']'
                  { loadEqualizer->setBoundary( eq::Vector2i( $3, $4 )); }
     | EQTOKEN_ASSEMBLE_ONLY_LIMIT FLOAT
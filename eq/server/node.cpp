@@ -67,6 +67,10 @@ Node::Node( Config* parent )
     , _flushedFrame( 0 )
     , _state( STATE_STOPPED )
     , _bufferedTasks( new co::BufferConnection )
+    , _sentBytes( 0 )
+    , _taskStartTime( 0 )
+    , _taskEndTime( 0 )
+    , _taskSize( 0 )
     , _lastDrawPipe( 0 )
 {
     const Global* global = Global::instance();
@@ -538,6 +542,8 @@ void Node::update( const uint128_t& frameID, const uint32_t frameNumber )
     LBASSERT( isActive( ));
 
     _frameIDs[ frameNumber ] = frameID;
+    _taskStartTime = getServer()->getTime();
+    const uint64_t sentBytes = _sentBytes;
 
     uint128_t configVersion = co::VERSION_INVALID;
     if( !isApplicationNode( )) // synced in Config::_cmdFrameStart
@@ -564,6 +570,9 @@ void Node::update( const uint128_t& frameID, const uint32_t frameNumber )
 
     _finish( frameNumber );
     flushSendBuffer();
+
+    _taskSize = _sentBytes - sentBytes;
+    _taskEndTime = getServer()->getTime();
 }
 
 uint32_t Node::_getFinishLatency() const
@@ -712,6 +721,7 @@ co::ObjectOCommand Node::send( const uint32_t cmd, const UUID& id )
 
 void Node::flushSendBuffer()
 {
+    _sentBytes += _bufferedTasks->getSize();
     _bufferedTasks->sendBuffer( _node->getConnection( ));
 }
 
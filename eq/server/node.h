@@ -132,6 +132,15 @@ namespace server
          */
         void update( const uint128_t& frameID, const uint32_t frameNumber );
 
+        /** @internal @return the start time of the last update(). */
+        int64_t getTaskStartTime() const { return _taskStartTime; }
+
+        /** @internal @return the end time of the last update(). */
+        int64_t getTaskEndTime() const { return _taskEndTime; }
+
+        /** @internal @return the size of the tasks of the last update(). */
+        uint64_t getTaskSize() const { return _taskSize; }
+
         /**
          * Flush the processing of frames, including frameNumber.
          *
@@ -275,6 +284,14 @@ namespace server
         /** Task commands for the current operation. */
         co::BufferConnectionPtr _bufferedTasks;
 
+        /** The total size of all flushed task commands in bytes. */
+        uint64_t _sentBytes;
+
+        /** The duration and size of the last task generation. */
+        int64_t _taskStartTime;
+        int64_t _taskEndTime;
+        uint64_t _taskSize;
+
         /** The last draw pipe for this entity */
         const Pipe* _lastDrawPipe;
 
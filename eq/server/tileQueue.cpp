@@ -23,16 +23,33 @@
 #include <co/dataOStream.h>
 #include <co/queueItem.h>
 
+#include <cmath>
+
 namespace eq
 {
 namespace server
 {
 
+namespace
+{
+/** Weight of a new render time in the running average of a tile. */
+static const float _costWeight = 0.5f;
+
+/** Tile sizes chosen by fitTileSize() are a multiple of this. */
+static const int32_t _tileGranularity = 16;
+static const int32_t _maxTileSize = 1024;
+
+/** Relative change of the tile edge below which fitTileSize() keeps it. */
+static const float _tileSizeHysteresis = 1.25f;
+}
+
 TileQueue::TileQueue()
         : co::Object()
         , _compound( 0 )
         , _name()
         , _size( 0, 0 )
+        , _grid( 0, 0 )
+        , _hasCosts( false )
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
         _queueMaster[i] = 0;
@@ -43,6 +60,8 @@ TileQueue::TileQueue( const TileQueue& from )
         , _compound( 0 )
         , _name( from._name )
         , _size( from._size )
+        , _grid( 0, 0 )
+        , _hasCosts( false )
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
         _queueMaster[i] = 0;
@@ -60,6 +79,84 @@ void TileQueue::addTile( const Tile& tile, const fabric::Eye eye )
     _queueMaster[index]->_queue.push() << tile;
 }
 
+void TileQueue::setTileGrid( const Vector2i& grid )
+{
+    if( grid == _grid )
+        return;
+
+    _grid = grid;
+    _costs.assign( grid.x() * grid.y(), 0.f );
+    _hasCosts = false;
+}
+
+void TileQueue::addTileTime( const PixelViewport& pvp, const float time )
+{
+    if( _size.x() <= 0 || _size.y() <= 0 )
+        return;
+
+    const int32_t x = pvp.x / _size.x();
+    const int32_t y = pvp.y / _size.y();
+    if( x < 0 || y < 0 || x >= _grid.x() || y >= _grid.y( ))
+        return;
+
+    float& cost = _costs[ y * _grid.x() + x ];
+    if( cost == 0.f )
+        cost = time;
+    else
+        cost += _costWeight * ( time - cost );
+    _hasCosts = true;
+}
+
+bool TileQueue::fitTileSize( const float tileTime )
+{
+    if( !_hasCosts || tileTime <= 0.f || _size.x() <= 0 || _size.y() <= 0 )
+        return false;
+
+    float cost = 0.f;
+    size_t nCosts = 0;
+    for( std::vector< float >::const_iterator i = _costs.begin();
+         i != _costs.end(); ++i )
+    {
+        if( *i > 0.f )
+        {
+            cost += *i;
+            ++nCosts;
+        }
+    }
+    if( nCosts == 0 )
+        return false;
+
+    const float pixelCost = cost / float( nCosts ) /
+                            float( _size.x() * _size.y( ));
+    const float edge = sqrtf( tileTime / pixelCost );
+    const float current = sqrtf( float( _size.x() * _size.y( )));
+    if( edge < current * _tileSizeHysteresis &&
+        edge * _tileSizeHysteresis > current )
+    {
+        return false;
+    }
+
+    int32_t size = int32_t( edge / float( _tileGranularity ) + .5f ) *
+                   _tileGranularity;
+    size = LB_MAX( size, _tileGranularity );
+    size = LB_MIN( size, _maxTileSize );
+    if( Vector2i( size, size ) == _size )
+        return false;
+
+    _size = Vector2i( size, size );
+    return true;
+}
+
+float TileQueue::getTileCost( const Vector2i& tile ) const
+{
+    if( tile.x() < 0 || tile.y() < 0 ||
+        tile.x() >= _grid.x() || tile.y() >= _grid.y( ))
+    {
+        return 0.f;
+    }
+    return _costs[ tile.y() * _grid.x() + tile.x() ];
+}
+
 void TileQueue::cycleData( const uint32_t frameNumber, const Compound* compound)
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
@@ -144,6 +241,17 @@ const UUID TileQueue::getQueueMasterID( const Eye eye ) const
     return UUID();
 }
 
+bool TileQueue::hasQueueMaster( const uint128_t& id ) const
+{
+    for( std::deque< LatencyQueue* >::const_iterator i = _queues.begin();
+         i != _queues.end(); ++i )
+    {
+        if( (*i)->_queue.getID() == id )
+            return true;
+    }
+    return false;
+}
+
 std::ostream& operator << ( std::ostream& os, const TileQueue* tileQueue )
 {
     if( !tileQueue )
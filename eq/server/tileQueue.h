@@ -63,6 +63,35 @@ namespace server
         /** Add a tile to the queue. */
         void addTile( const Tile& tile, const Eye eye );
 
+        /**
+         * Set the number of tiles in each dimension.
+         *
+         * Resets the tile costs if the number of tiles changes.
+         */
+        EQSERVER_API void setTileGrid( const Vector2i& grid );
+
+        /** Account the measured render time of the tile at the given area. */
+        EQSERVER_API void addTileTime( const PixelViewport& pvp,
+                                       const float time );
+
+        /**
+         * Adapt the tile size to render each tile in about the given time.
+         *
+         * The time per pixel is estimated from the measured tile costs. The
+         * size only changes if it differs significantly from the current one,
+         * since the next tile grid resets the measured costs.
+         *
+         * @param tileTime the target render time per tile, in milliseconds.
+         * @return true if the tile size was changed.
+         */
+        EQSERVER_API bool fitTileSize( const float tileTime );
+
+        /** @return the predicted render time of a tile, or 0 if unknown. */
+        float getTileCost( const Vector2i& tile ) const;
+
+        /** @return true if any render time has been measured. */
+        bool hasTileCosts() const { return _hasCosts; }
+
         /**
          * Cycle the current tile queue.
          *
@@ -90,6 +119,9 @@ namespace server
 
         const UUID getQueueMasterID( const Eye eye ) const;
 
+        /** @return true if the given queue master belongs to this queue. */
+        bool hasQueueMaster( const uint128_t& id ) const;
+
     protected:
         EQSERVER_API virtual ChangeType getChangeType() const
                                                             { return INSTANCE; }
@@ -121,6 +153,13 @@ namespace server
 
         /** The current output queue. */
         TileQueue* _outputQueue[ NUM_EYES ];
+
+        /** The number of tiles in each dimension. */
+        Vector2i _grid;
+
+        /** Running average of the render time per tile, row-major. */
+        std::vector< float > _costs;
+        bool _hasCosts;
     };
 
     std::ostream& operator << ( std::ostream& os, const TileQueue* frame );
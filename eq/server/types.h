@@ -65,6 +65,7 @@ typedef std::vector< Equalizer* >    Equalizers;
 typedef std::vector< Observer* >     Observers;
 typedef std::vector< Segment* >      Segments;
 typedef std::vector< View* >         Views;
+typedef std::vector< uint8_t >       Vectorub;
 
 using lunchbox::uint128_t;
 using lunchbox::UUID;
@@ -0,0 +1,411 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "brickStore.h"
+
+#include <lunchbox/scopedMutex.h>
+#include <fstream>
+
+namespace eVolve
+{
+namespace
+{
+const size_t _nLoaders = 4;
+const size_t _maxCacheSize = 1024u * 1024u * 1024u; // 1 GB of bricks
+
+typedef std::map< std::string, BrickStore* > BrickStores;
+BrickStores _stores; //!< shared stores by file name
+lunchbox::Lock _storesLock;
+}
+
+BrickStore* BrickStore::acquire( const std::string& filename,
+                                 const uint32_t w, const uint32_t h,
+                                 const uint32_t d, const uint32_t bytes )
+{
+    lunchbox::ScopedMutex<> mutex( _storesLock );
+    BrickStores::const_iterator i = _stores.find( filename );
+    if( i != _stores.end( ))
+    {
+        BrickStore* store = i->second;
+        const BrickHeader& header = store->_header;
+        if( header.w != w || header.h != h || header.d != d ||
+            header.bytes != bytes )
+        {
+            LBWARN << "Ignoring " << filename << ", it does not match the "
+                   << "volume" << std::endl;
+            return 0;
+        }
+        ++store->_users;
+        return store;
+    }
+
+    BrickStore* store = new BrickStore;
+    if( !store->_open( filename, w, h, d, bytes ))
+    {
+        delete store;
+        return 0;
+    }
+    store->_users = 1;
+    _stores[ filename ] = store;
+    return store;
+}
+
+void BrickStore::release( BrickStore* store )
+{
+    if( !store )
+        return;
+
+    lunchbox::ScopedMutex<> mutex( _storesLock );
+    LBASSERT( store->_users > 0 );
+    if( --store->_users > 0 )
+        return;
+
+    _stores.erase( store->_filename );
+    delete store;
+}
+
+BrickStore::BrickStore()
+        : _cacheSize( 0 )
+        , _nFinished( 0 )
+        , _users( 0 )
+{
+    memset( &_header, 0, sizeof( _header ));
+}
+
+BrickStore::~BrickStore()
+{
+    _close();
+}
+
+BrickStore::Statistics BrickStore::getStatistics() const
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+    return _statistics;
+}
+
+bool BrickStore::_open( const std::string& filename, const uint32_t w,
+                        const uint32_t h, const uint32_t d,
+                        const uint32_t bytes )
+{
+    _close();
+
+    std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary |
+                                          std::ios::ate );
+    if( !file.is_open( ))
+        return false;
+
+    const uint64_t size = file.tellg();
+    file.seekg( 0, std::ios::beg );
+    file.read( reinterpret_cast< char* >( &_header ), sizeof( _header ));
+    if( !file.good() || _header.magic != BRICK_MAGIC ||
+        _header.version != BRICK_VERSION )
+    {
+        LBWARN << "Ignoring " << filename << ", not a brick file of this "
+               << "version and architecture" << std::endl;
+        return false;
+    }
+
+    if( _header.w != w || _header.h != h || _header.d != d ||
+        _header.bytes != bytes || _header.brickDepth == 0 ||
+        _header.levels == 0 || _header.levels > 32 ||
+        getLevelOffset( _header, _header.levels ) > size )
+    {
+        LBWARN << "Ignoring " << filename << ", it does not match the volume"
+               << std::endl;
+        return false;
+    }
+
+    _filename = filename;
+    for( size_t i = 0; i < _nLoaders; ++i )
+    {
+        Loader* loader = new Loader( *this );
+        if( !loader->start( ))
+        {
+            delete loader;
+            break;
+        }
+        _loaders.push_back( loader );
+    }
+
+    LBLOG( eq::LOG_CUSTOM ) << "Using " << _header.levels << " levels of "
+                            << filename << " with " << _loaders.size()
+                            << " loader threads" << std::endl;
+    return _isOpen();
+}
+
+void BrickStore::_close()
+{
+    for( size_t i = 0; i < _loaders.size(); ++i )
+        _requests.push( 0 );
+    for( size_t i = 0; i < _loaders.size(); ++i )
+    {
+        _loaders[i]->join();
+        delete _loaders[i];
+    }
+    _loaders.clear();
+
+    _pending.clear();
+
+    for( Cache::const_iterator i = _cache.begin(); i != _cache.end(); ++i )
+        delete i->second.brick;
+    _cache.clear();
+    _lru.clear();
+    _cacheSize = 0;
+}
+
+namespace
+{
+uint64_t _getKey( const uint32_t level, const uint32_t index )
+{
+    return ( uint64_t( level ) << 32 ) | index;
+}
+}
+
+bool BrickStore::_isValid( const uint32_t level, const uint32_t start,
+                           const uint32_t end ) const
+{
+    return _isOpen() && level < _header.levels && start <= end &&
+           end < getLevelSize( _header.d, level );
+}
+
+bool BrickStore::_request( const uint32_t level, const uint32_t index )
+{
+    const uint64_t key = _getKey( level, index );
+    if( _cache.find( key ) != _cache.end() || _pending.count( key ))
+        return false;
+
+    _pending.insert( key );
+    _requests.push( _newBrick( level, index ));
+    return true;
+}
+
+BrickStore::Brick* BrickStore::_newBrick( const uint32_t level,
+                                          const uint32_t index ) const
+{
+    const uint32_t depth = getLevelSize( _header.d, level );
+    const uint32_t first = index * _header.brickDepth;
+    const uint32_t nSlices = LB_MIN( _header.brickDepth, depth - first );
+    const uint64_t sliceSize = getSliceSize( _header, level );
+
+    Brick* brick = new Brick;
+    brick->key = _getKey( level, index );
+    brick->offset = getLevelOffset( _header, level ) + first * sliceSize;
+    brick->data.resize( size_t( nSlices * sliceSize ));
+    brick->loaded = false;
+    return brick;
+}
+
+bool BrickStore::readSlices( const uint32_t level, const uint32_t start,
+                             const uint32_t end, uint8_t* data,
+                             const size_t rowPitch, const size_t slicePitch )
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+    if( !_isValid( level, start, end ))
+        return false;
+
+    // request all missing bricks at once to read them concurrently
+    const uint32_t brickDepth = _header.brickDepth;
+    const uint32_t first = start / brickDepth;
+    const uint32_t last = end / brickDepth;
+    for( uint32_t i = first; i <= last; ++i )
+    {
+        if( _cache.find( _getKey( level, i )) != _cache.end( ))
+            ++_statistics.hits;
+        else
+        {
+            _request( level, i );
+            ++_statistics.misses;
+        }
+    }
+
+    // Wait for the missing bricks without holding the lock, so that the other
+    // pipes and the loaders use the store meanwhile. Bricks evicted by another
+    // pipe while waiting are requested once more, failed bricks are not.
+    std::set< uint64_t > retried;
+    for( ;; )
+    {
+        bool complete = true;
+        for( uint32_t i = first; i <= last; ++i )
+        {
+            const uint64_t key = _getKey( level, i );
+            if( _cache.find( key ) != _cache.end() || _pending.count( key ))
+            {
+                complete = complete && _cache.find( key ) != _cache.end();
+                continue;
+            }
+            if( !retried.insert( key ).second )
+            {
+                LBERROR << "Can't read bricks from " << _filename << std::endl;
+                return false;
+            }
+            _request( level, i );
+            complete = false;
+        }
+        if( complete )
+            break;
+
+        const uint64_t nFinished = _nFinished.get();
+        _lock.unset();
+        _nFinished.waitNE( nFinished );
+        _lock.set();
+    }
+
+    // pin the bricks and copy them without the lock, _evict() skips them
+    std::vector< Entry* > entries;
+    for( uint32_t i = first; i <= last; ++i )
+    {
+        Entry& entry = _cache[ _getKey( level, i ) ];
+        _lru.splice( _lru.end(), _lru, entry.lru );
+        ++entry.users;
+        entries.push_back( &entry );
+    }
+
+    const size_t w = getLevelSize( _header.w, level );
+    const size_t h = getLevelSize( _header.h, level );
+    const size_t rowSize = w * _header.bytes;
+    const size_t sliceSize = rowSize * h;
+    _lock.unset();
+    for( uint32_t i = first; i <= last; ++i )
+    {
+        const Brick* brick = entries[ i - first ]->brick;
+        const uint32_t brickStart = i * brickDepth;
+        const uint32_t from = LB_MAX( start, brickStart );
+        const uint32_t to = LB_MIN( end, brickStart + brickDepth - 1 );
+        for( uint32_t z = from; z <= to; ++z )
+        {
+            const uint8_t* src = &brick->data[ (z - brickStart) * sliceSize ];
+            uint8_t* dst = data + ( z - start ) * slicePitch;
+            if( rowPitch == rowSize )
+                memcpy( dst, src, sliceSize );
+            else
+                for( size_t y = 0; y < h; ++y )
+                    memcpy( dst + y * rowPitch, src + y * rowSize, rowSize );
+        }
+    }
+    _lock.set();
+
+    for( size_t i = 0; i < entries.size(); ++i )
+        --entries[i]->users;
+    _evict();
+    return true;
+}
+
+bool BrickStore::isAvailable( const uint32_t level, const uint32_t start,
+                              const uint32_t end )
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+    if( !_isValid( level, start, end ))
+        return false;
+
+    const uint32_t last = end / _header.brickDepth;
+    for( uint32_t i = start / _header.brickDepth; i <= last; ++i )
+        if( _cache.find( _getKey( level, i )) == _cache.end( ))
+            return false;
+    return true;
+}
+
+void BrickStore::prefetch( const uint32_t level, const uint32_t start,
+                           const uint32_t end )
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+    if( !_isValid( level, start, end ))
+        return;
+
+    const uint32_t last = end / _header.brickDepth;
+    for( uint32_t i = start / _header.brickDepth; i <= last; ++i )
+        if( _request( level, i ))
+            ++_statistics.prefetched;
+}
+
+void BrickStore::_finish( Brick* brick )
+{
+    _pending.erase( brick->key );
+    if( brick->loaded )
+        _insert( brick );
+    else
+    {
+        LBWARN << "Can't read brick from " << _filename << std::endl;
+        delete brick;
+    }
+}
+
+void BrickStore::_insert( Brick* brick )
+{
+    Entry& entry = _cache[ brick->key ];
+    entry.brick = brick;
+    entry.lru = _lru.insert( _lru.end(), brick->key );
+    entry.users = 0;
+    _cacheSize += brick->data.size();
+}
+
+void BrickStore::_evict()
+{
+    LRU::iterator j = _lru.begin();
+    while( _cacheSize > _maxCacheSize && j != _lru.end( ))
+    {
+        Cache::iterator i = _cache.find( *j );
+        LBASSERT( i != _cache.end( ));
+        if( i->second.users > 0 ) // copied by a readSlices()
+        {
+            ++j;
+            continue;
+        }
+        _cacheSize -= i->second.brick->data.size();
+        delete i->second.brick;
+        _cache.erase( i );
+        j = _lru.erase( j );
+    }
+}
+
+void BrickStore::Loader::run()
+{
+    lunchbox::Thread::setName( "eVolve brick loader" );
+    std::ifstream file( _store._filename.c_str(),
+                        std::ios::in | std::ios::binary );
+    for( ;; )
+    {
+        Brick* brick = _store._requests.pop();
+        if( !brick )
+            return;
+
+        if( file.is_open( ))
+        {
+            file.seekg( std::streamoff( brick->offset ), std::ios::beg );
+            file.read( reinterpret_cast< char* >( &brick->data[0] ),
+                       brick->data.size( ));
+            brick->loaded = file.good();
+            file.clear();
+        }
+
+        lunchbox::ScopedMutex<> mutex( _store._lock );
+        _store._finish( brick );
+        ++_store._nFinished; // wakes up waiting readSlices()
+    }
+}
+
+}
@@ -0,0 +1,161 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVOLVE_BRICK_STORE_H
+#define EVOLVE_BRICK_STORE_H
+
+#include "volumeBricks.h"
+
+#include <eq/eq.h>
+#include <lunchbox/monitor.h>
+#include <list>
+#include <map>
+#include <set>
+
+namespace eVolve
+{
+    /** Reads slices of a bricked volume file through a LRU brick cache.
+
+        Bricks missing in the cache are read concurrently by a pool of loader
+        threads, so that range changes only read the newly needed bricks.
+        Bricks may be prefetched in the background, and the availability of
+        slices can be queried without blocking.
+
+        One store per file is shared by all pipes of the process. All methods
+        are thread safe. The loaders insert the read bricks into the cache,
+        and a readSlices() waiting for or copying bricks does not block the
+        other pipes.
+    */
+    class BrickStore
+    {
+    public:
+        /**
+         * @return the shared store of a brick file, or 0 if the file does not
+         *         exist or does not match the volume.
+         */
+        static BrickStore* acquire( const std::string& filename,
+                                    const uint32_t w, const uint32_t h,
+                                    const uint32_t d, const uint32_t bytes );
+
+        /** Release a store returned by acquire(). */
+        static void release( BrickStore* store );
+
+        uint32_t getLevels() const { return _header.levels; }
+
+        /** Copy the slices [start, end] of a level into a padded buffer. */
+        bool readSlices( const uint32_t level, const uint32_t start,
+                         const uint32_t end, uint8_t* data,
+                         const size_t rowPitch, const size_t slicePitch );
+
+        /** @return true if all bricks of the slices are cached, nonblocking */
+        bool isAvailable( const uint32_t level, const uint32_t start,
+                          const uint32_t end );
+
+        /** Start loading the bricks of the slices in the background. */
+        void prefetch( const uint32_t level, const uint32_t start,
+                       const uint32_t end );
+
+        struct Statistics
+        {
+            Statistics() : hits( 0 ), misses( 0 ), prefetched( 0 ) {}
+
+            uint64_t hits;       //!< bricks read from the cache
+            uint64_t misses;     //!< bricks waited for by readSlices
+            uint64_t prefetched; //!< bricks requested by prefetch
+        };
+        Statistics getStatistics() const;
+
+    private:
+        BrickStore();
+        ~BrickStore();
+
+        /** Open the file and verify it against the volume header. */
+        bool _open( const std::string& filename, const uint32_t w,
+                    const uint32_t h, const uint32_t d, const uint32_t bytes );
+        void _close();
+        bool _isOpen() const { return !_loaders.empty(); }
+
+        struct Brick
+        {
+            uint64_t key;
+            uint64_t offset; //!< in the file
+            std::vector< uint8_t > data;
+            bool loaded;
+        };
+        typedef lunchbox::MTQueue< Brick* > BrickQueue;
+
+        class Loader : public lunchbox::Thread
+        {
+        public:
+            Loader( BrickStore& store ) : _store( store ) {}
+            virtual ~Loader() {}
+
+        protected:
+            virtual void run();
+
+        private:
+            BrickStore& _store;
+        };
+        friend class Loader;
+
+        typedef std::list< uint64_t > LRU;
+        struct Entry
+        {
+            Brick* brick;
+            LRU::iterator lru;
+            size_t users; //!< readSlices() copying the brick
+        };
+        typedef std::map< uint64_t, Entry > Cache;
+
+        std::string _filename;
+        BrickHeader _header;
+
+        BrickQueue _requests; //!< bricks to read, 0 stops a loader
+        std::vector< Loader* > _loaders;
+
+        Cache  _cache;
+        LRU    _lru;       //!< least recently used brick first
+        size_t _cacheSize; //!< in bytes
+        std::set< uint64_t > _pending; //!< requested, not yet cached bricks
+        lunchbox::Monitor< uint64_t > _nFinished; //!< bricks read by loaders
+
+        Statistics _statistics;
+        mutable lunchbox::Lock _lock; //!< protects the cache and the requests
+        size_t _users; //!< number of acquire() calls not released
+
+        bool _isValid( const uint32_t level, const uint32_t start,
+                       const uint32_t end ) const;
+        bool _request( const uint32_t level, const uint32_t index );
+        Brick* _newBrick( const uint32_t level, const uint32_t index ) const;
+        void _finish( Brick* brick );
+        void _insert( Brick* brick );
+        void _evict();
+    };
+}
+
+#endif // EVOLVE_BRICK_STORE_H
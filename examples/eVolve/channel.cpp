@@ -37,6 +37,8 @@
 #include "hlp.h"
 #include "framesOrderer.h"
 
+#include <sstream>
+
 namespace eVolve
 {
 Channel::Channel( eq::Window* parent )
@@ -185,7 +187,7 @@ void Channel::frameDraw( const eq::uint128_t& frameID )
     const int normalsQuality = _getFrameData().getNormalsQuality();
 
     const eq::Range& range = getRange();
-    renderer->render( range, modelviewM, modelviewITM, invRotationM,
+    renderer->render( range, getID(), modelviewM, modelviewITM, invRotationM,
                       taintColor, normalsQuality );
     checkError( "error during rendering " );
 
@@ -401,6 +403,7 @@ void Channel::frameReadback( const eq::uint128_t& frameID )
 void Channel::frameViewFinish( const eq::uint128_t& frameID )
 {
     _drawHelp();
+    _drawCacheStatistics();
     _drawLogo();
     eq::Channel::frameViewFinish( frameID );
 }
@@ -524,4 +527,34 @@ void Channel::_drawHelp()
 
     EQ_GL_CALL( resetAssemblyState( ));
 }
+
+void Channel::_drawCacheStatistics()
+{
+    const FrameData& frameData = _getFrameData();
+    const Pipe* pipe = static_cast< const Pipe* >( getPipe( ));
+    const Renderer* renderer = pipe->getRenderer();
+    if( !frameData.useStatistics() || !renderer )
+        return;
+
+    const RawVolumeModel::Statistics stats = renderer->getStatistics();
+    std::ostringstream os;
+    os << "Textures: " << stats.textureHits << " hits, "
+       << stats.textureMisses << " misses, " << stats.refinements
+       << " refinements  Bricks: " << stats.bricks.hits << " hits, "
+       << stats.bricks.misses << " misses, " << stats.bricks.prefetched
+       << " prefetched";
+
+    applyBuffer();
+    applyViewport();
+    setupAssemblyState();
+
+    glDisable( GL_LIGHTING );
+    glDisable( GL_DEPTH_TEST );
+
+    glColor3f( 1.f, 1.f, 1.f );
+    glRasterPos3f( 10.f, 10.f, 0.99f );
+    getWindow()->getSmallFont()->draw( os.str( ));
+
+    EQ_GL_CALL( resetAssemblyState( ));
+}
 }
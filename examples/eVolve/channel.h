@@ -75,6 +75,7 @@ namespace eVolve
 
         void _drawLogo();
         void _drawHelp();
+        void _drawCacheStatistics();
 
         eq::Vector3f _bgColor;   //!< background color
         eq::Frame    _frame;     //!< Readback buffer for DB compositing
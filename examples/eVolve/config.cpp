@@ -264,6 +264,14 @@ bool Config::_handleKeyEvent( const eq::KeyEvent& event )
             _frameData.adjustQuality( .1f );
             return true;
 
+        case 't':
+            _frameData.adjustThreshold( -8 );
+            return true;
+
+        case 'T':
+            _frameData.adjustThreshold( 8 );
+            return true;
+
         case 'c':
         case 'C':
         {
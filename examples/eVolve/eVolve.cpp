@@ -52,6 +52,8 @@ static const std::string _help(
     std::string( "\t\ts:                         Toggle statistics " ) +
     std::string( "overlay\n" ) +
     std::string( "\t\tl:                         Switch layout for active canvas\n")+
+    std::string( "\t\tt, T:                      Lower, raise transparency " ) +
+    std::string( "threshold\n" ) +
     std::string( "\t\tF1, h:                     Toggle help overlay\n" )
  );
 
@@ -44,6 +44,7 @@ FrameData::FrameData()
     , _statistics(    false )
     , _help(          false )
     , _quality( 1.0f )
+    , _threshold( 0 )
 {
     reset();
     LBINFO << "New FrameData " << std::endl;
@@ -151,6 +152,14 @@ void FrameData::adjustQuality( const float delta )
     LBINFO << "Set non-idle image quality to " << _quality << std::endl;
 }
 
+void FrameData::adjustThreshold( const int delta )
+{
+    _threshold = uint8_t( LB_MIN( LB_MAX( _threshold + delta, 0 ), 255 ));
+    setDirty( DIRTY_FLAGS );
+    LBINFO << "Set transfer function threshold to " << int( _threshold )
+           << std::endl;
+}
+
 void FrameData::serialize( co::DataOStream& os, const uint64_t dirtyBits )
 {
     co::Serializable::serialize( os, dirtyBits );
@@ -162,7 +171,7 @@ void FrameData::serialize( co::DataOStream& os, const uint64_t dirtyBits )
 
     if( dirtyBits & DIRTY_FLAGS )
         os  << _ortho << _colorMode << _bgMode << _normalsQuality
-            << _statistics << _quality << _help;
+            << _statistics << _quality << _help << _threshold;
 
     if( dirtyBits & DIRTY_MESSAGE )
         os << _message;
@@ -179,7 +188,7 @@ void FrameData::deserialize( co::DataIStream& is, const uint64_t dirtyBits)
 
     if( dirtyBits & DIRTY_FLAGS )
         is  >> _ortho >> _colorMode >> _bgMode >> _normalsQuality
-            >> _statistics  >> _quality >> _help;
+            >> _statistics  >> _quality >> _help >> _threshold;
 
     if( dirtyBits & DIRTY_MESSAGE )
         is >> _message;
@@ -48,6 +48,7 @@ namespace eVolve
         //*{
         void setOrtho( const bool ortho );
         void adjustQuality( const float delta );
+        void adjustThreshold( const int delta );
         void toggleBackground();
         void toggleNormalsQuality();
         void toggleColorMode();
@@ -68,6 +69,7 @@ namespace eVolve
         const eq::Vector3f& getTranslation() const { return _translation; }
         const eq::Matrix4f& getRotation()    const { return _rotation;    }
         float getQuality() const { return _quality; }
+        uint8_t getThreshold() const { return _threshold; }
         ColorMode getColorMode() const { return _colorMode; }
         BackgroundMode getBackgroundMode() const { return _bgMode; }
         NormalsQuality getNormalsQuality() const { return _normalsQuality; }
@@ -118,6 +120,7 @@ namespace eVolve
         bool            _statistics;
         bool            _help;
         float           _quality;
+        uint8_t         _threshold;
         eq::uint128_t   _currentViewID;
         std::string     _message;
     };
@@ -98,5 +98,6 @@ void Pipe::frameStart( const eq::uint128_t& frameID, const uint32_t frameNumber
     _frameData.sync( frameID );
 
     _renderer->setOrtho( _frameData.useOrtho( ));
+    _renderer->setThreshold( _frameData.getThreshold( ));
 }
 }
@@ -0,0 +1,322 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "preintegrationTable.h"
+#include "hlp.h"
+
+namespace eVolve
+{
+namespace
+{
+struct CacheEntry
+{
+    std::vector< uint8_t > TF;
+    std::vector< GLubyte > table;
+    uint64_t lastUsed; //!< for LRU eviction
+};
+typedef std::map< uint32_t, CacheEntry > Cache;
+
+// tables of all models in the process, keyed by the transfer function hash
+lunchbox::Lock _cacheLock;
+Cache _cache;
+uint64_t _cacheTime = 0; //!< number of cache lookups
+const size_t _maxCacheSize = 32;
+
+void _evictLRU()
+{
+    Cache::iterator oldest = _cache.begin();
+    for( Cache::iterator i = _cache.begin(); i != _cache.end(); ++i )
+        if( i->second.lastUsed < oldest->second.lastUsed )
+            oldest = i;
+    if( oldest != _cache.end( ))
+        _cache.erase( oldest );
+}
+
+uint32_t _hash( const std::vector< uint8_t >& TF )
+{
+    uint32_t hash = 2166136261u; // FNV-1a
+    for( size_t i = 0; i < TF.size(); ++i )
+        hash = ( hash ^ TF[i] ) * 16777619u;
+    return hash;
+}
+
+inline void _setEntry( GLubyte* entry, const double r, const double g,
+                       const double b, const double a )
+{
+    using hlpFuncs::clip;
+    entry[0] = clip( static_cast<int>( r ), 0, 255 );
+    entry[1] = clip( static_cast<int>( g ), 0, 255 );
+    entry[2] = clip( static_cast<int>( b ), 0, 255 );
+    entry[3] = clip( static_cast<int>( a ), 0, 255 );
+}
+}
+
+PreintegrationTable::PreintegrationTable()
+        : _texture( 0 )
+        , _nPending( 0 )
+        , _worker( *this )
+{
+    _worker.start();
+}
+
+PreintegrationTable::~PreintegrationTable()
+{
+    _jobs.push( 0 );
+    _worker.join();
+
+    Job* job = 0;
+    while( _results.tryPop( job ))
+        delete job;
+}
+
+void PreintegrationTable::setTransferFunction( const std::vector<uint8_t>& tf )
+{
+    // shorter transfer functions are transparent above their last value
+    std::vector< uint8_t > TF( tf );
+    TF.resize( 256*4, 0 );
+
+    // find the changed values, the first table is computed completely
+    uint32_t first = 0;
+    uint32_t last = 255;
+    if( _TF.size() == TF.size( ))
+    {
+        while( first < 256 && !memcmp( &TF[first*4], &_TF[first*4], 4 ))
+            ++first;
+        if( first == 256 )
+            return;
+        while( !memcmp( &TF[last*4], &_TF[last*4], 4 ))
+            --last;
+    }
+    _TF = TF;
+
+    Job* job = new Job;
+    job->TF = TF;
+    job->first = first;
+    job->last = last;
+    ++_nPending;
+    _jobs.push( job );
+}
+
+GLuint PreintegrationTable::getTexture()
+{
+    // the first table is needed to render at all
+    if( _texture == 0 && _nPending > 0 )
+    {
+        Job* job = _results.pop();
+        _upload( *job );
+        delete job;
+        --_nPending;
+    }
+
+    Job* job = 0;
+    while( _results.tryPop( job ))
+    {
+        _upload( *job );
+        delete job;
+        --_nPending;
+    }
+    return _texture;
+}
+
+/** Upload the entries depending on the changed transfer function values
+    [first, last], that is the entries of a front and back value pair
+    (sf, sb) with min( sf, sb ) <= last and max( sf, sb ) >= first.
+*/
+void PreintegrationTable::_upload( const Job& job )
+{
+    if( _texture == 0 )
+    {
+        LBLOG( eq::LOG_CUSTOM ) << "Creating preint" << std::endl;
+        glGenTextures( 1, &_texture );
+        glBindTexture( GL_TEXTURE_2D, _texture );
+        glTexImage2D(  GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0,
+                       GL_RGBA, GL_UNSIGNED_BYTE, &job.table[0] );
+
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        return;
+    }
+
+    const GLint first = job.first;
+    const GLint last = job.last;
+    glBindTexture( GL_TEXTURE_2D, _texture );
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, 256 );
+
+    // rows sb <= last, columns sf >= first
+    glPixelStorei( GL_UNPACK_SKIP_PIXELS, first );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, first, 0, 256-first, last+1,
+                     GL_RGBA, GL_UNSIGNED_BYTE, &job.table[0] );
+
+    // rows sb >= first, columns sf <= last
+    glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+    glPixelStorei( GL_UNPACK_SKIP_ROWS, first );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, first, last+1, 256-first,
+                     GL_RGBA, GL_UNSIGNED_BYTE, &job.table[0] );
+
+    glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+}
+
+/** Compute the table entries depending on the transfer function values
+    [first, last] from summed area tables of the averaged neighbouring
+    values. The rows are split at the diagonal, so that the inner loops
+    run over contiguous entries without branches.
+
+    The summed area tables are exact integer sums, so that an entry only
+    depends on the transfer function values between its front and back
+    value. Partially and completely computed tables are thus identical,
+    which the cache keyed by the transfer function relies on.
+*/
+void PreintegrationTable::_compute( const std::vector< uint8_t >& TF,
+                                    const uint32_t first, const uint32_t last,
+                                    Table& table )
+{
+    const uint8_t* values = &TF[0];
+    uint32_t rInt[256]; rInt[0] = 0;
+    uint32_t gInt[256]; gInt[0] = 0;
+    uint32_t bInt[256]; bInt[0] = 0;
+    uint32_t aInt[256]; aInt[0] = 0;
+    double inverse[256]; inverse[0] = 0.;
+
+    // Creating SAT (Summed Area Tables) from neighbouring RGBA value pairs,
+    // scaled by colorScale and alphaScale to the averages
+    for( int i=1; i<256; i++ )
+    {
+        // sum of Alpha from two neighbouring TF values
+        const uint32_t tauc = values[(i-1)*4+3] + values[i*4+3];
+
+        // SAT of RGBs from two neighbouring TF values multiplied with Alpha
+        rInt[i] = rInt[i-1] + ( values[(i-1)*4+0] + values[i*4+0] ) * tauc;
+        gInt[i] = gInt[i-1] + ( values[(i-1)*4+1] + values[i*4+1] ) * tauc;
+        bInt[i] = bInt[i-1] + ( values[(i-1)*4+2] + values[i*4+2] ) * tauc;
+
+        // SAT of Alpha values
+        aInt[i] = aInt[i-1] + tauc;
+
+        inverse[i] = 1. / (double)i;
+    }
+    const double colorScale = 1. / 4. / 255.;
+    const double alphaScale = 1. / 2. / 255.;
+
+    table.resize( 256*256*4, 255 );
+    for( int sb=0; sb<256; sb++ )
+    {
+        // changed columns of this row
+        const int begin = sb < int( first ) ? first : 0;
+        const int end   = sb > int( last )  ? last  : 255;
+        GLubyte* row = &table[ sb*256*4 ];
+
+        // sf < sb
+        for( int sf=begin; sf<LB_MIN( end+1, sb ); sf++ )
+        {
+            const double factor = inverse[sb-sf];
+            const double alpha = ( aInt[sb] - aInt[sf] ) * alphaScale * factor;
+            _setEntry( &row[sf*4],
+                       ( rInt[sb] - rInt[sf] ) * colorScale * factor,
+                       ( gInt[sb] - gInt[sf] ) * colorScale * factor,
+                       ( bInt[sb] - bInt[sf] ) * colorScale * factor,
+                       exp( -alpha ) * 255. );
+        }
+
+        // sf == sb
+        if( sb >= begin && sb <= end )
+        {
+            const int    index  = sb*4;
+            const double factor = 1./255.;
+            _setEntry( &row[sb*4],
+                       values[index+0] * values[index+3] * factor,
+                       values[index+1] * values[index+3] * factor,
+                       values[index+2] * values[index+3] * factor,
+                       exp( -values[index+3] * factor ) * 256. );
+        }
+
+        // sf > sb
+        for( int sf=LB_MAX( begin, sb+1 ); sf<=end; sf++ )
+        {
+            const double factor = inverse[sf-sb];
+            const double alpha = ( aInt[sf] - aInt[sb] ) * alphaScale * factor;
+            _setEntry( &row[sf*4],
+                       ( rInt[sf] - rInt[sb] ) * colorScale * factor,
+                       ( gInt[sf] - gInt[sb] ) * colorScale * factor,
+                       ( bInt[sf] - bInt[sb] ) * colorScale * factor,
+                       exp( -alpha ) * 255. );
+        }
+    }
+}
+
+void PreintegrationTable::Worker::run()
+{
+    lunchbox::Thread::setName( "eVolve preintegration" );
+    for( ;; )
+    {
+        Job* job = _table._jobs.pop();
+        if( !job )
+            return;
+
+        const uint32_t hash = _hash( job->TF );
+        bool cached = false;
+        {
+            lunchbox::ScopedWrite mutex( _cacheLock );
+            Cache::iterator i = _cache.find( hash );
+            if( i != _cache.end() && i->second.TF == job->TF )
+            {
+                _current = i->second.table;
+                i->second.lastUsed = ++_cacheTime;
+                cached = true;
+            }
+        }
+
+        if( !cached )
+        {
+            LBLOG( eq::LOG_CUSTOM ) << "Calculating preintegration table"
+                                    << std::endl;
+            if( _current.empty( ))
+                _compute( job->TF, 0, 255, _current );
+            else
+                _compute( job->TF, job->first, job->last, _current );
+
+            lunchbox::ScopedWrite mutex( _cacheLock );
+            if( _cache.size() >= _maxCacheSize &&
+                _cache.find( hash ) == _cache.end( ))
+            {
+                _evictLRU();
+            }
+            CacheEntry& entry = _cache[ hash ];
+            entry.TF = job->TF;
+            entry.table = _current;
+            entry.lastUsed = ++_cacheTime;
+        }
+
+        job->table = _current;
+        _table._results.push( job );
+    }
+}
+
+}
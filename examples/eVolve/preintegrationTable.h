@@ -0,0 +1,99 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVOLVE_PREINTEGRATION_TABLE_H
+#define EVOLVE_PREINTEGRATION_TABLE_H
+
+#include <eq/eq.h>
+
+namespace eVolve
+{
+    /** The pre-integrated transfer function as 256x256 RGBA texture.
+
+        Tables are computed on a worker thread and cached process-wide by the
+        hash of the transfer function. When the transfer function changes,
+        only the entries and texture regions depending on the changed
+        transfer function values are recomputed and uploaded.
+    */
+    class PreintegrationTable
+    {
+    public:
+        PreintegrationTable();
+        ~PreintegrationTable();
+
+        /** Set the 256 RGBA transfer function values. */
+        void setTransferFunction( const std::vector< uint8_t >& TF );
+
+        /** @return the texture with the latest computed table, GL thread. */
+        GLuint getTexture();
+
+    private:
+        typedef std::vector< GLubyte > Table;
+
+        /** A table computation with the transfer function range changed
+            since the previous one. */
+        struct Job
+        {
+            std::vector< uint8_t > TF;
+            uint32_t first; //!< first changed transfer function value
+            uint32_t last;  //!< last changed transfer function value
+            Table    table; //!< the computed table
+        };
+        typedef lunchbox::MTQueue< Job* > JobQueue;
+
+        class Worker : public lunchbox::Thread
+        {
+        public:
+            Worker( PreintegrationTable& table ) : _table( table ) {}
+            virtual ~Worker() {}
+
+        protected:
+            virtual void run();
+
+        private:
+            PreintegrationTable& _table;
+            Table _current; //!< the table of the previous job
+        };
+        friend class Worker;
+
+        std::vector< uint8_t > _TF;      //!< latest transfer function
+        GLuint                 _texture;
+        uint32_t               _nPending; //!< jobs not yet uploaded
+
+        JobQueue _jobs;     //!< to the worker, 0 stops it
+        JobQueue _results;  //!< computed tables, to upload
+        Worker   _worker;
+
+        static void _compute( const std::vector< uint8_t >& TF,
+                              const uint32_t first, const uint32_t last,
+                              Table& table );
+        void _upload( const Job& job );
+    };
+}
+
+#endif // EVOLVE_PREINTEGRATION_TABLE_H
@@ -37,7 +37,11 @@ using hlpFuncs::clip;
 using hlpFuncs::hFile;
 
 
-static GLuint createPreintegrationTable( const uint8_t* Table );
+// maximum volume texture size, coarser levels of bricked data are used above
+static const uint64_t maxTextureSize = 512u * 1024u * 1024u;
+
+// maximum number of cached volume textures for different ranges
+static const size_t maxVolumeParts = 4;
 
 static bool readTransferFunction( FILE* file, std::vector<uint8_t>& TF );
 
@@ -51,19 +55,33 @@ static bool readDimensionsAndScaling
 
 // Read volume dimensions, scaling and transfer function
 RawVolumeModel::RawVolumeModel( const std::string& filename  )
-        : _headerLoaded( false )
+        : _bricks( 0 )
+        , _headerLoaded( false )
         , _filename( filename )
-        , _preintName  ( 0 )
         , _w( 0 )
         , _h( 0 )
         , _d( 0 )
-        , _tW( 0 )
-        , _tH( 0 )
-        , _tD( 0 )
+        , _threshold( 0 )
         , _hasDerivatives( true )
         , _glewContext( 0 )
+        , _useCount( 0 )
+        , _textureHits( 0 )
+        , _textureMisses( 0 )
+        , _refinements( 0 )
 {}
 
+RawVolumeModel::~RawVolumeModel()
+{
+    const Statistics stats = getStatistics();
+    LBINFO << "Volume textures of " << _filename << ": " << stats.textureHits
+           << " hits, " << stats.textureMisses << " misses, "
+           << stats.refinements << " refinements; bricks: "
+           << stats.bricks.hits << " hits, " << stats.bricks.misses
+           << " misses, " << stats.bricks.prefetched << " prefetched"
+           << std::endl;
+    BrickStore::release( _bricks );
+}
+
 bool RawVolumeModel::loadHeader( const float brightness, const float alpha )
 {
     LBASSERT( !_headerLoaded );
@@ -91,6 +109,13 @@ bool RawVolumeModel::loadHeader( const float brightness, const float alpha )
 
     _resolution = LB_MAX( _w, LB_MAX( _h, _d ) );
 
+    _bricks = BrickStore::acquire( getBrickFilename( _filename ), _w, _h, _d,
+                                   _hasDerivatives ? 4 : 1 );
+    if( _bricks )
+    {
+        LBINFO << "Using bricked volume data of " << _filename << std::endl;
+    }
+
     if( !readTransferFunction( header.f, _TF ))
         return false;
 
@@ -110,6 +135,7 @@ bool RawVolumeModel::loadHeader( const float brightness, const float alpha )
         for( size_t i = 3; i < _TF.size(); i+=4 )
             _TF[i] = static_cast< uint8_t >( _TF[i] * alpha );
 
+    _updateTransferFunction();
     return true;
 }
 
@@ -120,59 +146,161 @@ static int32_t calcHashKey( const eq::Range& range )
 }
 
 
-bool RawVolumeModel::getVolumeInfo( VolumeInfo& info, const eq::Range& range )
+bool RawVolumeModel::getVolumeInfo( VolumeInfo& info, const eq::Range& range,
+                                    const eq::uint128_t& channelID )
 {
     if( !_headerLoaded && !loadHeader( 1.0f, 1.0f ))
         return false;
 
-    if( _preintName == 0 )
-    {
-        LBLOG( eq::LOG_CUSTOM ) << "Creating preint" << std::endl;
-        _preintName = createPreintegrationTable( &_TF[0] );
-    }
-
           VolumePart* volumePart = 0;
     const int32_t     key        = calcHashKey( range );
 
     if( _volumeHash.find( key ) == _volumeHash.end( ) )
     {
-        // new key
+        // new key, drop the texture of an old range, e.g., from a load
+        // equalizer
+        if( _volumeHash.size() >= maxVolumeParts )
+            _releaseOldestVolumePart();
+
+        ++_textureMisses;
         volumePart = &_volumeHash[ key ];
-        if( !_createVolumeTexture( volumePart->volume, volumePart->TD, range ))
+        volumePart->volume = 0;
+        if( !_createVolumeTexture( *volumePart, range ))
+        {
+            _volumeHash.erase( key );
             return false;
+        }
     }
     else
-    {   // old key
+    {   // old key, replace a coarse texture once the finer bricks arrived
+        ++_textureHits;
         volumePart = &_volumeHash[ key ];
+        if( volumePart->level != volumePart->bestLevel )
+        {
+            Slab slab;
+            _getSlab( volumePart->bestLevel, range, slab );
+            if( _bricks && _bricks->isAvailable( volumePart->bestLevel,
+                                                 slab.start, slab.end ))
+            {
+                ++_refinements;
+                _createVolumeTexture( *volumePart, range );
+            }
+        }
     }
 
+    volumePart->lastUsed = ++_useCount;
+    _prefetch( range, volumePart->bestLevel, channelID );
+
     info.volume     = volumePart->volume;
     info.TD         = volumePart->TD;
-    info.preint     = _preintName;
+    info.preint     = _preint.getTexture();
     info.volScaling = _volScaling;
     info.hasDerivatives = _hasDerivatives;
-    if( _hasDerivatives )
-    {
-        info.voxelSize.W  = 1.f;
-        info.voxelSize.H  = 1.f;
-        info.voxelSize.D  = 1.f;
-    }else
+    info.voxelSize  = volumePart->voxelSize;
+    return true;
+}
+
+
+/** Prefetch the slices next to the range in the direction it moved since
+    the last frame of the channel, e.g., for ranges set by a load equalizer.
+*/
+void RawVolumeModel::_prefetch( const eq::Range& range, const uint32_t level,
+                                const eq::uint128_t& channelID )
+{
+    if( !_bricks )
+        return;
+
+    RangeMap::iterator i = _lastRanges.find( channelID );
+    if( i == _lastRanges.end( ))
     {
-        info.voxelSize.W  = 1.f / _tW;
-        info.voxelSize.H  = 1.f / _tH;
-        info.voxelSize.D  = 1.f / _tD;
+        _lastRanges[ channelID ] = range;
+        return;
     }
-    return true;
+
+    eq::Range& lastRange = i->second;
+    const float moveStart = fabs( range.start - lastRange.start );
+    const float moveEnd   = fabs( range.end   - lastRange.end );
+    const float delta = LB_MIN( range.end - range.start,
+                                LB_MAX( moveStart, moveEnd ));
+    lastRange = range;
+    if( delta <= 0.f )
+        return;
+
+    const eq::Range next( LB_MAX( 0.f, range.start - delta ),
+                          LB_MIN( 1.f, range.end   + delta ));
+    Slab slab;
+    _getSlab( level, next, slab );
+    _bricks->prefetch( level, slab.start, slab.end );
+}
+
+
+RawVolumeModel::Statistics RawVolumeModel::getStatistics() const
+{
+    Statistics statistics;
+    statistics.textureHits = _textureHits;
+    statistics.textureMisses = _textureMisses;
+    statistics.refinements = _refinements;
+    if( _bricks )
+        statistics.bricks = _bricks->getStatistics();
+    return statistics;
+}
+
+
+void RawVolumeModel::setTransferFunction( const std::vector< uint8_t >& TF )
+{
+    _TF = TF;
+    _updateTransferFunction();
+}
+
+
+void RawVolumeModel::setThreshold( const uint8_t threshold )
+{
+    if( _threshold == threshold )
+        return;
+
+    _threshold = threshold;
+    if( _headerLoaded )
+        _updateTransferFunction();
+}
+
+
+/** Only the values between the old and the new threshold change, which
+    the pre-integration table recomputes incrementally. */
+void RawVolumeModel::_updateTransferFunction()
+{
+    std::vector< uint8_t > TF( _TF );
+    const size_t end = LB_MIN( size_t( _threshold ) * 4, TF.size( ));
+    std::fill( TF.begin(), TF.begin() + end, 0 );
+    _preint.setTransferFunction( TF );
 }
 
 
 void RawVolumeModel::releaseVolumeInfo( const eq::Range& range )
 {
     const int32_t key = calcHashKey( range );
-    if( _volumeHash.find( key ) == _volumeHash.end() )
+    VolumeHash::iterator i = _volumeHash.find( key );
+    if( i == _volumeHash.end() )
+        return;
+
+    glDeleteTextures( 1, &i->second.volume );
+    _volumeHash.erase( i );
+}
+
+
+void RawVolumeModel::_releaseOldestVolumePart()
+{
+    VolumeHash::iterator oldest = _volumeHash.begin();
+    for( VolumeHash::iterator i = _volumeHash.begin();
+         i != _volumeHash.end(); ++i )
+    {
+        if( i->second.lastUsed < oldest->second.lastUsed )
+            oldest = i;
+    }
+    if( oldest == _volumeHash.end( ))
         return;
 
-    _volumeHash.erase( key );
+    glDeleteTextures( 1, &oldest->second.volume );
+    _volumeHash.erase( oldest );
 }
 
 
@@ -195,62 +323,194 @@ static uint32_t calcMinPow2( uint32_t size )
 }
 
 
-/** Reading requested part of volume and derivatives from data file
+/** Slices and texture size of a range at the given resolution level
 */
-bool RawVolumeModel::_createVolumeTexture(        GLuint&    volume,
-                                                  DataInTextureDimensions& TD,
-                                            const eq::Range& range    )
+void RawVolumeModel::_getSlab( const uint32_t  level,
+                               const eq::Range& range,
+                                     Slab&      slab  ) const
 {
-    const uint32_t w = _w;
-    const uint32_t h = _h;
-    const uint32_t d = _d;
-    const uint32_t bytes = _hasDerivatives ? 4 : 1;
-
     const int32_t bwStart = 2; //border width from left
     const int32_t bwEnd   = 2; //border width from right
 
-    const int32_t s =
-            clip<int32_t>( static_cast< int32_t >( d*range.start ), 0, d-1 );
+    slab.w = getLevelSize( _w, level );
+    slab.h = getLevelSize( _h, level );
+    slab.d = getLevelSize( _d, level );
 
-    const int32_t e =
-            clip<int32_t>( static_cast< int32_t >( d*range.end-1 ), 0, d-1 );
+    const int32_t d = slab.d;
+    slab.s = clip<int32_t>( static_cast< int32_t >( d*range.start ), 0, d-1 );
+    slab.e = clip<int32_t>( static_cast< int32_t >( d*range.end-1 ), 0, d-1 );
 
-    const uint32_t start =
-                static_cast<uint32_t>( clip<int32_t>( s-bwStart, 0, d-1 ) );
+    slab.start = static_cast<uint32_t>( clip<int32_t>( slab.s-bwStart, 0,d-1 ));
+    slab.end   = static_cast<uint32_t>( clip<int32_t>( slab.e+bwEnd  , 0,d-1 ));
 
-    const uint32_t end   =
-                static_cast<uint32_t>( clip<int32_t>( e+bwEnd  , 0, d-1 ) );
+    slab.tW = calcMinPow2( slab.w );
+    slab.tH = calcMinPow2( slab.h );
+    slab.tD = calcMinPow2( slab.end - slab.start + 1 );
+}
 
-    const uint32_t depth = end-start+1;
 
-    _tW = calcMinPow2( w );
-    _tH = calcMinPow2( h );
-    _tD = calcMinPow2( depth );
+/** The finest resolution level which fits into the texture limits
+*/
+uint32_t RawVolumeModel::_getBestLevel( const eq::Range& range ) const
+{
+    const uint32_t bytes = _hasDerivatives ? 4 : 1;
+    GLint maxSize = 0;
+    glGetIntegerv( GL_MAX_3D_TEXTURE_SIZE, &maxSize );
+
+    const uint32_t levels = _bricks ? _bricks->getLevels() : 1;
+    for( uint32_t level = 0; ; ++level )
+    {
+        Slab slab;
+        _getSlab( level, range, slab );
+
+        const uint64_t size = uint64_t( slab.tW ) * slab.tH * slab.tD * bytes;
+        const uint32_t maxDim = LB_MAX( slab.tW, LB_MAX( slab.tH, slab.tD ));
+        if( level + 1 >= levels || ( size <= maxTextureSize &&
+                          ( maxSize <= 0 || maxDim <= uint32_t( maxSize ))))
+        {
+            return level;
+        }
+    }
+}
+
+
+/** Reading requested part of volume and derivatives from data file. While
+    the bricks of the best level are loaded in the background, the finest
+    cached level is used to not block rendering.
+*/
+bool RawVolumeModel::_createVolumeTexture( VolumePart& part,
+                                           const eq::Range& range )
+{
+    LBASSERT( _glewContext );
+    const uint32_t bytes = _hasDerivatives ? 4 : 1;
+    DataInTextureDimensions& TD = part.TD;
+
+    part.bestLevel = _getBestLevel( range );
+    uint32_t level = part.bestLevel;
+    Slab slab;
+    _getSlab( level, range, slab );
+
+    if( _bricks )
+    {
+        const uint32_t levels = _bricks->getLevels();
+        if( !_bricks->isAvailable( level, slab.start, slab.end ))
+        {
+            _bricks->prefetch( level, slab.start, slab.end );
+
+            // the coarsest level is small enough to be read right away
+            while( level + 1 < levels )
+            {
+                _getSlab( ++level, range, slab );
+                if( _bricks->isAvailable( level, slab.start, slab.end ))
+                    break;
+            }
+        }
+    }
+    part.level = level;
+
+    const uint32_t w = slab.w;
+    const uint32_t h = slab.h;
+    const uint32_t d = slab.d;
+    const int32_t  s = slab.s;
+    const int32_t  e = slab.e;
+    const uint32_t start = slab.start;
+    const uint32_t end   = slab.end;
+    const uint32_t depth = end-start+1;
+    const uint32_t tW = slab.tW;
+    const uint32_t tH = slab.tH;
+    const uint32_t tD = slab.tD;
+    const int32_t  bwStart = 2;
 
     //texture scaling coefficients
-    TD.W  = static_cast<float>( w     ) / static_cast<float>( _tW );
-    TD.H  = static_cast<float>( h     ) / static_cast<float>( _tH );
-    TD.D  = static_cast<float>( e-s+1 ) / static_cast<float>( _tD );
+    TD.W  = static_cast<float>( w     ) / static_cast<float>( tW );
+    TD.H  = static_cast<float>( h     ) / static_cast<float>( tH );
+    TD.D  = static_cast<float>( e-s+1 ) / static_cast<float>( tD );
     TD.D /= range.end>range.start ? (range.end-range.start) : 1.0f;
 
     // Shift coefficient and left border in texture for depth
     TD.Do = range.start;
-    TD.Db = range.start > 0.0001 ? bwStart / static_cast<float>(_tD) : 0;
+    TD.Db = range.start > 0.0001 ? bwStart / static_cast<float>(tD) : 0;
 
     LBLOG( eq::LOG_CUSTOM )
             << "==============================================="   << std::endl
-            << " w: "  << w << " " << _tW
-            << " h: "  << h << " " << _tH
-            << " d: "  << d << " " << depth << " " << _tD           << std::endl
-            << " r: "  << _resolution                              << std::endl
+            << " w: "  << w << " " << tW
+            << " h: "  << h << " " << tH
+            << " d: "  << d << " " << depth << " " << tD           << std::endl
+            << " r: "  << _resolution << " l: " << level           << std::endl
             << " ws: " << TD.W  << " hs: " << TD.H  << " wd: " << TD.D 
             << " Do: " << TD.Do << " Db: " << TD.Db                << std::endl
             << " s= "  << start << " e= "  << end                  << std::endl;
 
     // Reading of requested part of a volume
-    std::vector<uint8_t> data( _tW*_tH*_tD*bytes, 0 );
+    std::vector<uint8_t> data( size_t( tW ) * tH * tD * bytes, 0 );
+    if( _bricks )
+    {
+        if( !_bricks->readSlices( level, start, end, &data[0], tW * bytes,
+                                  tW * tH * bytes ))
+        {
+            return false;
+        }
+    }
+    else if( !_readRawSlices( data, slab ))
+        return false;
+
+    if( _hasDerivatives )
+    {
+        part.voxelSize.W  = 1.f;
+        part.voxelSize.H  = 1.f;
+        part.voxelSize.D  = 1.f;
+    }else
+    {
+        part.voxelSize.W  = 1.f / tW;
+        part.voxelSize.H  = 1.f / tH;
+        part.voxelSize.D  = 1.f / tD;
+    }
+
+    // create 3D texture, or update it with a finer level
+    if( part.volume == 0 )
+    {
+        glGenTextures( 1, &part.volume );
+        LBLOG( eq::LOG_CUSTOM ) << "generated texture: " << part.volume
+                                << std::endl;
+    }
+    glBindTexture(GL_TEXTURE_3D, part.volume);
+
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_S    , GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T    , GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_R    , GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR        );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR        );
+
+    if( _hasDerivatives )
+    {
+        glTexImage3D(   GL_TEXTURE_3D,
+                        0, GL_RGBA, tW, tH, tD,
+                        0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)(&data[0]) );
+    }else
+    {
+        glTexImage3D(   GL_TEXTURE_3D,
+                        0, GL_ALPHA, tW, tH, tD,
+                        0, GL_ALPHA, GL_UNSIGNED_BYTE, (GLvoid*)(&data[0]) );
+    }
+
+    return true;
+}
+
+
+/** Reading slices of the full resolution volume from the raw data file
+*/
+bool RawVolumeModel::_readRawSlices( std::vector< uint8_t >& data,
+                                     const Slab& slab )
+{
+    const uint32_t w = _w;
+    const uint32_t h = _h;
+    const uint32_t tW = slab.tW;
+    const uint32_t tH = slab.tH;
+    const uint32_t start = slab.start;
+    const uint32_t depth = slab.end - slab.start + 1;
+    const uint32_t bytes = _hasDerivatives ? 4 : 1;
     const uint32_t  wh4 =   w *   h * bytes;
-    const uint32_t tWH4 = _tW * _tH * bytes;
+    const uint32_t tWH4 = tW * tH * bytes;
 
     std::ifstream file ( _filename.c_str(), std::ifstream::in |
                          std::ifstream::binary | std::ifstream::ate );
@@ -263,11 +523,11 @@ bool RawVolumeModel::_createVolumeTexture(        GLuint&    volume,
 
     file.seekg( wh4*start, std::ios::beg );
 
-    if( w==_tW && h==_tH ) // width and height are power of 2
+    if( w==tW && h==tH ) // width and height are power of 2
     {
         file.read( (char*)( &data[0] ), wh4*depth );
     }
-    else if( w==_tW )     // only width is power of 2
+    else if( w==tW )     // only width is power of 2
     {
         for( uint32_t i=0; i<depth; i++ )
             file.read( (char*)( &data[i*tWH4] ), wh4 );
@@ -275,7 +535,7 @@ bool RawVolumeModel::_createVolumeTexture(        GLuint&    volume,
     else
     {               // nor width nor heigh is power of 2
         const uint32_t   w4 =   w * bytes;
-        const uint32_t  tW4 = _tW * bytes;
+        const uint32_t  tW4 =  tW * bytes;
 
         for( uint32_t i=0; i<depth; i++ )
             for( uint32_t j=0; j<h; j++ )
@@ -283,31 +543,6 @@ bool RawVolumeModel::_createVolumeTexture(        GLuint&    volume,
     }
 
     file.close();
-
-    LBASSERT( _glewContext );
-    // create 3D texture
-    glGenTextures( 1, &volume );
-    LBLOG( eq::LOG_CUSTOM ) << "generated texture: " << volume << std::endl;
-    glBindTexture(GL_TEXTURE_3D, volume);
-
-    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_S    , GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T    , GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_R    , GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR        );
-    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR        );
-
-    if( _hasDerivatives )
-    {
-        glTexImage3D(   GL_TEXTURE_3D,
-                        0, GL_RGBA, _tW, _tH, _tD,
-                        0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)(&data[0]) );
-    }else
-    {
-        glTexImage3D(   GL_TEXTURE_3D,
-                        0, GL_ALPHA, _tW, _tH, _tD,
-                        0, GL_ALPHA, GL_UNSIGNED_BYTE, (GLvoid*)(&data[0]) );
-    }
-
     return true;
 }
 
@@ -428,80 +663,4 @@ static bool readTransferFunction( FILE* file,  std::vector<uint8_t>& TF )
 }
 
 
-static GLuint createPreintegrationTable( const uint8_t *Table )
-{
-    LBLOG( eq::LOG_CUSTOM ) << "Calculating preintegration table" << std::endl;
-
-    double rInt[256]; rInt[0] = 0.;
-    double gInt[256]; gInt[0] = 0.;
-    double bInt[256]; bInt[0] = 0.;
-    double aInt[256]; aInt[0] = 0.;
-
-    // Creating SAT (Summed Area Tables) from averaged neighbouring RGBA values
-    for( int i=1; i<256; i++ )
-    {
-        // average Alpha from two neighbouring TF values
-        const double tauc =   ( Table[(i-1)*4+3] + Table[i*4+3] ) / 2. / 255.;
-
-        // SAT of average RGBs from two neighbouring TF values 
-        // multiplied with Alpha
-        rInt[i] = rInt[i-1] + ( Table[(i-1)*4+0] + Table[i*4+0] )/2.*tauc;
-        gInt[i] = gInt[i-1] + ( Table[(i-1)*4+1] + Table[i*4+1] )/2.*tauc;
-        bInt[i] = bInt[i-1] + ( Table[(i-1)*4+2] + Table[i*4+2] )/2.*tauc;
-
-        // SAT of average Alpha values
-        aInt[i] = aInt[i-1] + tauc;
-    }
-
-    std::vector<GLubyte> lookupImg( 256*256*4, 255 ); // Preint Texture
-
-    int lookupindex=0;
-
-    for( int sb=0; sb<256; sb++ )
-    {
-        for( int sf=0; sf<256; sf++ )
-        {
-            int smin, smax;
-            if( sb<sf ) { smin=sb; smax=sf; }
-            else        { smin=sf; smax=sb; }
-
-            double rcol, gcol, bcol, acol;
-            if( smax != smin )
-            {
-                const double factor = 1. / (double)(smax-smin);
-                rcol =       ( rInt[smax] - rInt[smin] ) * factor;
-                gcol =       ( gInt[smax] - gInt[smin] ) * factor;
-                bcol =       ( bInt[smax] - bInt[smin] ) * factor;
-                acol = exp( -( aInt[smax] - aInt[smin] ) * factor) * 255.;
-            } else
-            {
-                const int    index  = smin*4;
-                const double factor = 1./255.;
-                rcol =       Table[index+0] * Table[index+3] * factor;
-                gcol =       Table[index+1] * Table[index+3] * factor;
-                bcol =       Table[index+2] * Table[index+3] * factor;
-                acol = exp(                  -Table[index+3] * factor ) * 256.;
-            }
-            lookupImg[lookupindex++] = clip( static_cast<int>(rcol), 0, 255 );
-            lookupImg[lookupindex++] = clip( static_cast<int>(gcol), 0, 255 );
-            lookupImg[lookupindex++] = clip( static_cast<int>(bcol), 0, 255 );
-            lookupImg[lookupindex++] = clip( static_cast<int>(acol), 0, 255 );
-        }
-    }
-
-    GLuint preintName = 0;
-    glGenTextures( 1, &preintName );
-    glBindTexture( GL_TEXTURE_2D, preintName );
-    glTexImage2D(  GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0, 
-                   GL_RGBA, GL_UNSIGNED_BYTE, &lookupImg[0] );
-
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR        );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR        );
-
-    return preintName;
-}
-
-
 }
@@ -29,6 +29,9 @@
 #ifndef EVOLVE_RAW_VOL_MODEL_H
 #define EVOLVE_RAW_VOL_MODEL_H
 
+#include "brickStore.h"
+#include "preintegrationTable.h"
+
 #include <eq/eq.h>
 
 namespace eVolve
@@ -82,60 +85,109 @@ namespace eVolve
     {
     public:
         RawVolumeModel( const std::string& filename );
+        ~RawVolumeModel();
 
         bool loadHeader( const float brightness, const float alpha );
 
-        bool getVolumeInfo( VolumeInfo& info, const eq::Range& range );
+        /** Get the texture of a range. With bricked data, a coarser cached
+            level is used until the bricks of the range are loaded. The
+            channel identifies the range movement used for prefetching. */
+        bool getVolumeInfo( VolumeInfo& info, const eq::Range& range,
+                            const eq::uint128_t& channelID );
 
         void releaseVolumeInfo( const eq::Range& range );
 
+        /** Change the 256 RGBA transfer function values, e.g., interactively.
+            The pre-integration table is updated in the background. */
+        void setTransferFunction( const std::vector< uint8_t >& TF );
+
+        /** Make the transfer function transparent below the given value. */
+        void setThreshold( const uint8_t threshold );
+
         const std::string&   getFileName()      const { return _filename;    };
               uint32_t       getResolution()    const { return _resolution;  };
         const VolumeScaling& getVolumeScaling() const { return _volScaling;  };
 
+        struct Statistics
+        {
+            uint64_t textureHits;   //!< ranges found in the texture cache
+            uint64_t textureMisses; //!< ranges loaded into new textures
+            uint64_t refinements;   //!< textures replaced by finer ones
+            BrickStore::Statistics bricks; //!< of the shared brick store
+        };
+
+        /** @return the current texture and brick cache statistics. */
+        Statistics getStatistics() const;
+
         void glewSetContext( const GLEWContext* context )
             { _glewContext = context; }
 
         const GLEWContext* glewGetContext() const { return _glewContext; }
 
-    protected:
-
-        bool _createVolumeTexture(    GLuint&                  volume,
-                                      DataInTextureDimensions& TD,
-                                const eq::Range&               range );
-
     private:
         bool _lFailed( char* msg )
             { LBERROR << msg << std::endl; return false; }
 
+        void _releaseOldestVolumePart();
+
         struct VolumePart
         {
             GLuint                  volume; //!< 3D texture ID
             DataInTextureDimensions TD;     //!< Data dimensions within volume
+            VolumeScaling           voxelSize; //!< Relative voxel size
+            uint32_t                level;  //!< resolution level of texture
+            uint32_t                bestLevel; //!< finest level fitting GPU
+            uint64_t                lastUsed;  //!< for LRU eviction
+        };
+
+        /** Slices of a range at one resolution level */
+        struct Slab
+        {
+            uint32_t w, h, d;       //!< volume size at the level
+            int32_t  s, e;          //!< first and last slice of the range
+            uint32_t start, end;    //!< first and last slice with borders
+            uint32_t tW, tH, tD;    //!< texture size
         };
 
-        stde::hash_map< int32_t, VolumePart > _volumeHash; //!< 3D textures info
+        void _getSlab( const uint32_t level, const eq::Range& range,
+                       Slab& slab ) const;
+        uint32_t _getBestLevel( const eq::Range& range ) const;
+        bool _createVolumeTexture( VolumePart& part, const eq::Range& range );
+        void _prefetch( const eq::Range& range, const uint32_t level,
+                        const eq::uint128_t& channelID );
+        bool _readRawSlices( std::vector< uint8_t >& data, const Slab& slab );
+
+        typedef stde::hash_map< int32_t, VolumePart > VolumeHash;
+        VolumeHash   _volumeHash;       //!< 3D textures info
+        BrickStore*  _bricks;           //!< shared bricked data, if available
+        typedef std::map< eq::uint128_t, eq::Range > RangeMap;
+        RangeMap     _lastRanges;       //!< previous range per channel
 
         bool         _headerLoaded;     //!< header is loaded successfully
         std::string  _filename;         //!< name of volume data file
 
-        GLuint       _preintName;       //!< preintegration table texture
+        PreintegrationTable _preint;    //!< preintegration table texture
 
         uint32_t     _w;                //!< volume width
         uint32_t     _h;                //!< volume height
         uint32_t     _d;                //!< volume depth
-        uint32_t     _tW;               //!< volume texture width
-        uint32_t     _tH;               //!< volume texture height
-        uint32_t     _tD;               //!< volume texture depth
         uint32_t     _resolution;       //!< max( _w, _h, _d ) of a model
 
         VolumeScaling _volScaling;      //!< Proportions of volume
 
         std::vector< uint8_t >  _TF;    //!< Transfer function
+        uint8_t      _threshold;        //!< transparent values below
+
+        void _updateTransferFunction();
 
         bool _hasDerivatives;           //!< true if raw+der used
 
         const GLEWContext*   _glewContext;    //!< OpenGL function table
+
+        uint64_t     _useCount;         //!< getVolumeInfo() calls, for LRU
+        uint64_t     _textureHits;      //!< ranges found in _volumeHash
+        uint64_t     _textureMisses;    //!< ranges loaded into new textures
+        uint64_t     _refinements;      //!< textures replaced by finer ones
     };
 
 }
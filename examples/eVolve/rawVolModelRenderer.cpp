@@ -148,6 +148,7 @@ void RawVolumeModelRenderer::_putVolumeDataToShader(
 bool RawVolumeModelRenderer::render
 (
     const eq::Range&      range,
+    const eq::uint128_t&  channelID,
     const eq::Matrix4d&   modelviewM,
     const eq::Matrix3d&   modelviewITM,
     const eq::Matrix4f&   invRotationM,
@@ -157,7 +158,7 @@ bool RawVolumeModelRenderer::render
 {
     VolumeInfo volumeInfo;
 
-    if( !_rawModel.getVolumeInfo( volumeInfo, range ))
+    if( !_rawModel.getVolumeInfo( volumeInfo, range, channelID ))
     {
         LBERROR << "Can't get volume data" << std::endl;
         return false;
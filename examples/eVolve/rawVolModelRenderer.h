@@ -53,6 +53,11 @@ namespace eVolve
             return _rawModel.getVolumeScaling();
         }
 
+        RawVolumeModel::Statistics getStatistics() const
+        {
+            return _rawModel.getStatistics();
+        }
+
         void glewSetContext( const GLEWContext* context )
         {
             _glewContext = context;
@@ -61,6 +66,7 @@ namespace eVolve
 
 
         bool render( const eq::Range&     range,
+                     const eq::uint128_t& channelID,
                      const eq::Matrix4d&  modelviewM,
                      const eq::Matrix3d&  modelviewITM,
                      const eq::Matrix4f&  invRotationM,
@@ -69,6 +75,8 @@ namespace eVolve
 
         void setPrecision( const uint32_t precision ){ _precision = precision; }
         void setOrtho( const uint32_t ortho )        { _ortho = ortho; }
+        void setThreshold( const uint8_t threshold )
+            { _rawModel.setThreshold( threshold ); }
 
         const GLEWContext* glewGetContext() { return _glewContext; }
         bool loadShaders();
@@ -0,0 +1,94 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVOLVE_VOLUME_BRICKS_H
+#define EVOLVE_VOLUME_BRICKS_H
+
+#ifndef _MSC_VER
+#  include <stdint.h>
+#endif
+#include <string>
+
+namespace eVolve
+{
+    /** Header of a bricked volume file, written by eVolveConverter.
+
+        The file holds a resolution pyramid of a raw volume in native byte
+        order. Level 0 has the full resolution, each following level halves
+        all dimensions. The levels are stored one after another, each in the
+        raw voxel order, and are divided into bricks of brickDepth slices
+        since eVolve decomposes the volume only along the depth.
+    */
+    struct BrickHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t w;          //!< width at level 0
+        uint32_t h;          //!< height at level 0
+        uint32_t d;          //!< depth at level 0
+        uint32_t bytes;      //!< bytes per voxel, 1 for raw, 4 for raw+der
+        uint32_t brickDepth; //!< number of slices per brick
+        uint32_t levels;     //!< number of resolution levels
+    };
+
+    const uint32_t BRICK_MAGIC   = 0x65566272; // 'eVbr'
+    const uint32_t BRICK_VERSION = 1;
+
+    /** @return the size of a dimension at the given resolution level. */
+    inline uint32_t getLevelSize( const uint32_t size, const uint32_t level )
+    {
+        const uint32_t result = ( size + ( 1u << level ) - 1 ) >> level;
+        return result > 0 ? result : 1;
+    }
+
+    /** @return the size of one slice at the given level in bytes. */
+    inline uint64_t getSliceSize( const BrickHeader& header,
+                                  const uint32_t level )
+    {
+        return uint64_t( getLevelSize( header.w, level )) *
+               getLevelSize( header.h, level ) * header.bytes;
+    }
+
+    /** @return the file offset of the given level. */
+    inline uint64_t getLevelOffset( const BrickHeader& header,
+                                    const uint32_t level )
+    {
+        uint64_t offset = sizeof( BrickHeader );
+        for( uint32_t i = 0; i < level; ++i )
+            offset += getSliceSize( header, i ) * getLevelSize( header.d, i );
+        return offset;
+    }
+
+    /** @return the name of the bricked file belonging to a raw file. */
+    inline std::string getBrickFilename( const std::string& rawFilename )
+    {
+        return rawFilename + ".bricks";
+    }
+}
+
+#endif // EVOLVE_VOLUME_BRICKS_H
@@ -613,6 +613,11 @@ void Channel::_drawModel( const Model* scene )
     state.setProjectionModelViewMatrix( projection * view * model );
     state.setRange( &getRange().start);
 
+    // draw simplified subtrees whose error is below one pixel
+    const eq::PixelViewport& pvp = getPixelViewport();
+    state.setPixelScale( projection( 1, 1 ) * float( pvp.h ) * .5f );
+    state.setMaxScreenError( frameData.useLOD() ? 1.f : 0.f );
+
     const eq::Pipe* pipe = getPipe();
     const GLuint program = state.getProgram( pipe );
     if( program != VertexBufferState::INVALID )
@@ -671,6 +671,11 @@ bool Config::_handleKeyEvent( const eq::KeyEvent& event )
             _frameData.toggleWireframe();
             return true;
 
+        case 'b':
+        case 'B':
+            _frameData.toggleLOD();
+            return true;
+
         case 'r':
         case 'R':
             _frameData.toggleRenderMode();
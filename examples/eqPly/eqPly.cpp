@@ -54,11 +54,12 @@ static const std::string _help(
                                                                             ) +
     std::string( "\t\ts:                         Toggle statistics overlay\n" ) +
     std::string( "\t\tw:                         Toggle wireframe mode\n" ) +
+    std::string( "\t\tb:                         Toggle simplified rendering of distant geometry\n" ) +
     std::string( "\t\td:                         Toggle color demo mode\n" ) +
     std::string( "\t\ti:                         Toggle usage of idle anti-aliasing\n" ) +
     std::string( "\t\tq, Q:                      Adjust non-idle image quality\n" ) +
     std::string( "\t\tn:                         Toggle navigation mode (trackball, walk)\n" ) +
-    std::string( "\t\tr:                         Switch rendering mode (display list, VBO, immediate)\n" ) +
+    std::string( "\t\tr:                         Switch rendering mode (display list, VBO, multi-draw VBO, immediate)\n" ) +
     std::string( "\t\tu:                         Toggle image compression\n" ) +
     std::string( "\t\tc:                         Switch active canvas\n" ) +
     std::string( "\t\tv:                         Switch active view\n" ) +
@@ -43,6 +43,7 @@ FrameData::FrameData()
         , _statistics( false )
         , _help( false )
         , _wireframe( false )
+        , _lod( true )
         , _pilotMode( false )
         , _idle( false )
         , _compression( true )
@@ -57,7 +58,7 @@ void FrameData::serialize( co::DataOStream& os, const uint64_t dirtyBits )
         os << _position << _rotation << _modelRotation;
     if( dirtyBits & DIRTY_FLAGS )
         os << _modelID << _renderMode << _colorMode << _quality << _ortho
-           << _statistics << _help << _wireframe << _pilotMode << _idle
+           << _statistics << _help << _wireframe << _lod << _pilotMode << _idle
            << _compression;
     if( dirtyBits & DIRTY_VIEW )
         os << _currentViewID;
@@ -72,7 +73,7 @@ void FrameData::deserialize( co::DataIStream& is, const uint64_t dirtyBits )
         is >> _position >> _rotation >> _modelRotation;
     if( dirtyBits & DIRTY_FLAGS )
         is >> _modelID >> _renderMode >> _colorMode >> _quality >> _ortho
-           >> _statistics >> _help >> _wireframe >> _pilotMode >> _idle
+           >> _statistics >> _help >> _wireframe >> _lod >> _pilotMode >> _idle
            >> _compression;
     if( dirtyBits & DIRTY_VIEW )
         is >> _currentViewID;
@@ -134,6 +135,12 @@ void FrameData::toggleWireframe()
     setDirty( DIRTY_FLAGS );
 }
 
+void FrameData::toggleLOD()
+{
+    _lod = !_lod;
+    setDirty( DIRTY_FLAGS );
+}
+
 void FrameData::toggleColorMode()
 {
     _colorMode = static_cast< ColorMode >(( _colorMode + 1) % COLOR_ALL );
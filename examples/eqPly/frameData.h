@@ -63,6 +63,7 @@ namespace eqPly
         void toggleStatistics();
         void toggleHelp();
         void toggleWireframe();
+        void toggleLOD();
         void toggleColorMode();
         void adjustQuality( const float delta );
         void togglePilotMode();
@@ -76,6 +77,7 @@ namespace eqPly
         bool useStatistics() const { return _statistics; }
         bool showHelp() const { return _help; }
         bool useWireframe() const { return _wireframe; }
+        bool useLOD() const { return _lod; }
         bool usePilotMode() const { return _pilotMode; }
         bool isIdle() const { return _idle; }
         mesh::RenderMode getRenderMode() const { return _renderMode; }
@@ -143,6 +145,7 @@ namespace eqPly
         bool             _statistics;
         bool             _help;
         bool             _wireframe;
+        bool             _lod;
         bool             _pilotMode;
         bool             _idle;
         bool             _compression;
@@ -65,6 +65,11 @@
 #include <iostream>
 #include <string>
 
+// OpenMP 3.0 tasks are used to build kd-subtrees concurrently
+#if defined( _OPENMP ) && _OPENMP >= 200805
+#  define MESH_USE_OMP_TASKS
+#endif
+
 namespace mesh
 {
     // basic type definitions
@@ -132,7 +137,7 @@ namespace mesh
     const Index             LEAF_SIZE( 21845 );
 
     // binary mesh file version, increment if changing the file format
-    const unsigned short    FILE_VERSION ( 0x0118 );
+    const unsigned short    FILE_VERSION ( 0x011b );
 
     // enumeration for the sort axis
     enum Axis
@@ -163,13 +168,16 @@ namespace mesh
         RENDER_MODE_IMMEDIATE = 0,
         RENDER_MODE_DISPLAY_LIST,
         RENDER_MODE_BUFFER_OBJECT,
+        RENDER_MODE_MULTI_DRAW, //!< batched VBO arenas
         RENDER_MODE_ALL // must be last
     };
     inline std::ostream& operator << ( std::ostream& os, const RenderMode mode )
     {
         os << ( mode == RENDER_MODE_IMMEDIATE     ? "immediate mode" :
                 mode == RENDER_MODE_DISPLAY_LIST  ? "display list mode" :
-                mode == RENDER_MODE_BUFFER_OBJECT ? "VBO mode" : "ERROR" );
+                mode == RENDER_MODE_BUFFER_OBJECT ? "VBO mode" :
+                mode == RENDER_MODE_MULTI_DRAW    ? "multi-draw VBO mode" :
+                                                    "ERROR" );
         return os;
     }
 
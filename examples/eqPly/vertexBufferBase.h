@@ -37,10 +37,11 @@
 
 #include "typedefs.h"
 #include <fstream>
+#include <vector>
 
 namespace eqPly
 {
-    class VertexBufferDist;
+    class VertexBufferBlob;
 }
 
 namespace mesh 
@@ -49,6 +50,11 @@ namespace mesh
     class VertexData;
     class VertexBufferData;
     class VertexBufferState;
+    class VertexBufferLeaf;
+    class VertexBufferNode;
+
+    typedef std::vector< VertexBufferLeaf* > VertexBufferLeaves;
+    typedef std::vector< VertexBufferNode* > VertexBufferNodes;
         
     /*  The abstract base class for all kinds of kd-tree nodes.  */
     class VertexBufferBase
@@ -68,6 +74,11 @@ namespace mesh
         virtual const VertexBufferBase* getLeft() const { return 0; }
         virtual const VertexBufferBase* getRight() const { return 0; }
 
+        /*  The simplified representation of the subtree, if any, and its
+            geometric error in object space.  */
+        virtual const VertexBufferBase* getLOD() const { return 0; }
+        virtual float getLODError() const { return 0.f; }
+
         virtual const BoundingSphere& updateBoundingSphere() = 0;
 
     protected:
@@ -77,11 +88,12 @@ namespace mesh
             _range[1] = 1.0f;
         }
         
-        virtual void toStream( std::ostream& os )
+        virtual void toStream( std::ostream& os ) const
         {
-            os.write( reinterpret_cast< char* >( &_boundingSphere ), 
+            os.write( reinterpret_cast< const char* >( &_boundingSphere ), 
                       sizeof( BoundingSphere ) );
-            os.write( reinterpret_cast< char* >( &_range ), sizeof( Range ) );
+            os.write( reinterpret_cast< const char* >( &_range ),
+                      sizeof( Range ) );
         }
         
         virtual void fromMemory( char** addr, VertexBufferData& globalData )
@@ -98,10 +110,15 @@ namespace mesh
                                 VertexBufferData& globalData ) = 0;
         
         virtual void updateRange() = 0;
+
+        /*  Append all leaves of the subtree in tree order.  */
+        virtual void collectLeaves( VertexBufferLeaves& leaves ) = 0;
+
+        /*  Append all inner nodes of the subtree in tree order.  */
+        virtual void collectNodes( VertexBufferNodes& nodes ) {}
         
         BoundingSphere  _boundingSphere;
         Range           _range;
-        friend class eqPly::VertexBufferDist;
 
     private:
     };
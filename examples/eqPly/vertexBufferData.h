@@ -38,69 +38,67 @@
 
 namespace mesh 
 {    
-    /** Holds the final kd-tree data, sorted and reindexed.  */
-    class VertexBufferData
+    /*  An array which either owns its elements or refers to read-only memory,
+        e.g., the memory-mapped binary kd-tree file.  */
+    template< class T > class DataArray
     {
     public:
-        void clear()
+        DataArray() : _data( 0 ), _size( 0 ) {}
+
+        void resize( const size_t size )
         {
-            vertices.clear();
-            colors.clear();
-            normals.clear();
-            indices.clear();
+            _storage.resize( size );
+            _data = size > 0 ? &_storage[0] : 0;
+            _size = size;
         }
-        
-        /*  Write the vectors' sizes and contents to the given stream.  */
-        void toStream( std::ostream& os )
+
+        void clear()
         {
-            writeVector( os, vertices );
-            writeVector( os, colors );
-            writeVector( os, normals );
-            writeVector( os, indices );
+            std::vector< T >().swap( _storage );
+            _data = 0;
+            _size = 0;
         }
-        
-        /*  Read the vectors' sizes and contents from the given MMF address.  */
-        void fromMemory( char** addr )
+
+        /*  Refer to external memory, which has to stay valid until cleared. */
+        void map( const T* data, const size_t size )
         {
             clear();
-            readVector( addr, vertices );
-            readVector( addr, colors );
-            readVector( addr, normals );
-            readVector( addr, indices );
+            _data = const_cast< T* >( data );
+            _size = size;
         }
-        
-        std::vector< Vertex >       vertices;
-        std::vector< Color >        colors;
-        std::vector< Normal >       normals;
-        std::vector< ShortIndex >   indices;
-        
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        bool isMapped() const { return _data && _storage.empty(); }
+
+        T& operator[]( const size_t i ) { return _data[i]; }
+        const T& operator[]( const size_t i ) const { return _data[i]; }
+
     private:
-        /*  Helper function to write a vector to output stream.  */
-        template< class T >
-        void writeVector( std::ostream& os, std::vector< T >& v )
+        std::vector< T > _storage;
+        T*               _data;
+        size_t           _size;
+
+        DataArray( const DataArray& );
+        DataArray& operator = ( const DataArray& );
+    };
+
+    /** Holds the final kd-tree data, sorted and reindexed.  */
+    class VertexBufferData
+    {
+    public:
+        void clear()
         {
-            size_t length = v.size();
-            os.write( reinterpret_cast< char* >( &length ), 
-                      sizeof( size_t ) );
-            if( length > 0 )
-                os.write( reinterpret_cast< char* >( &v[0] ), 
-                          length * sizeof( T ) );
+            vertices.clear();
+            colors.clear();
+            normals.clear();
+            indices.clear();
         }
         
-        /*  Helper function to read a vector from the MMF address.  */
-        template< class T >
-        void readVector( char** addr, std::vector< T >& v )
-        {
-            size_t length;
-            memRead( reinterpret_cast< char* >( &length ), addr, 
-                     sizeof( size_t ) );
-            if( length > 0 )
-            {
-                v.resize( length );
-                memRead( reinterpret_cast< char* >( &v[0] ), addr, 
-                         length * sizeof( T ) );
-            }
-        }
+        DataArray< Vertex >       vertices;
+        DataArray< Color >        colors;
+        DataArray< Normal >       normals;
+        DataArray< ShortIndex >   indices;
     };
     
     
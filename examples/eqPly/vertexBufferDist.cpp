@@ -27,74 +27,109 @@
  * POSSIBILITY OF SUCH DAMAGE.
   
  *
- * co::Object to distribute a model. Has a VertexBufferBase node.
+ * co::Objects to distribute a model as one binary representation.
  */
 
 #include "vertexBufferDist.h"
 
-#include "vertexBufferLeaf.h"
-
 namespace eqPly 
 {
-
-VertexBufferDist::VertexBufferDist()
-        : _root( 0 )
-        , _node( 0 )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( false )
-{}
-
-VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root )
-        : _root( root )
-        , _node( root )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( true )
+namespace
 {
-    if( root->getLeft( ))
-        _left = new VertexBufferDist( root, root->getLeft( ));
+/*  Send a data array of the model in place, with its offset in the binary
+    representation.  */
+template< class T >
+void _sendArray( co::DataOStream& os, const mesh::DataArray< T >& array,
+                 const uint64_t offset )
+{
+    const uint64_t size = array.size() * sizeof( T );
+    os << offset << size;
+    if( size > 0 )
+        os << co::Array< const char >(
+            reinterpret_cast< const char* >( &array[0] ), size_t( size ));
+}
+}
 
-    if( root->getRight( ))
-        _right = new VertexBufferDist( root, root->getRight( ));
+void VertexBufferBlob::getInstanceData( co::DataOStream& os )
+{
+    LBASSERT( _root );
+    lunchbox::Clock clock;
+
+    // only the header and the nodes are serialized, the arrays are not copied
+    std::string head;
+    uint64_t offsets[4];
+    uint32_t checksum = _root->getChecksum();
+    const uint64_t size = _root->_getHead( head, offsets, checksum );
+    const mesh::VertexBufferData& data = _root->_data;
+
+    os << size << head;
+    _sendArray( os, data.vertices, offsets[0] );
+    _sendArray( os, data.colors, offsets[1] );
+    _sendArray( os, data.normals, offsets[2] );
+    _sendArray( os, data.indices, offsets[3] );
+    LBINFO << "Serialized " << _root->getName() << ", " << size
+           << " bytes in " << clock.getTimef() << " ms" << std::endl;
 }
 
-VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root, 
-                                    const mesh::VertexBufferBase* node )
-        : _root( root )
-        , _node( node )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( false )
+/*  Reassemble the binary representation, the padding between the arrays
+    stays zero.  */
+void VertexBufferBlob::applyInstanceData( co::DataIStream& is )
 {
-    if( !node )
-        return;
+    uint64_t size = 0;
+    std::string head;
+    is >> size >> head;
 
-    if( node->getLeft( ))
-        _left = new VertexBufferDist( root, node->getLeft( ));
+    _data.clear();
+    _data.resize( size_t( size ));
+    bool valid = head.size() <= size;
+    if( valid && !head.empty( ))
+        memcpy( &_data[0], head.data(), head.size( ));
+
+    for( size_t i = 0; i < 4; ++i )
+    {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        is >> offset >> length;
+        if( length == 0 )
+            continue;
+
+        if( valid && offset >= head.size() && offset + length <= size )
+            is >> co::Array< char >( &_data[ size_t( offset )],
+                                     size_t( length ));
+        else
+        {
+            std::vector< char > ignored( size_t( length ));
+            is >> co::Array< char >( &ignored[0], ignored.size( ));
+            valid = false;
+        }
+    }
 
-    if( node->getRight( ))
-        _right = new VertexBufferDist( root, node->getRight( ));
+    if( !valid )
+    {
+        LBWARN << "Received inconsistent model data" << std::endl;
+        _data.clear();
+    }
 }
 
+VertexBufferDist::VertexBufferDist()
+        : _root( 0 )
+        , _checksum( 0 )
+{}
+
+VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root )
+        : _root( root )
+        , _blob( root )
+        , _checksum( 0 )
+{}
+
 VertexBufferDist::~VertexBufferDist()
-{
-    delete _left;
-    _left = 0;
-    delete _right;
-    _right = 0;
-}
+{}
 
 void VertexBufferDist::registerTree( co::LocalNodePtr node )
 {
     LBASSERT( !isAttached() );
+    LBCHECK( node->registerObject( &_blob ));
     LBCHECK( node->registerObject( this ));
-
-    if( _left )
-        _left->registerTree( node );
-    
-    if( _right )
-        _right->registerTree( node );
 }
 
 void VertexBufferDist::deregisterTree()
@@ -103,18 +138,15 @@ void VertexBufferDist::deregisterTree()
     LBASSERT( isMaster( ));
 
     getLocalNode()->deregisterObject( this );
-
-    if( _left )
-        _left->deregisterTree();
-    if( _right )
-        _right->deregisterTree();
+    getLocalNode()->deregisterObject( &_blob );
 }
 
 mesh::VertexBufferRoot* VertexBufferDist::loadModel( co::NodePtr master,
                                                      co::LocalNodePtr localNode,
                                                   const eq::uint128_t& modelID )
 {
-    LBASSERT( !_root && !_node );
+    LBASSERT( !_root );
+    lunchbox::Clock clock;
 
     const uint32_t req = localNode->mapObjectNB( this, modelID,
                                                  co::VERSION_OLDEST, master );
@@ -123,124 +155,66 @@ mesh::VertexBufferRoot* VertexBufferDist::loadModel( co::NodePtr master,
         LBWARN << "Mapping of model failed" << std::endl;
         return 0;
     }
+    localNode->unmapObject( this );
+    const float mapTime = clock.resetTimef();
 
-    _unmapTree();
-    return const_cast< mesh::VertexBufferRoot* >( _root );
-}
-
-void VertexBufferDist::_unmapTree()
-{
-    LBASSERT( isAttached() );
-    LBASSERT( !isMaster( ));
-
-    getLocalNode()->unmapObject( this );
+    // use an identical local binary file, e.g., on a shared file system
+    mesh::VertexBufferRoot* root = new mesh::VertexBufferRoot;
+    if( root->readFromCache( _name, _checksum ))
+    {
+        LBINFO << "Loaded " << _name << " from local file in "
+               << clock.getTimef() << " ms, mapped model in " << mapTime
+               << " ms" << std::endl;
+        _root = root;
+        return root;
+    }
+    delete root;
 
-    if( _left )
-        _left->_unmapTree();
-    if( _right )
-        _right->_unmapTree();
+    root = _mapBlob( master, localNode );
+    LBINFO << "Received " << _name << " in " << clock.getTimef()
+           << " ms, mapped model in " << mapTime << " ms" << std::endl;
+    _root = root;
+    return root;
 }
 
-void VertexBufferDist::getInstanceData( co::DataOStream& os )
+mesh::VertexBufferRoot* VertexBufferDist::_mapBlob( co::NodePtr master,
+                                                    co::LocalNodePtr localNode )
 {
-    LBASSERT( _node );
-    os << _isRoot;
-
-    if( _left && _right )
+    lunchbox::Clock clock;
+    const uint32_t req = localNode->mapObjectNB( &_blob, _blobID,
+                                                 co::VERSION_OLDEST, master );
+    if( !localNode->mapObjectSync( req ))
     {
-        os << _left->getID() << _right->getID();
-
-        if( _isRoot )
-        {
-            LBASSERT( _root );
-            const mesh::VertexBufferData& data = _root->_data;
-            
-            os << data.vertices << data.colors << data.normals << data.indices 
-               << _root->_name;
-        }
+        LBWARN << "Mapping of model data failed" << std::endl;
+        return 0;
     }
-    else
-    {
-        os << co::UUID() << co::UUID();
+    localNode->unmapObject( &_blob );
+    const float transferTime = clock.resetTimef();
 
-        LBASSERT( dynamic_cast< const mesh::VertexBufferLeaf* >( _node ));
-        const mesh::VertexBufferLeaf* leaf = 
-            static_cast< const mesh::VertexBufferLeaf* >( _node );
-
-        os << leaf->_boundingBox[0] << leaf->_boundingBox[1]
-           << uint64_t( leaf->_vertexStart ) << uint64_t( leaf->_indexStart )
-           << uint64_t( leaf->_indexLength ) << leaf->_vertexLength;
+    mesh::VertexBufferRoot* root = new mesh::VertexBufferRoot;
+    if( !root->readFromMemory( _name, _blob.getData( )))
+    {
+        LBWARN << "Can't read model data of " << _name << std::endl;
+        delete root;
+        return 0;
     }
 
-    os << _node->_boundingSphere << _node->_range;
+    LBINFO << "Transferred " << _name << " in " << transferTime
+           << " ms, constructed tree in " << clock.getTimef() << " ms"
+           << std::endl;
+    return root;
 }
 
-void VertexBufferDist::applyInstanceData( co::DataIStream& is )
+void VertexBufferDist::getInstanceData( co::DataOStream& os )
 {
-    LBASSERT( !_node );
-
-    mesh::VertexBufferNode* node = 0;
-    mesh::VertexBufferBase* base = 0;
-
-    lunchbox::UUID leftID, rightID;
-    is >> _isRoot >> leftID >> rightID;
-
-    if( leftID != 0 && rightID != 0 )
-    {
-        if( _isRoot )
-        {
-            mesh::VertexBufferRoot* root = new mesh::VertexBufferRoot;
-            mesh::VertexBufferData& data = root->_data;
-
-            is >> data.vertices >> data.colors >> data.normals >> data.indices
-               >> root->_name;
-
-            node  = root;
-            _root = root;
-        }
-        else
-        {
-            LBASSERT( _root );
-            node = new mesh::VertexBufferNode;
-        }
-
-        base   = node;
-        _left  = new VertexBufferDist( _root, 0 );
-        _right = new VertexBufferDist( _root, 0 );
-        co::LocalNodePtr to = getLocalNode();
-        co::NodePtr from = is.getMaster();
-        const uint32_t sync1 = to->mapObjectNB( _left, leftID,
-                                                co::VERSION_OLDEST, from );
-        const uint32_t sync2 = to->mapObjectNB( _right, rightID,
-                                                co::VERSION_OLDEST, from );
-
-        LBCHECK( to->mapObjectSync( sync1 ));
-        LBCHECK( to->mapObjectSync( sync2 ));
-
-        node->_left  = const_cast< mesh::VertexBufferBase* >( _left->_node );
-        node->_right = const_cast< mesh::VertexBufferBase* >( _right->_node );
-    }
-    else
-    {
-        LBASSERT( !_isRoot );
-        mesh::VertexBufferData& data = 
-            const_cast< mesh::VertexBufferData& >( _root->_data );
-        mesh::VertexBufferLeaf* leaf = new mesh::VertexBufferLeaf( data );
-
-        uint64_t i1, i2, i3;
-        is >> leaf->_boundingBox[0] >> leaf->_boundingBox[1]
-           >> i1 >> i2 >> i3 >> leaf->_vertexLength;
-        leaf->_vertexStart = size_t( i1 );
-        leaf->_indexStart = size_t( i2 );
-        leaf->_indexLength = size_t( i3 );
-
-        base = leaf;
-    }
-
-    LBASSERT( base );
-    is >> base->_boundingSphere >> base->_range;
+    LBASSERT( _root );
+    os << _root->getName() << _root->getChecksum() << _blob.getID();
+}
 
-    _node = base;
+void VertexBufferDist::applyInstanceData( co::DataIStream& is )
+{
+    LBASSERT( !_root );
+    is >> _name >> _checksum >> _blobID;
 }
 
 }
@@ -37,7 +37,32 @@
 
 namespace eqPly 
 {
-    /** co::Object to distribute a model, holds a VertexBufferBase node. */
+    /** co::Object holding the binary representation of a whole model. */
+    class VertexBufferBlob : public co::Object
+    {
+    public:
+        VertexBufferBlob( const mesh::VertexBufferRoot* root = 0 )
+            : _root( root ) {}
+
+        /** @return the received binary representation, slave only. */
+        std::vector< char >& getData() { return _data; }
+
+    protected:
+        virtual void getInstanceData( co::DataOStream& os );
+        virtual void applyInstanceData( co::DataIStream& is );
+
+    private:
+        const mesh::VertexBufferRoot* _root;
+        std::vector< char > _data;
+    };
+
+    /**
+     * co::Object to distribute a model.
+     *
+     * Holds the model name and the checksum of its binary representation.
+     * Render nodes with an identical binary file load it from disk, all
+     * others map the binary representation as one object.
+     */
     class VertexBufferDist : public co::Object
     {
     public:
@@ -53,20 +78,19 @@ namespace eqPly
                                            const eq::uint128_t& modelID );
 
     protected:
-        VertexBufferDist( const mesh::VertexBufferRoot* root,
-                          const mesh::VertexBufferBase* node );
-
         virtual void getInstanceData( co::DataOStream& os );
         virtual void applyInstanceData( co::DataIStream& is );
 
     private:
         const mesh::VertexBufferRoot* _root;
-        const mesh::VertexBufferBase* _node;
-        VertexBufferDist* _left;
-        VertexBufferDist* _right;
-        bool _isRoot;
+        VertexBufferBlob _blob;
+
+        std::string   _name;
+        uint32_t      _checksum;
+        eq::uint128_t _blobID;
 
-        void _unmapTree();
+        mesh::VertexBufferRoot* _mapBlob( co::NodePtr master,
+                                          co::LocalNodePtr localNode );
     };
 }
 
@@ -33,26 +33,57 @@
 #include "vertexBufferState.h"
 #include "vertexData.h"
 #include <map>
+#include <set>
 
 namespace mesh
 {
 
-/*  Finish partial setup - sort, reindex and merge into global data.  */
+/*  Finish partial setup - sort and remember the triangles. The leaves are
+    reindexed and merged into the global data in tree order by the root.  */
 void VertexBufferLeaf::setupTree( VertexData& data, const Index start,
                                   const Index length, const Axis axis,
                                   const size_t depth,
                                   VertexBufferData& globalData )
 {
     data.sort( start, length, axis );
-    _vertexStart = globalData.vertices.size();
-    _vertexLength = 0;
-    _indexStart = globalData.indices.size();
-    _indexLength = 0;
 
+    // triangle range until setupVertices
+    _indexStart = start;
+    _indexLength = length;
+}
+
+
+/*  Count the distinct vertices of the leaf's triangles.  */
+Index VertexBufferLeaf::countVertices( const VertexData& data )
+{
+    std::set< Index > vertices;
+    for( Index t = 0; t < _indexLength; ++t )
+        for( Index v = 0; v < 3; ++v )
+            vertices.insert( data.triangles[_indexStart + t][v] );
+
+    _vertexLength = ShortIndex( vertices.size( ));
+    // assert number of vertices does not exceed SmallIndex range
+    MESHASSERT( _vertexLength == vertices.size( ));
+    return vertices.size();
+}
+
+
+/*  Reindex the leaf's triangles into the global data at the given offsets.  */
+void VertexBufferLeaf::setupVertices( const VertexData& data,
+                                      const Index vertexStart,
+                                      const Index indexStart )
+{
+    const Index start = _indexStart;
+    const Index length = _indexLength;
     const bool hasColors = !data.colors.empty();
 
+    _vertexStart = vertexStart;
+    _indexStart = indexStart;
+    _indexLength = 0;
+
     // stores the new indices (relative to _start)
     std::map< Index, ShortIndex > newIndex;
+    ShortIndex nVertices = 0;
 
     for( Index t = 0; t < length; ++t )
     {
@@ -61,18 +92,18 @@ void VertexBufferLeaf::setupTree( VertexData& data, const Index start,
             Index i = data.triangles[start + t][v];
             if( newIndex.find( i ) == newIndex.end() )
             {
-                newIndex[i] = _vertexLength++;
-                // assert number of vertices does not exceed SmallIndex range
-                MESHASSERT( _vertexLength );
-                globalData.vertices.push_back( data.vertices[i] );
+                const Index vertex = _vertexStart + nVertices;
+                newIndex[i] = nVertices++;
+                _globalData.vertices[ vertex ] = data.vertices[i];
                 if( hasColors )
-                    globalData.colors.push_back( data.colors[i] );
-                globalData.normals.push_back( data.normals[i] );
+                    _globalData.colors[ vertex ] = data.colors[i];
+                _globalData.normals[ vertex ] = data.normals[i];
             }
-            globalData.indices.push_back( newIndex[i] );
+            _globalData.indices[ _indexStart + _indexLength ] = newIndex[i];
             ++_indexLength;
         }
     }
+    MESHASSERT( nVertices == _vertexLength );
 
 #ifndef NDEBUG
     MESHINFO << "setupTree" << "( " << _indexStart << ", " << _indexLength
@@ -275,6 +306,11 @@ void VertexBufferLeaf::draw( VertexBufferState& state ) const
       case RENDER_MODE_BUFFER_OBJECT:
           renderBufferObject( state );
           return;
+      case RENDER_MODE_MULTI_DRAW:
+          // submitted per arena by the root
+          state.addBatchedDraw( _arena, GLsizei( _indexLength ),
+                                _arenaOffset );
+          return;
       case RENDER_MODE_DISPLAY_LIST:
       default:
           renderDisplayList( state );
@@ -347,36 +383,47 @@ void VertexBufferLeaf::renderImmediate( VertexBufferState& state ) const
 /*  Read leaf node from memory.  */
 void VertexBufferLeaf::fromMemory( char** addr, VertexBufferData& globalData )
 {
-    size_t nodeType;
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
+    uint32_t nodeType;
+    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( uint32_t ));
     if( nodeType != LEAF_TYPE )
         throw MeshException( "Error reading binary file. Expected a leaf "
                              "node, but found something else instead." );
     VertexBufferBase::fromMemory( addr, globalData );
     memRead( reinterpret_cast< char* >( &_boundingBox ), addr,
              sizeof( BoundingBox ) );
-    memRead( reinterpret_cast< char* >( &_vertexStart ), addr,
-             sizeof( Index ) );
+    // indices are stored with 64 bits independent of the architecture
+    uint64_t vertexStart, indexStart, indexLength;
+    memRead( reinterpret_cast< char* >( &vertexStart ), addr,
+             sizeof( uint64_t ));
     memRead( reinterpret_cast< char* >( &_vertexLength ), addr,
              sizeof( ShortIndex ) );
-    memRead( reinterpret_cast< char* >( &_indexStart ), addr,
-             sizeof( Index ) );
-    memRead( reinterpret_cast< char* >( &_indexLength ), addr,
-             sizeof( Index ) );
+    memRead( reinterpret_cast< char* >( &indexStart ), addr,
+             sizeof( uint64_t ));
+    memRead( reinterpret_cast< char* >( &indexLength ), addr,
+             sizeof( uint64_t ));
+    _vertexStart = Index( vertexStart );
+    _indexStart = Index( indexStart );
+    _indexLength = Index( indexLength );
 }
 
 
 /*  Write leaf node to output stream.  */
-void VertexBufferLeaf::toStream( std::ostream& os )
+void VertexBufferLeaf::toStream( std::ostream& os ) const
 {
-    size_t nodeType = LEAF_TYPE;
-    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ));
+    uint32_t nodeType = LEAF_TYPE;
+    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( uint32_t ));
     VertexBufferBase::toStream( os );
-    os.write( reinterpret_cast< char* >( &_boundingBox ), sizeof( BoundingBox));
-    os.write( reinterpret_cast< char* >( &_vertexStart ), sizeof( Index ));
-    os.write( reinterpret_cast< char* >( &_vertexLength ),sizeof( ShortIndex ));
-    os.write( reinterpret_cast< char* >( &_indexStart ), sizeof( Index ));
-    os.write( reinterpret_cast< char* >( &_indexLength ), sizeof( Index ));
+
+    uint64_t vertexStart = _vertexStart;
+    uint64_t indexStart = _indexStart;
+    uint64_t indexLength = _indexLength;
+    os.write( reinterpret_cast< const char* >( &_boundingBox ),
+              sizeof( BoundingBox ));
+    os.write( reinterpret_cast< char* >( &vertexStart ), sizeof( uint64_t ));
+    os.write( reinterpret_cast< const char* >( &_vertexLength ),
+              sizeof( ShortIndex ));
+    os.write( reinterpret_cast< char* >( &indexStart ), sizeof( uint64_t ));
+    os.write( reinterpret_cast< char* >( &indexLength ), sizeof( uint64_t ));
 }
 
 }
@@ -46,14 +46,15 @@ namespace mesh
     public:
         VertexBufferLeaf( VertexBufferData& data )
             : _globalData( data ), _vertexStart( 0 ),
-              _indexStart( 0 ), _indexLength( 0 ) {}
+              _indexStart( 0 ), _indexLength( 0 ), _arena( 0 ),
+              _arenaOffset( 0 ) {}
         virtual ~VertexBufferLeaf() {}
         
         virtual void draw( VertexBufferState& state ) const;
         virtual Index getNumberOfVertices() const { return _indexLength; }
         
     protected:
-        virtual void toStream( std::ostream& os );
+        virtual void toStream( std::ostream& os ) const;
         virtual void fromMemory( char** addr, VertexBufferData& globalData );
         
         virtual void setupTree( VertexData& data, const Index start,
@@ -62,8 +63,14 @@ namespace mesh
                                 VertexBufferData& globalData );
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
+        virtual void collectLeaves( VertexBufferLeaves& leaves )
+            { leaves.push_back( this ); }
         
     private:
+        Index countVertices( const VertexData& data );
+        void setupVertices( const VertexData& data, const Index vertexStart,
+                            const Index indexStart );
+
         void setupRendering( VertexBufferState& state, GLuint* data ) const;
         void renderImmediate( VertexBufferState& state ) const;
         void renderDisplayList( VertexBufferState& state ) const;
@@ -75,7 +82,9 @@ namespace mesh
         Index               _indexStart;
         Index               _indexLength;
         ShortIndex          _vertexLength;
-        friend class eqPly::VertexBufferDist;
+        size_t              _arena; //!< for RENDER_MODE_MULTI_DRAW
+        size_t              _arenaOffset; //!< in bytes in the arena indices
+        friend class VertexBufferRoot;
     };
     
     
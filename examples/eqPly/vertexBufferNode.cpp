@@ -42,10 +42,15 @@ VertexBufferNode::~VertexBufferNode()
 {
     delete _left;
     delete _right;
+    delete _lod;
     _left = 0;
     _right = 0;
+    _lod = 0;
 }
 
+/*  Subtrees with fewer triangles are built by the current task.  */
+static const Index _minTaskLength = 65536;
+
 inline static bool _subdivide( const Index length, const size_t depth )
 {
     return ( length / 2 > LEAF_SIZE ) || ( depth < 3 && length > 1 );
@@ -63,7 +68,7 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
              << depth << " )." << std::endl;
 #endif
 
-    data.sort( start, length, axis );
+    data.partition( start, length, axis );
     const Index median = start + ( length / 2 );
 
     // left child will include elements smaller than the median
@@ -83,21 +88,34 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
         _right = new VertexBufferNode;
     else
         _right = new VertexBufferLeaf( globalData );
-    
-    // move to next axis and continue contruction in the child nodes
-    const Axis newAxisLeft  = subdivideLeft ? 
-                        data.getLongestAxis( start , leftLength  ) : AXIS_X;
+
+    // the halves are disjoint, build the left one concurrently if worthwhile
+    VertexBufferNode* left = static_cast< VertexBufferNode* >( _left );
+    VertexBufferNode* right = static_cast< VertexBufferNode* >( _right );
+    VertexData* dataPtr = &data;
+    VertexBufferData* globalDataPtr = &globalData;
+
+#ifdef MESH_USE_OMP_TASKS
+#  pragma omp task if( leftLength > _minTaskLength ) \
+    firstprivate( left, dataPtr, globalDataPtr )
+#endif
+    {
+        // move to next axis and continue contruction in the child nodes
+        const Axis newAxisLeft  = subdivideLeft ?
+                            dataPtr->getLongestAxis( start, leftLength ) :
+                            AXIS_X;
+        left->setupTree( *dataPtr, start, leftLength, newAxisLeft, depth+1,
+                         *globalDataPtr );
+    }
 
     const Axis newAxisRight = subdivideRight ? 
                         data.getLongestAxis( median, rightLength ) : AXIS_X;
+    right->setupTree( data, median, rightLength, newAxisRight, depth+1,
+                      globalData );
 
-    static_cast< VertexBufferNode* >
-            ( _left )->setupTree( data, start, leftLength, newAxisLeft, depth+1,
-                                  globalData );
-    static_cast< VertexBufferNode* >
-        ( _right )->setupTree( data, median, rightLength, newAxisRight, depth+1,
-                               globalData );
-
+#ifdef MESH_USE_OMP_TASKS
+#  pragma omp taskwait
+#endif
 }
 
 
@@ -150,6 +168,23 @@ void VertexBufferNode::updateRange()
 }
 
 
+/*  Collect the children's leaves, left first.  */
+void VertexBufferNode::collectLeaves( VertexBufferLeaves& leaves )
+{
+    static_cast< VertexBufferNode* >( _left )->collectLeaves( leaves );
+    static_cast< VertexBufferNode* >( _right )->collectLeaves( leaves );
+}
+
+
+/*  Collect this node and the children's inner nodes, left first.  */
+void VertexBufferNode::collectNodes( VertexBufferNodes& nodes )
+{
+    nodes.push_back( this );
+    static_cast< VertexBufferNode* >( _left )->collectNodes( nodes );
+    static_cast< VertexBufferNode* >( _right )->collectNodes( nodes );
+}
+
+
 /*  Draw the node by rendering the children.  */
 void VertexBufferNode::draw( VertexBufferState& state ) const
 {
@@ -165,19 +200,31 @@ void VertexBufferNode::draw( VertexBufferState& state ) const
 void VertexBufferNode::fromMemory( char** addr, VertexBufferData& globalData )
 {
     // read node itself   
-    size_t nodeType;
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
+    uint32_t nodeType;
+    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( uint32_t ));
     if( nodeType != NODE_TYPE )
         throw MeshException( "Error reading binary file. Expected a regular "
                              "node, but found something else instead." );
     VertexBufferBase::fromMemory( addr, globalData );
+
+    // read simplified representation
+    uint32_t hasLOD;
+    memRead( reinterpret_cast< char* >( &hasLOD ), addr, sizeof( uint32_t ));
+    if( hasLOD )
+    {
+        memRead( reinterpret_cast< char* >( &_lodError ), addr,
+                 sizeof( float ));
+        _lod = new VertexBufferLeaf( globalData );
+        static_cast< VertexBufferNode* >( _lod )->fromMemory( addr,
+                                                              globalData );
+    }
     
     // read left child (peek ahead)
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
+    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( uint32_t ));
     if( nodeType != NODE_TYPE && nodeType != LEAF_TYPE )
         throw MeshException( "Error reading binary file. Expected either a "
                              "regular or a leaf node, but found neither." );
-    *addr -= sizeof( size_t );
+    *addr -= sizeof( uint32_t );
     if( nodeType == NODE_TYPE )
         _left = new VertexBufferNode;
     else
@@ -185,11 +232,11 @@ void VertexBufferNode::fromMemory( char** addr, VertexBufferData& globalData )
     static_cast< VertexBufferNode* >( _left )->fromMemory( addr, globalData );
     
     // read right child (peek ahead)
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
+    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( uint32_t ));
     if( nodeType != NODE_TYPE && nodeType != LEAF_TYPE )
         throw MeshException( "Error reading binary file. Expected either a "
                              "regular or a leaf node, but found neither." );
-    *addr -= sizeof( size_t );
+    *addr -= sizeof( uint32_t );
     if( nodeType == NODE_TYPE )
         _right = new VertexBufferNode;
     else
@@ -199,13 +246,23 @@ void VertexBufferNode::fromMemory( char** addr, VertexBufferData& globalData )
 
 
 /*  Write node to output stream and continue with remaining nodes.  */
-void VertexBufferNode::toStream( std::ostream& os )
+void VertexBufferNode::toStream( std::ostream& os ) const
 {
-    size_t nodeType = NODE_TYPE;
-    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ) );
+    uint32_t nodeType = NODE_TYPE;
+    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( uint32_t ));
     VertexBufferBase::toStream( os );
-    static_cast< VertexBufferNode* >( _left )->toStream( os );
-    static_cast< VertexBufferNode* >( _right )->toStream( os );
+
+    uint32_t hasLOD = _lod ? 1 : 0;
+    os.write( reinterpret_cast< char* >( &hasLOD ), sizeof( uint32_t ));
+    if( _lod )
+    {
+        os.write( reinterpret_cast< const char* >( &_lodError ),
+                  sizeof( float ));
+        static_cast< const VertexBufferNode* >( _lod )->toStream( os );
+    }
+
+    static_cast< const VertexBufferNode* >( _left )->toStream( os );
+    static_cast< const VertexBufferNode* >( _right )->toStream( os );
 }
 
 }
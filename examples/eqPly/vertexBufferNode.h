@@ -43,7 +43,8 @@ namespace mesh
     class VertexBufferNode : public VertexBufferBase
     {
     public:
-        VertexBufferNode() : _left( 0 ), _right( 0 ) {}
+        VertexBufferNode() : _left( 0 ), _right( 0 ), _lod( 0 ),
+                             _lodError( 0.f ) {}
         virtual ~VertexBufferNode();
 
         virtual void draw( VertexBufferState& state ) const;
@@ -52,9 +53,11 @@ namespace mesh
 
         virtual const VertexBufferBase* getLeft() const { return _left; }
         virtual const VertexBufferBase* getRight() const { return _right; }
+        virtual const VertexBufferBase* getLOD() const { return _lod; }
+        virtual float getLODError() const { return _lodError; }
 
     protected:
-        virtual void toStream( std::ostream& os );
+        virtual void toStream( std::ostream& os ) const;
         virtual void fromMemory( char** addr, VertexBufferData& globalData );
 
         virtual void setupTree( VertexData& data, const Index start,
@@ -63,11 +66,15 @@ namespace mesh
                                 VertexBufferData& globalData );
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
+        virtual void collectLeaves( VertexBufferLeaves& leaves );
+        virtual void collectNodes( VertexBufferNodes& nodes );
 
     private:
         VertexBufferBase*   _left;
         VertexBufferBase*   _right;
-        friend class eqPly::VertexBufferDist;
+        VertexBufferLeaf*   _lod; //!< simplified subtree, stored after leaves
+        float               _lodError;
+        friend class VertexBufferRoot;
     };
 }
 
@@ -29,41 +29,219 @@
 
 
 #include "vertexBufferRoot.h"
+#include "vertexBufferLeaf.h"
 #include "vertexBufferState.h"
 #include "vertexData.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
 #include <string>
 #include <sstream>
-#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#ifndef _WIN32
-#   include <sys/mman.h>
-#endif
 
 namespace mesh
 {
 
 typedef vmml::frustum_culler< float >  FrustumCuller;
 
-/*  Determine number of bits used by the current architecture.  */
-size_t getArchitectureBits();
 /*  Determine whether the current architecture is little endian or not.  */
 bool isArchitectureLittleEndian();
-/*  Construct architecture dependent file name.  */
+/*  Construct byte order dependent file name.  */
 std::string getArchitectureFilename( const std::string& filename );
 
+namespace
+{
+/*  Header of the binary kd-tree file. The node records follow the header,
+    the data arrays are stored unmodified at cache line aligned offsets, so
+    that they can be used directly from the memory-mapped file.  */
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t checksum; // of the header with a zero checksum, the nodes
+                       // and the data arrays, computed when writing
+    uint64_t fileSize;
+    uint64_t nodeSize; // node records start right after the header
+    uint64_t offsets[4]; // vertices, colors, normals, indices
+    uint64_t lengths[4];
+};
+
+/*  Maximum number of vertices in one multi-draw arena.  */
+const Index _arenaVertices = 1 << 21;
+
+/*  Interleaved vertex of a multi-draw arena.  */
+struct ArenaVertex
+{
+    Vertex  vertex;
+    Normal  normal;
+    Color   color;
+    uint8_t padding;
+};
+
+/*  Grid resolution along the longest axis for the simplification of the
+    largest subtrees, reduced until a subtree fits into one leaf.  */
+const uint64_t _lodResolution = 128;
+
+/*  Simplified subtrees need to save at least this factor of triangles.  */
+const size_t _lodReduction = 4;
+
+/*  The grid cell of a vertex, clamped to the resolution.  */
+uint64_t _getCell( const Vertex& vertex, const BoundingBox& box,
+                   const float cellSize, const uint64_t resolution )
+{
+    uint64_t cell = 0;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const float position = ( vertex[i] - box[0][i] ) / cellSize;
+        cell = cell * resolution +
+               LB_MIN( uint64_t( LB_MAX( position, 0.f )), resolution - 1 );
+    }
+    return cell;
+}
+
+const uint32_t _magic = 0x6b645450; // 'PTdk'
+const uint32_t _byteOrder = 0x01020304;
+const uint64_t _alignment = 64;
+
+/*  FNV-1a hash, used to detect truncated or modified files.  */
+uint32_t _checksum( const char* data, const size_t size, uint32_t hash )
+{
+    for( size_t i = 0; i < size; ++i )
+    {
+        hash ^= uint8_t( data[i] );
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template< class T >
+uint32_t _checksum( const DataArray< T >& array, const uint32_t hash )
+{
+    if( array.empty( ))
+        return hash;
+    return _checksum( reinterpret_cast< const char* >( &array[0] ),
+                      array.size() * sizeof( T ), hash );
+}
+
+uint32_t _checksum( const FileHeader& header, const char* nodes,
+                    const VertexBufferData& data )
+{
+    FileHeader copy = header;
+    copy.checksum = 0;
+    uint32_t hash = _checksum( reinterpret_cast< const char* >( &copy ),
+                               sizeof( FileHeader ), 2166136261u );
+    hash = _checksum( nodes, size_t( header.nodeSize ), hash );
+    hash = _checksum( data.vertices, hash );
+    hash = _checksum( data.colors, hash );
+    hash = _checksum( data.normals, hash );
+    return _checksum( data.indices, hash );
+}
+
+template< class T >
+void _mapArray( const char* start, const FileHeader& header, const size_t i,
+                DataArray< T >& array )
+{
+    if( header.offsets[i] % _alignment != 0 ||
+        header.offsets[i] + header.lengths[i] * sizeof( T ) > header.fileSize )
+    {
+        throw MeshException( "Error reading binary file. Data array exceeds "
+                             "the file size." );
+    }
+    array.map( reinterpret_cast< const T* >( start + header.offsets[i] ),
+               size_t( header.lengths[i] ));
+}
+
+template< class T >
+void _writeArray( std::ostream& os, const DataArray< T >& array,
+                  const uint64_t offset )
+{
+    const uint64_t position = uint64_t( os.tellp( ));
+    MESHASSERT( position <= offset );
+    for( uint64_t i = position; i < offset; ++i )
+        os.put( 0 );
+    if( !array.empty( ))
+        os.write( reinterpret_cast< const char* >( &array[0] ),
+                  array.size() * sizeof( T ));
+}
+}
+
 /*  Begin kd-tree setup, go through full range starting with x axis.  */
 void VertexBufferRoot::setupTree( VertexData& data )
 {
     // data is VertexData, _data is VertexBufferData
     _data.clear();
+    _map.unmap();
+    _buffer.clear();
+    _fileChecksum = 0;
+    lunchbox::Clock clock;
 
     const Axis axis = data.getLongestAxis( 0, data.triangles.size() );
 
+    // partition the triangles, independent subtrees are built concurrently
+#ifdef MESH_USE_OMP_TASKS
+#  pragma omp parallel
+#  pragma omp single
+#endif
     VertexBufferNode::setupTree( data, 0, data.triangles.size(), 
                                  axis, 0, _data );
+    const float partitionTime = clock.resetTimef();
+
+    // reindex the leaves into the global data, laid out in tree order
+    VertexBufferLeaves leaves;
+    VertexBufferNode::collectLeaves( leaves );
+    const ssize_t nLeaves = ssize_t( leaves.size( ));
+
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nLeaves; ++i )
+        leaves[i]->countVertices( data );
+
+    std::vector< Index > vertexStarts( nLeaves );
+    std::vector< Index > indexStarts( nLeaves );
+    Index nVertices = 0;
+    Index nIndices = 0;
+    for( ssize_t i = 0; i < nLeaves; ++i )
+    {
+        vertexStarts[i] = nVertices;
+        indexStarts[i] = nIndices;
+        nVertices += leaves[i]->_vertexLength;
+        nIndices += 3 * leaves[i]->_indexLength;
+    }
+
+    _data.vertices.resize( nVertices );
+    if( !data.colors.empty( ))
+        _data.colors.resize( nVertices );
+    _data.normals.resize( nVertices );
+    _data.indices.resize( nIndices );
+
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nLeaves; ++i )
+        leaves[i]->setupVertices( data, vertexStarts[i], indexStarts[i] );
+    const float layoutTime = clock.resetTimef();
+
     VertexBufferNode::updateBoundingSphere();
     VertexBufferNode::updateRange();
+    const float boundsTime = clock.resetTimef();
+
+    // the ranges above only cover the leaves, the simplified subtrees are
+    // appended to the global data afterwards
+    _setupLOD();
+    _setupArenas();
+
+    MESHINFO << "Built kd-tree of " << data.triangles.size() << " triangles: "
+             << nLeaves << " leaves, "
+             << float( nIndices ) / 3.f / float( LB_MAX( nLeaves, 1 ))
+             << " triangles and "
+             << float( nVertices ) / float( LB_MAX( nLeaves, 1 ))
+             << " vertices per leaf, "
+             << float( nVertices ) / float( LB_MAX( data.vertices.size(), 1 ))
+             << " vertex duplication, " << partitionTime << " ms partition, "
+             << layoutTime << " ms layout, " << boundsTime << " ms bounds, "
+             << clock.getTimef() << " ms simplification" << std::endl;
 
 #if 0
     // re-test all points to be in the bounding sphere
@@ -82,6 +260,207 @@ void VertexBufferRoot::setupTree( VertexData& data )
 #endif
 }
 
+/*  Build the simplified representations of the inner nodes by vertex
+    clustering, and append them to the global data after the leaves.  */
+void VertexBufferRoot::_setupLOD()
+{
+    VertexBufferNodes nodes;
+    VertexBufferNode::collectNodes( nodes );
+    const ssize_t nNodes = ssize_t( nodes.size( ));
+    std::vector< VertexData > meshes( nNodes );
+
+#pragma omp parallel for schedule( dynamic )
+    for( ssize_t i = 0; i < nNodes; ++i )
+    {
+        const float error = _simplify( nodes[i], meshes[i] );
+        if( error <= 0.f )
+            continue;
+
+        VertexBufferLeaf* lod = new VertexBufferLeaf( _data );
+        lod->_indexLength = meshes[i].triangles.size();
+        lod->countVertices( meshes[i] );
+        nodes[i]->_lod = lod;
+        nodes[i]->_lodError = error;
+    }
+
+    std::vector< Index > vertexStarts( nNodes );
+    std::vector< Index > indexStarts( nNodes );
+    Index nVertices = _data.vertices.size();
+    Index nIndices = _data.indices.size();
+    size_t nLODs = 0;
+    for( ssize_t i = 0; i < nNodes; ++i )
+    {
+        const VertexBufferLeaf* lod = nodes[i]->_lod;
+        if( !lod )
+            continue;
+
+        vertexStarts[i] = nVertices;
+        indexStarts[i] = nIndices;
+        nVertices += lod->_vertexLength;
+        nIndices += 3 * lod->_indexLength;
+        ++nLODs;
+    }
+
+    _data.vertices.resize( nVertices );
+    if( !_data.colors.empty( ))
+        _data.colors.resize( nVertices );
+    _data.normals.resize( nVertices );
+    _data.indices.resize( nIndices );
+
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nNodes; ++i )
+    {
+        VertexBufferLeaf* lod = nodes[i]->_lod;
+        if( !lod )
+            continue;
+
+        lod->setupVertices( meshes[i], vertexStarts[i], indexStarts[i] );
+        lod->updateBoundingSphere();
+    }
+
+    MESHINFO << "Simplified " << nLODs << " of " << nNodes << " nodes using "
+             << nIndices / 3 << " triangles in total" << std::endl;
+}
+
+
+/*  Cluster the vertices of a subtree on a regular grid, and keep the
+    triangles spanning three clusters. Returns the object space error, or 0 if
+    the simplification is not worth it.  */
+float VertexBufferRoot::_simplify( VertexBufferNode* node,
+                                   VertexData& mesh ) const
+{
+    VertexBufferLeaves leaves;
+    node->collectLeaves( leaves );
+    if( leaves.empty( ))
+        return 0.f;
+
+    BoundingBox box = leaves.front()->_boundingBox;
+    Index nTriangles = 0;
+    for( VertexBufferLeaves::const_iterator i = leaves.begin();
+         i != leaves.end(); ++i )
+    {
+        const BoundingBox& leafBox = (*i)->_boundingBox;
+        for( size_t j = 0; j < 3; ++j )
+        {
+            box[0][j] = std::min( box[0][j], leafBox[0][j] );
+            box[1][j] = std::max( box[1][j], leafBox[1][j] );
+        }
+        nTriangles += (*i)->_indexLength / 3;
+    }
+
+    const Vertex size = box[1] - box[0];
+    const float extent = LB_MAX( LB_MAX( size.x(), size.y( )), size.z( ));
+    if( extent <= 0.f )
+        return 0.f;
+
+    const bool hasColors = !_data.colors.empty();
+    for( uint64_t resolution = _lodResolution; resolution > 1;
+         resolution /= 2 )
+    {
+        const float cellSize = extent / float( resolution );
+        typedef std::map< uint64_t, Index > Clusters;
+        Clusters clusters;
+        std::vector< Vertex > colorSums;
+        std::vector< float > counts;
+
+        mesh.vertices.clear();
+        mesh.normals.clear();
+        mesh.colors.clear();
+        mesh.triangles.clear();
+
+        // 1) accumulate the vertices of each occupied cell
+        for( VertexBufferLeaves::const_iterator i = leaves.begin();
+             i != leaves.end() && clusters.size() <= LEAF_SIZE; ++i )
+        {
+            const VertexBufferLeaf* leaf = *i;
+            for( Index j = leaf->_vertexStart;
+                 j < leaf->_vertexStart + leaf->_vertexLength; ++j )
+            {
+                const Vertex& vertex = _data.vertices[j];
+                const uint64_t cell = _getCell( vertex, box, cellSize,
+                                                resolution );
+                std::pair< Clusters::iterator, bool > result =
+                    clusters.insert( std::make_pair( cell, counts.size( )));
+                if( result.second )
+                {
+                    mesh.vertices.push_back( Vertex( 0.f ));
+                    mesh.normals.push_back( Normal( 0.f ));
+                    colorSums.push_back( Vertex( 0.f ));
+                    counts.push_back( 0.f );
+                }
+
+                const Index cluster = result.first->second;
+                mesh.vertices[ cluster ] += vertex;
+                mesh.normals[ cluster ] += _data.normals[j];
+                if( hasColors )
+                    for( size_t k = 0; k < 3; ++k )
+                        colorSums[ cluster ][k] += _data.colors[j][k];
+                counts[ cluster ] += 1.f;
+            }
+        }
+        if( clusters.size() > LEAF_SIZE )
+            continue;
+
+        // 2) keep the triangles spanning three clusters, once
+        std::set< uint64_t > triangles;
+        for( VertexBufferLeaves::const_iterator i = leaves.begin();
+             i != leaves.end(); ++i )
+        {
+            const VertexBufferLeaf* leaf = *i;
+            for( Index j = leaf->_indexStart;
+                 j < leaf->_indexStart + leaf->_indexLength; j += 3 )
+            {
+                Index corners[3];
+                for( size_t k = 0; k < 3; ++k )
+                {
+                    const Vertex& vertex = _data.vertices[ leaf->_vertexStart +
+                                                        _data.indices[j + k] ];
+                    corners[k] = clusters[ _getCell( vertex, box, cellSize,
+                                                     resolution ) ];
+                }
+                if( corners[0] == corners[1] || corners[1] == corners[2] ||
+                    corners[0] == corners[2] )
+                {
+                    continue;
+                }
+
+                Index sorted[3] = { corners[0], corners[1], corners[2] };
+                std::sort( sorted, sorted + 3 );
+                const uint64_t key = ( uint64_t( sorted[0] ) << 32 ) |
+                                     ( uint64_t( sorted[1] ) << 16 ) |
+                                     uint64_t( sorted[2] );
+                if( triangles.insert( key ).second )
+                    mesh.triangles.push_back( Triangle( corners[0], corners[1],
+                                                        corners[2] ));
+            }
+        }
+
+        if( mesh.triangles.empty() ||
+            mesh.triangles.size() * _lodReduction > nTriangles )
+        {
+            return 0.f;
+        }
+
+        // 3) the representative vertex of a cell is the average of its
+        // vertices
+        if( hasColors )
+            mesh.colors.resize( counts.size( ));
+        for( size_t i = 0; i < counts.size(); ++i )
+        {
+            mesh.vertices[i] /= counts[i];
+            if( mesh.normals[i].length() > 0.f )
+                mesh.normals[i].normalize();
+            if( hasColors )
+                for( size_t k = 0; k < 3; ++k )
+                    mesh.colors[i][k] = uint8_t( colorSums[i][k] / counts[i] +
+                                                 .5f );
+        }
+        return cellSize * std::sqrt( 3.f );
+    }
+    return 0.f;
+}
+
+
 // #define LOGCULL
 void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
 {
@@ -93,6 +472,8 @@ void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
 #endif
 
     const Range& range = state.getRange();
+    const float maxScreenError = state.useFrustumCulling() ?
+                                 state.getMaxScreenError() : 0.f;
     FrustumCuller culler;
     culler.setup( state.getProjectionModelViewMatrix( ));
 
@@ -119,6 +500,20 @@ void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
         const vmml::Visibility visibility = state.useFrustumCulling() ?
                             culler.test_sphere( treeNode->getBoundingSphere( )) :
                             vmml::VISIBILITY_FULL;
+
+        // draw the simplified subtree if its error is below the threshold
+        const mesh::VertexBufferBase* lod = treeNode->getLOD();
+        if( lod && maxScreenError > 0.f &&
+            visibility != vmml::VISIBILITY_NONE &&
+            treeNode->getRange()[0] >= range[0] &&
+            treeNode->getRange()[1] <= range[1] &&
+            state.getScreenError( treeNode->getBoundingSphere(),
+                                  treeNode->getLODError( )) <= maxScreenError )
+        {
+            lod->draw( state );
+            continue;
+        }
+
         switch( visibility )
         {
             case vmml::VISIBILITY_FULL:
@@ -188,6 +583,9 @@ void VertexBufferRoot::_beginRendering( VertexBufferState& state ) const
     switch( state.getRenderMode() )
     {
 #ifdef GL_ARB_vertex_buffer_object
+    case RENDER_MODE_MULTI_DRAW:
+        state.resetBatches();
+        // no break, same client state as buffer objects
     case RENDER_MODE_BUFFER_OBJECT:
         glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
         glEnableClientState( GL_VERTEX_ARRAY );
@@ -216,6 +614,9 @@ void VertexBufferRoot::_endRendering( VertexBufferState& state ) const
     switch( state.getRenderMode() )
     {
 #ifdef GL_ARB_vertex_buffer_object
+    case RENDER_MODE_MULTI_DRAW:
+        _drawArenas( state );
+        // no break, tear down buffer object state
     case RENDER_MODE_BUFFER_OBJECT:
     {
         // deactivate VBO and EBO use
@@ -233,10 +634,142 @@ void VertexBufferRoot::_endRendering( VertexBufferState& state ) const
 }
 
 
-/*  Determine number of bits used by the current architecture.  */
-size_t getArchitectureBits()
+/*  Split the global data into arenas at leaf boundaries. Leaves and
+    simplified subtrees occupy contiguous ranges of the vertices and indices
+    in the order of their vertex start.  */
+void VertexBufferRoot::_setupArenas()
+{
+    VertexBufferLeaves leaves;
+    VertexBufferNode::collectLeaves( leaves );
+
+    VertexBufferNodes nodes;
+    VertexBufferNode::collectNodes( nodes );
+    for( VertexBufferNodes::const_iterator i = nodes.begin();
+         i != nodes.end(); ++i )
+    {
+        if( (*i)->_lod )
+            leaves.push_back( (*i)->_lod );
+    }
+    std::sort( leaves.begin(), leaves.end(), _isBefore );
+
+    _arenas.clear();
+    for( VertexBufferLeaves::const_iterator i = leaves.begin();
+         i != leaves.end(); ++i )
+    {
+        VertexBufferLeaf* leaf = *i;
+        if( _arenas.empty() || _arenas.back().vertexLength +
+                               leaf->_vertexLength > _arenaVertices )
+        {
+            _arenas.push_back( Arena( ));
+            Arena& arena = _arenas.back();
+            arena.vertexStart = leaf->_vertexStart;
+            arena.vertexLength = 0;
+            arena.indexStart = leaf->_indexStart;
+            arena.indexLength = 0;
+        }
+
+        Arena& arena = _arenas.back();
+        MESHASSERT( leaf->_vertexStart == arena.vertexStart +
+                                          arena.vertexLength );
+        MESHASSERT( leaf->_indexStart == arena.indexStart +
+                                         arena.indexLength );
+        leaf->_arena = _arenas.size() - 1;
+        leaf->_arenaOffset = ( leaf->_indexStart - arena.indexStart ) *
+                             sizeof( GLuint );
+        arena.vertexLength += leaf->_vertexLength;
+        arena.indexLength += leaf->_indexLength;
+        arena.leaves.push_back( leaf );
+    }
+}
+
+
+/*  Order leaves by their position in the global data.  */
+bool VertexBufferRoot::_isBefore( const VertexBufferLeaf* a,
+                                  const VertexBufferLeaf* b )
+{
+    return a->_vertexStart < b->_vertexStart;
+}
+
+
+#define glewGetContext state.glewGetContext
+
+/*  Submit the queued leaves of each arena with one draw call.  */
+void VertexBufferRoot::_drawArenas( VertexBufferState& state ) const
+{
+    VertexBufferState::Batches& batches = state.getBatches();
+    const size_t nArenas = LB_MIN( batches.size(), _arenas.size( ));
+
+    for( size_t i = 0; i < nArenas; ++i )
+    {
+        VertexBufferState::Batch& batch = batches[i];
+        if( batch.counts.empty( ))
+            continue;
+
+        const Arena& arena = _arenas[i];
+        const char* key = reinterpret_cast< const char* >( &arena );
+        GLuint buffers[2] = { state.getBufferObject( key ),
+                              state.getBufferObject( key + 1 ) };
+        if( buffers[0] == state.INVALID || buffers[1] == state.INVALID )
+            _uploadArena( state, arena, buffers );
+
+        const GLsizei stride = sizeof( ArenaVertex );
+        const char* base = 0;
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[0] );
+        glVertexPointer( 3, GL_FLOAT, stride, base );
+        glNormalPointer( GL_FLOAT, stride, base + sizeof( Vertex ));
+        if( state.useColors( ))
+            glColorPointer( 3, GL_UNSIGNED_BYTE, stride,
+                            base + sizeof( Vertex ) + sizeof( Normal ));
+
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, buffers[1] );
+        glMultiDrawElements( GL_TRIANGLES, &batch.counts[0], GL_UNSIGNED_INT,
+                             &batch.offsets[0], GLsizei( batch.counts.size( )));
+    }
+    state.resetBatches();
+}
+
+
+/*  Interleave the arena's vertices and rebase its indices to 32 bit.  */
+void VertexBufferRoot::_uploadArena( VertexBufferState& state,
+                                     const Arena& arena,
+                                     GLuint buffers[2] ) const
 {
-    return ( sizeof( void* ) * 8 );
+    const char* key = reinterpret_cast< const char* >( &arena );
+    if( buffers[0] == state.INVALID )
+        buffers[0] = state.newBufferObject( key );
+    if( buffers[1] == state.INVALID )
+        buffers[1] = state.newBufferObject( key + 1 );
+
+    const bool hasColors = !_data.colors.empty();
+    std::vector< ArenaVertex > vertices( arena.vertexLength );
+    for( Index i = 0; i < arena.vertexLength; ++i )
+    {
+        const Index j = arena.vertexStart + i;
+        ArenaVertex& vertex = vertices[i];
+        vertex.vertex = _data.vertices[j];
+        vertex.normal = _data.normals[j];
+        vertex.color = hasColors ? _data.colors[j] : Color( 0 );
+        vertex.padding = 0;
+    }
+
+    std::vector< GLuint > indices( arena.indexLength );
+    for( VertexBufferLeaves::const_iterator i = arena.leaves.begin();
+         i != arena.leaves.end(); ++i )
+    {
+        const VertexBufferLeaf* leaf = *i;
+        const GLuint base = GLuint( leaf->_vertexStart - arena.vertexStart );
+        const Index offset = leaf->_indexStart - arena.indexStart;
+        for( Index j = 0; j < leaf->_indexLength; ++j )
+            indices[ offset + j ] =
+                base + _data.indices[ leaf->_indexStart + j ];
+    }
+
+    glBindBuffer( GL_ARRAY_BUFFER, buffers[0] );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( ArenaVertex ),
+                  vertices.empty() ? 0 : &vertices[0], GL_STATIC_DRAW );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, buffers[1] );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( GLuint ),
+                  indices.empty() ? 0 : &indices[0], GL_STATIC_DRAW );
 }
 
 
@@ -249,12 +782,13 @@ bool isArchitectureLittleEndian()
 }
 
 
-/*  Construct architecture dependent file name.  */
+/*  Construct byte order dependent file name. The file layout does not depend
+    on the pointer size, so 32 and 64 bit processes share the same file.  */
 std::string getArchitectureFilename( const std::string& filename )
 {
     std::ostringstream oss;
     oss << filename << ( isArchitectureLittleEndian() ? ".le" : ".be" );
-    oss << getArchitectureBits() << ".bin";
+    oss << ".bin";
     return oss.str();    
 }
 
@@ -282,106 +816,53 @@ bool VertexBufferRoot::_constructFromPly( const std::string& filename )
     return true;
 }
 
-bool VertexBufferRoot::_readBinary( std::string filename )
+/*  Map the binary file read-only and use its data arrays in place, so that
+    all processes on a machine share the same pages.  */
+bool VertexBufferRoot::_readBinary( std::string filename, const bool verify )
 {
 #ifdef WIN32
-
-    // replace dir delimiters since '\' is often used as escape char
+    // replace dir delimiters since '\\' is often used as escape char
     for( size_t i=0; i<filename.length(); ++i )
         if( filename[i] == '\\' )
             filename[i] = '/';
+#endif
 
-    // try to open binary file
-    HANDLE file = CreateFile( filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
-                              0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
-    if( file == INVALID_HANDLE_VALUE )
+    // no binary file yet, silently construct from ply
+    struct stat status;
+    if( stat( filename.c_str(), &status ) != 0 )
         return false;
-    
+
     MESHINFO << "Reading cached binary representation." << std::endl;
-    
-    // create a file mapping
-    HANDLE map = CreateFileMapping( file, 0, PAGE_READONLY, 0, 0, 
-                                    filename.c_str( ));
-    CloseHandle( file );
-    if( !map )
-    {
-        MESHERROR << "Unable to read binary file, file mapping failed." 
-                  << std::endl;
-        return false;
-    }
-    
-    // get a view of the mapping
-    char* addr   = static_cast< char* >( MapViewOfFile( map, FILE_MAP_READ, 0, 
-                                                        0, 0 ) );
-    bool  result = false;
 
-    if( addr )
-    {
-        try
-        {
-            fromMemory( addr );
-            result = true;
-        }
-        catch( const std::exception& e )
-        {
-            MESHERROR << "Unable to read binary file, an exception occured:  "
-                      << e.what() << std::endl;
-        }
-        UnmapViewOfFile( addr );
-    }
-    else
+    const char* addr = static_cast< const char* >( _map.map( filename ));
+    if( !addr )
     {
         MESHERROR << "Unable to read binary file, memory mapping failed."
                   << std::endl;
         return false;
     }
 
-    CloseHandle( map );
-    return result;
-    
-#else
-    // try to open binary file
-    int fd = open( filename.c_str(), O_RDONLY );
-    if( fd < 0 )
-        return false;
-    
-    // retrieving file information
-    struct stat status;
-    fstat( fd, &status );
-    
-    // create memory mapped file
-    char* addr   = static_cast< char* >( mmap( 0, status.st_size, PROT_READ, 
-                                               MAP_SHARED, fd, 0 ) );
-    bool  result = false;
-    if( addr != MAP_FAILED )
+    try
     {
-        try
-        {
-            fromMemory( addr );
-            result = true;
-        }
-        catch( const std::exception& e )
-        {
-            MESHERROR << "Unable to read binary file, an exception occured:  "
-                      << e.what() << std::endl;
-        }
-        munmap( addr, status.st_size );
+        fromMemory( addr, _map.getSize(), verify );
+        return true;
     }
-    else
+    catch( const std::exception& e )
     {
-        MESHERROR << "Unable to read binary file, memory mapping failed."
-                  << std::endl;
+        MESHERROR << "Unable to read binary file, an exception occured:  "
+                  << e.what() << std::endl;
     }
-    
-    close( fd );
-    return result;
-#endif
+
+    _data.clear();
+    _map.unmap();
+    return false;
 }
 
 /*  Read binary kd-tree representation, construct from ply if unavailable.  */
-bool VertexBufferRoot::readFromFile( const std::string& filename )
+bool VertexBufferRoot::readFromFile( const std::string& filename,
+                                     const bool verify )
 {
-    if( _readBinary( getArchitectureFilename( filename )))
+    if( _readBinary( getArchitectureFilename( filename ), verify ))
     {
         _name = filename;
         return true;
@@ -394,12 +875,62 @@ bool VertexBufferRoot::readFromFile( const std::string& filename )
     return false;
 }
 
+/*  Read the binary kd-tree representation only if it matches the checksum,
+    used by render clients to load the model from a shared file system.  */
+bool VertexBufferRoot::readFromCache( const std::string& filename,
+                                      const uint32_t checksum )
+{
+    if( !_readBinary( getArchitectureFilename( filename ), false ))
+        return false;
+
+    if( _fileChecksum != checksum )
+    {
+        MESHINFO << "Binary file does not match the distributed model."
+                 << std::endl;
+        _data.clear();
+        _map.unmap();
+        _fileChecksum = 0;
+        return false;
+    }
+    _name = filename;
+    return true;
+}
+
+/*  Construct from a binary representation received over the network, takes
+    ownership of the data since the arrays are used in place.  */
+bool VertexBufferRoot::readFromMemory( const std::string& name,
+                                       std::vector< char >& data )
+{
+    _map.unmap();
+    _buffer.swap( data );
+    data.clear();
+    try
+    {
+        fromMemory( _buffer.empty() ? 0 : &_buffer[0], _buffer.size(), true );
+        _name = name;
+        return true;
+    }
+    catch( const std::exception& e )
+    {
+        MESHERROR << "Unable to read model data, an exception occured:  "
+                  << e.what() << std::endl;
+    }
+
+    _data.clear();
+    _buffer.clear();
+    return false;
+}
+
 /*  Write binary representation of the kd-tree to file.  */
 bool VertexBufferRoot::writeToFile( const std::string& filename )
 {
     bool result = false;
-    
-    std::ofstream output( getArchitectureFilename( filename ).c_str(), 
+
+    // write to a temporary file and rename it, since other processes may
+    // still use a mapping of the previous file
+    const std::string target = getArchitectureFilename( filename );
+    const std::string temporary = target + ".tmp";
+    std::ofstream output( temporary.c_str(), 
                           std::ios::out | std::ios::binary );
     if( output )
     {
@@ -407,7 +938,12 @@ bool VertexBufferRoot::writeToFile( const std::string& filename )
         output.exceptions( std::ofstream::failbit | std::ofstream::badbit );
         try
         {
-            toStream( output );
+            // the checksum is computed once here, and stored in the header
+            std::string head;
+            uint64_t offsets[4];
+            _fileChecksum = 0;
+            _getHead( head, offsets, _fileChecksum );
+            _writeBinary( output, head, offsets );
             result = true;
         }
         catch( const std::exception& e )
@@ -416,6 +952,15 @@ bool VertexBufferRoot::writeToFile( const std::string& filename )
                       << "occured:  " << e.what() << std::endl;
         }
         output.close();
+
+        if( result && ::rename( temporary.c_str(), target.c_str( )) != 0 )
+        {
+            // rename does not replace existing files on Windows
+            ::remove( target.c_str( ));
+            result = ( ::rename( temporary.c_str(), target.c_str( )) == 0 );
+        }
+        if( !result )
+            ::remove( temporary.c_str( ));
     }
     else
     {
@@ -426,34 +971,118 @@ bool VertexBufferRoot::writeToFile( const std::string& filename )
 }
 
 
-/*  Read root node from memory and continue with other nodes.  */
-void VertexBufferRoot::fromMemory( char* start )
+/*  Read the header and the nodes, and map the data arrays in place. Only
+    the header is checked unless verify is set, since hashing the arrays
+    touches all pages of a mapped file.  */
+void VertexBufferRoot::fromMemory( const char* start, const size_t size,
+                                   const bool verify )
 {
-    char** addr = &start;
-    size_t version;
-    memRead( reinterpret_cast< char* >( &version ), addr, sizeof( size_t ) );
-    if( version != FILE_VERSION )
+    FileHeader header;
+    if( size < sizeof( FileHeader ))
+        throw MeshException( "Error reading binary file. File too short." );
+    memcpy( &header, start, sizeof( FileHeader ));
+
+    if( header.magic != _magic || header.byteOrder != _byteOrder )
+        throw MeshException( "Error reading binary file. Not a kd-tree file "
+                             "for this architecture." );
+    if( header.version != FILE_VERSION )
         throw MeshException( "Error reading binary file. Version in file "
                              "does not match the expected version." );
-    size_t nodeType;
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
-    if( nodeType != ROOT_TYPE )
-        throw MeshException( "Error reading binary file. Expected the root "
-                             "node, but found something else instead." );
-    _data.fromMemory( addr );
-    VertexBufferNode::fromMemory( addr, _data );
+    if( header.fileSize != size ||
+        sizeof( FileHeader ) + header.nodeSize > header.fileSize )
+    {
+        throw MeshException( "Error reading binary file. File size does "
+                             "not match the header." );
+    }
+
+    const char* nodes = start + sizeof( FileHeader );
+    _mapArray( start, header, 0, _data.vertices );
+    _mapArray( start, header, 1, _data.colors );
+    _mapArray( start, header, 2, _data.normals );
+    _mapArray( start, header, 3, _data.indices );
+    if( verify && _checksum( header, nodes, _data ) != header.checksum )
+        throw MeshException( "Error reading binary file. Checksum mismatch." );
+    _fileChecksum = header.checksum;
+
+    if( _data.normals.size() != _data.vertices.size() ||
+        ( !_data.colors.empty() &&
+          _data.colors.size() != _data.vertices.size( )))
+    {
+        throw MeshException( "Error reading binary file. Inconsistent data "
+                             "array sizes." );
+    }
+
+    // node records are only read, memRead takes a mutable pointer
+    char* addr = const_cast< char* >( nodes );
+    VertexBufferNode::fromMemory( &addr, _data );
+    if( addr != nodes + header.nodeSize )
+        throw MeshException( "Error reading binary file. Node records do "
+                             "not match the header." );
+    _setupArenas();
+}
+
+
+/*  Write the binary representation, using the checksum of the file the tree
+    was read from, if any.  */
+void VertexBufferRoot::toStream( std:: ostream& os ) const
+{
+    std::string head;
+    uint64_t offsets[4];
+    uint32_t checksum = _fileChecksum;
+    _getHead( head, offsets, checksum );
+    _writeBinary( os, head, offsets );
+}
+
+
+/*  Write the header, the nodes and the aligned data arrays to the stream.  */
+void VertexBufferRoot::_writeBinary( std::ostream& os, const std::string& head,
+                                     const uint64_t offsets[4] ) const
+{
+    os.write( head.data(), head.size( ));
+    _writeArray( os, _data.vertices, offsets[0] );
+    _writeArray( os, _data.colors, offsets[1] );
+    _writeArray( os, _data.normals, offsets[2] );
+    _writeArray( os, _data.indices, offsets[3] );
 }
 
 
-/*  Write root node to output stream and continue with other nodes.  */
-void VertexBufferRoot::toStream( std:: ostream& os )
+/*  Serialize the header and the nodes, computing the checksum if it is 0.  */
+uint64_t VertexBufferRoot::_getHead( std::string& head, uint64_t offsets[4],
+                                     uint32_t& checksum ) const
 {
-    size_t version = FILE_VERSION;
-    os.write( reinterpret_cast< char* >( &version ), sizeof( size_t ) );
-    size_t nodeType = ROOT_TYPE;
-    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ) );
-    _data.toStream( os );
-    VertexBufferNode::toStream( os );
+    std::ostringstream nodeStream( std::ios::out | std::ios::binary );
+    VertexBufferNode::toStream( nodeStream );
+    const std::string nodes = nodeStream.str();
+
+    FileHeader header;
+    header.magic = _magic;
+    header.version = FILE_VERSION;
+    header.byteOrder = _byteOrder;
+    header.nodeSize = nodes.size();
+    header.lengths[0] = _data.vertices.size();
+    header.lengths[1] = _data.colors.size();
+    header.lengths[2] = _data.normals.size();
+    header.lengths[3] = _data.indices.size();
+
+    const uint64_t sizes[4] = { sizeof( Vertex ), sizeof( Color ),
+                                sizeof( Normal ), sizeof( ShortIndex ) };
+    uint64_t offset = sizeof( FileHeader ) + header.nodeSize;
+    for( size_t i = 0; i < 4; ++i )
+    {
+        offset = ( offset + _alignment - 1 ) / _alignment * _alignment;
+        header.offsets[i] = offset;
+        offsets[i] = offset;
+        offset += header.lengths[i] * sizes[i];
+    }
+    header.fileSize = offset;
+    if( checksum == 0 )
+        checksum = _checksum( header, nodes.data(), _data );
+    header.checksum = checksum;
+
+    head.assign( reinterpret_cast< const char* >( &header ),
+                 sizeof( FileHeader ));
+    head.append( nodes );
+    return header.fileSize;
 }
 
 }
@@ -33,6 +33,7 @@
 
 #include "vertexBufferNode.h"
 #include "vertexBufferData.h"
+#include <lunchbox/memoryMap.h>
 
 namespace mesh
 {
@@ -40,36 +41,76 @@ namespace mesh
     class VertexBufferRoot : public VertexBufferNode
     {
     public:
-        VertexBufferRoot() : VertexBufferNode(), _invertFaces(false) {}
+        VertexBufferRoot()
+            : VertexBufferNode(), _invertFaces( false ), _fileChecksum( 0 ) {}
 
         virtual void cullDraw( VertexBufferState& state ) const;
         virtual void draw( VertexBufferState& state ) const;
 
         void setupTree( VertexData& data );
         bool writeToFile( const std::string& filename );
-        bool readFromFile( const std::string& filename );
+        /** Read the binary file, or construct it from the PLY file. With
+            verify, all data of an existing binary file is checksummed. */
+        bool readFromFile( const std::string& filename,
+                           const bool verify = false );
+        bool readFromCache( const std::string& filename,
+                            const uint32_t checksum );
+        bool readFromMemory( const std::string& name,
+                             std::vector< char >& data );
         bool hasColors() const { return _data.colors.size() > 0; }
 
         void useInvertedFaces() { _invertFaces = true; }
 
         const std::string& getName() const { return _name; }
 
+        /** @return the checksum of the binary representation, or 0. */
+        uint32_t getChecksum() const { return _fileChecksum; }
+
     protected:
-        virtual void toStream( std::ostream& os );
-        virtual void fromMemory( char* start );
+        virtual void toStream( std::ostream& os ) const;
+        void fromMemory( const char* start, const size_t size,
+                         const bool verify );
 
     private:
         bool _constructFromPly( const std::string& filename );
-        bool _readBinary( std::string filename );
+        bool _readBinary( std::string filename, const bool verify );
+        uint64_t _getHead( std::string& head, uint64_t offsets[4],
+                           uint32_t& checksum ) const;
+        void _writeBinary( std::ostream& os, const std::string& head,
+                           const uint64_t offsets[4] ) const;
+        void _setupLOD();
+        float _simplify( VertexBufferNode* node, VertexData& mesh ) const;
 
         void _beginRendering( VertexBufferState& state ) const;
         void _endRendering( VertexBufferState& state ) const;
 
+        /*  A range of the global data drawn with one glMultiDrawElements.  */
+        struct Arena
+        {
+            Index vertexStart;
+            Index vertexLength;
+            Index indexStart;
+            Index indexLength;
+            VertexBufferLeaves leaves;
+        };
+        typedef std::vector< Arena > Arenas;
+
+        void _setupArenas();
+        static bool _isBefore( const VertexBufferLeaf* a,
+                               const VertexBufferLeaf* b );
+        void _drawArenas( VertexBufferState& state ) const;
+        void _uploadArena( VertexBufferState& state, const Arena& arena,
+                           GLuint buffers[2] ) const;
+
+        lunchbox::MemoryMap _map; //!< the mapped binary file, if read
+        std::vector< char > _buffer; //!< the received binary data, if any
         VertexBufferData _data;
+        Arenas           _arenas;
         bool             _invertFaces;
         std::string      _name;
+        uint32_t         _fileChecksum;
 
-        friend class eqPly::VertexBufferDist;
+        friend class eqPly::VertexBufferBlob;
     };
 }
 
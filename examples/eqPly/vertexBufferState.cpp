@@ -28,6 +28,7 @@
 
 
 #include "vertexBufferState.h"
+#include <cmath>
 
 namespace mesh 
 {
@@ -35,6 +36,8 @@ VertexBufferState::VertexBufferState( const GLEWContext* glewContext )
         : _pmvMatrix( Matrix4f::IDENTITY )
         , _glewContext( glewContext )
         , _renderMode( RENDER_MODE_DISPLAY_LIST )
+        , _maxScreenError( 0.f )
+        , _pixelScale( 0.f )
         , _useColors( false )
         , _useFrustumCulling( true )
 {
@@ -52,13 +55,56 @@ void VertexBufferState::setRenderMode( const RenderMode mode )
     _renderMode = mode;
 
     // Check if VBO funcs available, else fall back to display lists
-    if( _renderMode == RENDER_MODE_BUFFER_OBJECT && !GLEW_VERSION_1_5 )
+    if(( _renderMode == RENDER_MODE_BUFFER_OBJECT ||
+         _renderMode == RENDER_MODE_MULTI_DRAW ) && !GLEW_VERSION_1_5 )
     {
         MESHINFO << "VBO not available, using display lists" << std::endl;
         _renderMode = RENDER_MODE_DISPLAY_LIST;
     }
 }
 
+float VertexBufferState::getScreenError( const BoundingSphere& sphere,
+                                         const float error ) const
+{
+    // the last row of the projection gives the distance to the viewer for
+    // perspective projections and is constant for orthographic projections
+    const float x = _pmvMatrix( 3, 0 );
+    const float y = _pmvMatrix( 3, 1 );
+    const float z = _pmvMatrix( 3, 2 );
+    if( x == 0.f && y == 0.f && z == 0.f )
+        return error * _pixelScale / _pmvMatrix( 3, 3 );
+
+    // object space distance, independent of a scale in the modelview matrix
+    const float length = std::sqrt( x * x + y * y + z * z );
+    const float distance = ( x * sphere.x() + y * sphere.y() + z * sphere.z() +
+                             _pmvMatrix( 3, 3 )) / length - sphere.w();
+    if( distance <= 0.f )
+        return std::numeric_limits< float >::max();
+    return error * _pixelScale / distance;
+}
+
+void VertexBufferState::addBatchedDraw( const size_t arena,
+                                        const GLsizei count,
+                                        const size_t offset )
+{
+    if( _batches.size() <= arena )
+        _batches.resize( arena + 1 );
+
+    Batch& batch = _batches[ arena ];
+    batch.counts.push_back( count );
+    batch.offsets.push_back( reinterpret_cast< const GLvoid* >( offset ));
+}
+
+void VertexBufferState::resetBatches()
+{
+    // keep the allocations for the next frame
+    for( Batches::iterator i = _batches.begin(); i != _batches.end(); ++i )
+    {
+        i->counts.clear();
+        i->offsets.clear();
+    }
+}
+
 void VertexBufferState::resetRegion()
 {
     _region[0] = std::numeric_limits< float >::max();
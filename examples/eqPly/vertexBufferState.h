@@ -33,6 +33,7 @@
 
 #include "typedefs.h"
 #include <map>
+#include <vector>
 
 #ifdef EQUALIZER
 #  include <eq/eq.h>
@@ -67,11 +68,39 @@ namespace mesh
         void setRange( const Range& range ) { _range = range; }
         const Range& getRange() const { return _range; }
 
+        /*  Simplified nodes are drawn if their projected error in pixels is
+            below this threshold, 0 disables simplification.  */
+        void setMaxScreenError( const float pixels )
+            { _maxScreenError = pixels; }
+        float getMaxScreenError() const { return _maxScreenError; }
+
+        /*  The size of one unit at distance one in pixels, i.e., the (1,1)
+            element of the projection matrix times half the viewport height.*/
+        void setPixelScale( const float scale ) { _pixelScale = scale; }
+
+        /*  @return the projected size of an object space error at the nearest
+                    point of the given bounding sphere, in pixels.  */
+        float getScreenError( const BoundingSphere& sphere,
+                              const float error ) const;
+
         void resetRegion();
         void updateRegion( const BoundingBox& box );
         virtual void declareRegion( const Vector4f& region ) {}
         Vector4f getRegion() const;
 
+        /*  The queued draws of one arena in RENDER_MODE_MULTI_DRAW.  */
+        struct Batch
+        {
+            std::vector< GLsizei >       counts;
+            std::vector< const GLvoid* > offsets; //!< into the index buffer
+        };
+        typedef std::vector< Batch > Batches;
+
+        void addBatchedDraw( const size_t arena, const GLsizei count,
+                             const size_t offset );
+        Batches& getBatches() { return _batches; }
+        void resetBatches();
+
         virtual GLuint getDisplayList( const void* key ) = 0;
         virtual GLuint newDisplayList( const void* key ) = 0;
         virtual GLuint getBufferObject( const void* key ) = 0;
@@ -89,6 +118,9 @@ namespace mesh
         const GLEWContext* const _glewContext;
         RenderMode    _renderMode;
         Vector4f      _region; //!< normalized x1 y1 x2 y2 region from cullDraw 
+        float         _maxScreenError; //!< LOD threshold in pixels
+        float         _pixelScale; //!< pixels per unit at distance one
+        Batches       _batches; //!< per arena, for RENDER_MODE_MULTI_DRAW
         bool          _useColors;
         bool          _useFrustumCulling;
         
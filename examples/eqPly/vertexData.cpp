@@ -30,18 +30,215 @@
 #include "vertexData.h"
 #include "ply.h"
 
+#include <lunchbox/memoryMap.h>
+
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#include <sstream>
 
 #if (( __GNUC__ > 4 ) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 4)) )
 #  include <parallel/algorithm>
 using __gnu_parallel::sort;
+using __gnu_parallel::nth_element;
 #else
 using std::sort;
+using std::nth_element;
 #endif
 
 using namespace mesh;
 
+namespace
+{
+/*  Layout of a binary PLY file with fixed-size vertices and triangles.  */
+struct _BinaryLayout
+{
+    _BinaryLayout() : nVertices( 0 ), vertexSize( 0 ), doubles( false ),
+                      nFaces( 0 ), countSize( 0 ), dataOffset( 0 )
+    {
+        for( size_t i = 0; i < 6; ++i )
+            offsets[i] = size_t( -1 );
+    }
+
+    size_t nVertices;
+    size_t vertexSize;
+    size_t offsets[6]; // x, y, z, red, green, blue within a vertex
+    bool   doubles;    // coordinates are stored as double
+    size_t nFaces;
+    size_t countSize;  // size of the vertex count of a face
+    size_t dataOffset; // start of the vertex data in the file
+};
+
+size_t _getTypeSize( const std::string& type )
+{
+    if( type == "char" || type == "uchar" || type == "int8" ||
+        type == "uint8" )
+    {
+        return 1;
+    }
+    if( type == "short" || type == "ushort" || type == "int16" ||
+        type == "uint16" )
+    {
+        return 2;
+    }
+    if( type == "int" || type == "uint" || type == "float" ||
+        type == "int32" || type == "uint32" || type == "float32" )
+    {
+        return 4;
+    }
+    if( type == "double" || type == "float64" )
+        return 8;
+    return 0;
+}
+
+/*  Parse the header, true if the file can be decoded by readBinaryPlyFile.  */
+bool _parseBinaryHeader( const char* data, const size_t size,
+                         _BinaryLayout& layout )
+{
+    static const char* names[] = { "x", "y", "z", "red", "green", "blue" };
+    const uint16_t one = 1;
+    const std::string format = *reinterpret_cast< const uint8_t* >( &one ) ?
+                               "binary_little_endian" : "binary_big_endian";
+
+    const std::string header( data, std::min( size, size_t( 65536 )));
+    const size_t end = header.find( "\nend_header" );
+    const size_t eol = header.find( '\n', end + 1 );
+    if( end == std::string::npos || eol == std::string::npos ||
+        header.compare( 0, 4, "ply\n" ) != 0 )
+    {
+        return false;
+    }
+    layout.dataOffset = eol + 1;
+
+    enum { ELEMENT_NONE, ELEMENT_VERTEX, ELEMENT_FACE } element = ELEMENT_NONE;
+    bool hasFormat = false;
+    bool hasCoordinate = false;
+    std::istringstream lines( header.substr( 4, end - 4 ));
+    std::string line;
+
+    while( std::getline( lines, line ))
+    {
+        std::istringstream words( line );
+        std::string keyword;
+        words >> keyword;
+
+        if( keyword == "format" )
+        {
+            std::string value;
+            words >> value;
+            if( value != format )
+                return false;
+            hasFormat = true;
+        }
+        else if( keyword == "element" )
+        {
+            std::string name;
+            size_t count = 0;
+            words >> name >> count;
+            if( name == "vertex" && element == ELEMENT_NONE )
+            {
+                element = ELEMENT_VERTEX;
+                layout.nVertices = count;
+            }
+            else if( name == "face" && element == ELEMENT_VERTEX )
+            {
+                element = ELEMENT_FACE;
+                layout.nFaces = count;
+            }
+            else
+                return false;
+        }
+        else if( keyword == "property" )
+        {
+            std::string type;
+            words >> type;
+            if( element == ELEMENT_VERTEX )
+            {
+                std::string name;
+                words >> name;
+                const size_t typeSize = _getTypeSize( type );
+                if( typeSize == 0 )
+                    return false;
+
+                for( size_t i = 0; i < 6; ++i )
+                {
+                    if( name != names[i] )
+                        continue;
+                    if( i >= 3 && typeSize != 1 )
+                        return false;
+                    if( i < 3 )
+                    {
+                        // floating point coordinates of one type only
+                        const bool isDouble = ( type == "double" ||
+                                                type == "float64" );
+                        if( !isDouble && type != "float" &&
+                            type != "float32" )
+                        {
+                            return false;
+                        }
+                        if( hasCoordinate && isDouble != layout.doubles )
+                            return false;
+                        layout.doubles = isDouble;
+                        hasCoordinate = true;
+                    }
+                    layout.offsets[i] = layout.vertexSize;
+                }
+                layout.vertexSize += typeSize;
+            }
+            else if( element == ELEMENT_FACE && type == "list" &&
+                     layout.countSize == 0 )
+            {
+                std::string countType, indexType, name;
+                words >> countType >> indexType >> name;
+                layout.countSize = _getTypeSize( countType );
+                if( _getTypeSize( indexType ) != 4 || layout.countSize > 4 ||
+                    ( name != "vertex_indices" && name != "vertex_index" ))
+                {
+                    return false;
+                }
+            }
+            else
+                return false;
+        }
+    }
+
+    if( !hasFormat || element != ELEMENT_FACE || layout.countSize == 0 )
+        return false;
+
+    // all coordinates present, colors complete or absent
+    for( size_t i = 0; i < 3; ++i )
+        if( layout.offsets[i] == size_t( -1 ))
+            return false;
+    const bool hasRed = layout.offsets[3] != size_t( -1 );
+    if( hasRed != ( layout.offsets[4] != size_t( -1 )) ||
+        hasRed != ( layout.offsets[5] != size_t( -1 )))
+    {
+        return false;
+    }
+
+    const size_t faceSize = layout.countSize + 3 * sizeof( int32_t );
+    return layout.dataOffset + layout.nVertices * layout.vertexSize +
+           layout.nFaces * faceSize == size;
+}
+
+template< class T > T _read( const char* data )
+{
+    T value;
+    memcpy( &value, data, sizeof( T ));
+    return value;
+}
+
+size_t _readCount( const char* data, const size_t size )
+{
+    switch( size )
+    {
+    case 1:  return _read< uint8_t >( data );
+    case 2:  return _read< uint16_t >( data );
+    default: return _read< uint32_t >( data );
+    }
+}
+}
+
 /*  Contructor.  */
 VertexData::VertexData()
     : _invertFaces( false )
@@ -135,6 +332,16 @@ void VertexData::readTriangles( PlyFile* file, const int nFaces )
             throw MeshException( "Error reading PLY file. Encountered a "
                                  "face which does not have three vertices." );
         }
+        for( int j = 0; j < 3; ++j )
+        {
+            if( face.vertices[j] < 0 ||
+                size_t( face.vertices[j] ) >= vertices.size( ))
+            {
+                free( face.vertices );
+                throw MeshException( "Error reading PLY file. Encountered a "
+                                     "face index beyond the vertices." );
+            }
+        }
         triangles.push_back( Triangle( face.vertices[ind1],
                                        face.vertices[1],
                                        face.vertices[ind3] ) );
@@ -145,9 +352,89 @@ void VertexData::readTriangles( PlyFile* file, const int nFaces )
 }
 
 
+/*  Decode a binary triangle-only PLY file in the host byte order from a
+    memory map in parallel. Returns false if the file has a different layout,
+    which is then read by the generic PLY reader.  */
+bool VertexData::readBinaryPlyFile( const std::string& filename )
+{
+    lunchbox::MemoryMap file;
+    const char* data = static_cast< const char* >( file.map( filename ));
+    if( !data )
+        return false;
+
+    _BinaryLayout layout;
+    if( !_parseBinaryHeader( data, file.getSize(), layout ))
+        return false;
+
+    const bool hasColors = layout.offsets[3] != size_t( -1 );
+    const char* vertexData = data + layout.dataOffset;
+    const ssize_t nVertices = ssize_t( layout.nVertices );
+
+    vertices.resize( nVertices );
+    if( hasColors )
+        colors.resize( nVertices );
+    else
+        colors.clear();
+
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nVertices; ++i )
+    {
+        const char* vertex = vertexData + i * layout.vertexSize;
+        for( size_t j = 0; j < 3; ++j )
+        {
+            const char* value = vertex + layout.offsets[j];
+            vertices[i][j] = layout.doubles ? float( _read< double >( value )) :
+                                              _read< float >( value );
+        }
+        if( hasColors )
+            for( size_t j = 0; j < 3; ++j )
+                colors[i][j] = _read< uint8_t >( vertex + layout.offsets[3+j] );
+    }
+
+    const size_t faceSize = layout.countSize + 3 * sizeof( int32_t );
+    const char* faceData = vertexData + layout.nVertices * layout.vertexSize;
+    const ssize_t nFaces = ssize_t( layout.nFaces );
+    const size_t ind1 = _invertFaces ? 2 : 0;
+    const size_t ind3 = _invertFaces ? 0 : 2;
+    int64_t nInvalid = 0;
+
+    triangles.resize( nFaces );
+#pragma omp parallel for reduction( +: nInvalid )
+    for( ssize_t i = 0; i < nFaces; ++i )
+    {
+        const char* face = faceData + i * faceSize;
+        if( _readCount( face, layout.countSize ) != 3 )
+        {
+            ++nInvalid;
+            continue;
+        }
+
+        const char* indices = face + layout.countSize;
+        int32_t index[3];
+        memcpy( index, indices, sizeof( index ));
+        for( size_t j = 0; j < 3; ++j )
+            if( index[j] < 0 || index[j] >= nVertices )
+                ++nInvalid; // reported by the generic reader
+        triangles[i] = Triangle( index[ind1], index[1], index[ind3] );
+    }
+
+    if( nInvalid > 0 )
+    {
+        vertices.clear();
+        colors.clear();
+        triangles.clear();
+        return false;
+    }
+    return true;
+}
+
+
 /*  Open a PLY file and read vertex, color and index data.  */
 bool VertexData::readPlyFile( const std::string& filename )
 {
+    if( readBinaryPlyFile( filename ))
+        return true;
+
     int     nPlyElems;
     char**  elemNames;
     int     fileType;
@@ -424,3 +711,18 @@ void VertexData::sort( const Index start, const Index length, const Axis axis )
     ::sort( triangles.begin() + start, triangles.begin() + start + length,
             _TriangleSort( *this, axis ) );
 }
+
+
+/*  Partition the index data from start to start + length along the given axis
+    at the median, without sorting the two halves.  */
+void VertexData::partition( const Index start, const Index length,
+                            const Axis axis )
+{
+    MESHASSERT( length > 0 );
+    MESHASSERT( start + length <= triangles.size() );
+
+    ::nth_element( triangles.begin() + start,
+                   triangles.begin() + start + length / 2,
+                   triangles.begin() + start + length,
+                   _TriangleSort( *this, axis ) );
+}
@@ -49,6 +49,8 @@ namespace mesh
 
         bool readPlyFile( const std::string& file );
         void sort( const Index start, const Index length, const Axis axis );
+        void partition( const Index start, const Index length,
+                        const Axis axis );
         void scale( const float baseSize = 2.0f );
         void calculateNormals();
         void calculateBoundingBox();
@@ -66,6 +68,7 @@ namespace mesh
         void readVertices( PlyFile* file, const int nVertices, 
                            const bool readColors );
         void readTriangles( PlyFile* file, const int nFaces );
+        bool readBinaryPlyFile( const std::string& file );
 
         BoundingBox _boundingBox;
         bool        _invertFaces;
@@ -0,0 +1,145 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests writing and reading frame recordings, with and without index
+
+#include <test.h>
+
+#include <eq/client/frameRecorder.h>
+#include <lunchbox/rng.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+const size_t _nRecords = 20;
+const std::string _filename = "frameRecorder.eqr";
+const std::string _truncatedName = "frameRecorder_truncated.eqr";
+
+typedef std::vector< uint8_t > Data;
+
+/** Check that the recording contains the first nRecords records. */
+void _testRecording( const eq::FrameRecording& recording,
+                     const std::vector< eq::FrameRecord >& records,
+                     const std::vector< Data >& datas, const size_t nRecords )
+{
+    TESTINFO( recording.getNumRecords() == nRecords,
+              recording.getNumRecords() << " != " << nRecords );
+    for( size_t i = 0; i < nRecords; ++i )
+    {
+        const eq::FrameRecord& record = recording.getRecord( i );
+        TEST( record.frameDataID == records[i].frameDataID );
+        TEST( record.frameNumber == records[i].frameNumber );
+        TEST( record.size == datas[i].size( ));
+        TEST( record.pvp == records[i].pvp );
+        TEST( record.useAlpha == records[i].useAlpha );
+        TEST( datas[i].empty() ||
+              memcmp( recording.getData( i ), &datas[i][0],
+                      datas[i].size( )) == 0 );
+    }
+}
+
+/** Write the first size bytes of the file to a new file. */
+void _truncate( const Data& file, const size_t size )
+{
+    TEST( size <= file.size( ));
+    std::ofstream out( _truncatedName.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc );
+    out.write( reinterpret_cast< const char* >( &file[0] ), size );
+    TEST( out.good( ));
+}
+}
+
+int main( int, char** )
+{
+    lunchbox::RNG rng;
+    std::vector< eq::FrameRecord > records( _nRecords );
+    std::vector< Data > datas( _nRecords );
+
+    eq::FrameRecorder recorder;
+    TEST( !recorder.isOpen( ));
+    TEST( !recorder.append( records[0], 0 ));
+    TEST( recorder.open( _filename ));
+    TEST( recorder.isOpen( ));
+
+    // More records than the queue holds, with sizes not aligned to 8 bytes
+    for( size_t i = 0; i < _nRecords; ++i )
+    {
+        Data& data = datas[i];
+        data.resize( i * 1001 );
+        for( size_t j = 0; j < data.size(); ++j )
+            data[j] = rng.get< uint8_t >();
+        Data buffer( data );
+
+        eq::FrameRecord& record = records[i];
+        record.frameDataID = eq::uint128_t( rng.get< uint64_t >(), i );
+        record.size = data.size();
+        record.frameNumber = uint32_t( i / 3 );
+        record.buffers = 1;
+        record.pvp = eq::PixelViewport( 0, 0, int32_t( i ), 1 );
+        record.useAlpha = i % 2;
+        record.reserved = 0;
+        TEST( recorder.append( record, buffer.empty() ? 0 : &buffer[0] ));
+        buffer.assign( buffer.size(), 0xff ); // queued data is a copy
+    }
+    recorder.flush();
+    TEST( recorder.getNumRecords() == _nRecords );
+    recorder.close();
+    TEST( !recorder.isOpen( ));
+
+    // Indexed recording
+    eq::FrameRecording recording;
+    TEST( recording.open( _filename ));
+    _testRecording( recording, records, datas, _nRecords );
+    recording.close();
+
+    std::ifstream in( _filename.c_str(), std::ios::in | std::ios::binary );
+    const Data file( (std::istreambuf_iterator< char >( in )),
+                     std::istreambuf_iterator< char >( ));
+    TEST( !file.empty( ));
+
+    // Without index and footer, e.g., after a crash: all records are found
+    const size_t footerSize = 24; // offset, count, magic and version
+    const size_t recordsEnd = file.size() - footerSize -
+                              _nRecords * sizeof( uint64_t );
+    _truncate( file, recordsEnd );
+    TEST( recording.open( _truncatedName ));
+    _testRecording( recording, records, datas, _nRecords );
+    recording.close();
+
+    // A truncated last record is ignored, cut more than its padding
+    _truncate( file, recordsEnd - 16 );
+    TEST( recording.open( _truncatedName ));
+    _testRecording( recording, records, datas, _nRecords - 1 );
+    recording.close();
+
+    // Only the file header: magic, version and reserved
+    _truncate( file, 16 );
+    TEST( recording.open( _truncatedName ));
+    TEST( recording.getNumRecords() == 0 );
+    recording.close();
+
+    // Not a recording
+    _truncate( file, 8 );
+    TEST( !recording.open( _truncatedName ));
+
+    ::remove( _filename.c_str( ));
+    ::remove( _truncatedName.c_str( ));
+    return EXIT_SUCCESS;
+}
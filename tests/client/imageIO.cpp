@@ -21,9 +21,137 @@
 
 #include <eq/client/nodeFactory.h>
 #include <eq/client/image.h>
+#include <eq/client/imageWriter.h>
 #include <eq/client/init.h>
+#include <eq/client/pixelData.h>
+#include <eq/client/detail/rgbFile.h>
 #include <lunchbox/file.h>
 #include <lunchbox/memoryMap.h>
+#include <lunchbox/plugins/compressor.h>
+#include <lunchbox/rng.h>
+
+namespace
+{
+/** @return true if both images have the same pixel data for the buffer. */
+bool _isEqual( const eq::Image& a, const eq::Image& b,
+               const eq::Frame::Buffer buffer )
+{
+    const uint32_t size = a.getPixelDataSize( buffer );
+    return size == b.getPixelDataSize( buffer ) &&
+           memcmp( a.getPixelPointer( buffer ), b.getPixelPointer( buffer ),
+                   size ) == 0;
+}
+
+/**
+ * Write random pixel data of the given format uncompressed and compressed, and
+ * compare the read data with the original. Depth files store the bytes of a
+ * value in the channel order B, G, R, A, i.e., bytes 0 and 2 are swapped.
+ */
+void _testFormat( const eq::Frame::Buffer buffer, const uint32_t format,
+                  const uint32_t pixelSize )
+{
+    const eq::PixelViewport pvp( 0, 0, 61, 37 );
+    std::vector< uint8_t > pixels( pvp.getArea() * pixelSize );
+    lunchbox::RNG rng;
+    for( size_t i = 0; i < pixels.size(); ++i )
+        // uniform areas to produce repeat packets
+        pixels[i] = ( i % 97 ) < 40 ? 42 : rng.get< uint8_t >();
+
+    eq::PixelData data;
+    data.internalFormat = buffer == eq::Frame::BUFFER_DEPTH ?
+        EQ_COMPRESSOR_DATATYPE_DEPTH : EQ_COMPRESSOR_DATATYPE_RGBA;
+    data.externalFormat = format;
+    data.pixelSize = pixelSize;
+    data.pvp = pvp;
+    data.pixels = &pixels[0];
+
+    eq::Image image;
+    image.setPixelViewport( pvp );
+    image.setPixelData( buffer, data );
+    TEST( image.hasPixelData( buffer ));
+
+    const std::string name = "images/out_format.rgb";
+    const std::string compressedName = "images/out_rle_format.rgb";
+    TEST( image.writeImage( name, buffer ));
+    {
+        eq::ImageWriter writer( 1, image.getPixelDataSize( buffer ));
+        writer.setCompression( true );
+        TEST( writer.writeImage( image, buffer, compressedName ));
+        writer.flush();
+        TEST( writer.getNumDropped() == 0 );
+        TEST( writer.getNumFailed() == 0 );
+    }
+
+    eq::Image raw;
+    eq::Image compressed;
+    TESTINFO( raw.readImage( name, buffer ), format );
+    TESTINFO( compressed.readImage( compressedName, buffer ), format );
+    TESTINFO( raw.getExternalFormat( buffer ) == format, format );
+    TESTINFO( compressed.getExternalFormat( buffer ) == format, format );
+    TESTINFO( _isEqual( raw, compressed, buffer ), format );
+
+    lunchbox::MemoryMap rawFile;
+    lunchbox::MemoryMap compressedFile;
+    TEST( rawFile.map( name ));
+    TEST( compressedFile.map( compressedName ));
+    TESTINFO( compressedFile.getSize() < rawFile.getSize(),
+              compressedFile.getSize() << " >= " << rawFile.getSize( ));
+
+    static const size_t colorOrder[] = { 0, 1, 2, 3 };
+    static const size_t depthOrder[] = { 2, 1, 0, 3 };
+    const size_t* order = buffer == eq::Frame::BUFFER_DEPTH ? depthOrder :
+                                                              colorOrder;
+    const uint8_t* read = raw.getPixelPointer( buffer );
+    for( size_t i = 0; i < pixels.size(); ++i )
+    {
+        const size_t channel = i % pixelSize;
+        TESTINFO( read[i] == pixels[ i - channel + order[ channel ]],
+                  format << " byte " << i );
+    }
+}
+
+/** Compare the SSE2 with the scalar planarize kernel. */
+void _testPlanarize()
+{
+    if( eq::detail::getSIMD() < eq::detail::SIMD_SSE2 )
+    {
+        std::cout << "Skipping planarize test, no SSE2 support" << std::endl;
+        return;
+    }
+
+    const eq::detail::PlanarizeFunc scalar =
+        eq::detail::getPlanarize( 1, 4, eq::detail::SIMD_NONE );
+    const eq::detail::PlanarizeFunc sse2 =
+        eq::detail::getPlanarize( 1, 4, eq::detail::SIMD_SSE2 );
+    TEST( scalar && sse2 && scalar != sse2 );
+
+    static const unsigned rgba[] = { 0, 1, 2, 3 };
+    static const unsigned bgra[] = { 2, 1, 0, 3 };
+    // all tail lengths of the 16 pixel loop, and unaligned input
+    const size_t sizes[] = { 1, 15, 16, 17, 31, 32, 33, 1037 };
+    lunchbox::RNG rng;
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( size_t ); ++i )
+    {
+        const size_t nPixels = sizes[i];
+        std::vector< uint8_t > data( nPixels * 4 + 1 );
+        for( size_t j = 0; j < data.size(); ++j )
+            data[j] = rng.get< uint8_t >();
+
+        std::vector< uint8_t > expected( nPixels * 4 );
+        std::vector< uint8_t > result( nPixels * 4 );
+        for( size_t offset = 0; offset < 2; ++offset )
+        {
+            scalar( &expected[0], &data[offset], nPixels, rgba );
+            sse2( &result[0], &data[offset], nPixels, rgba );
+            TESTINFO( expected == result, nPixels << " RGBA" );
+
+            scalar( &expected[0], &data[offset], nPixels, bgra );
+            sse2( &result[0], &data[offset], nPixels, bgra );
+            TESTINFO( expected == result, nPixels << " BGRA" );
+        }
+    }
+}
+}
 
 int main( int argc, char **argv )
 {
@@ -71,8 +199,39 @@ int main( int argc, char **argv )
         TESTINFO( orig.getSize() > 512, inFilename );
         TESTINFO( memcmp( origPtr+512, copyPtr+512, orig.getSize() - 512 ) == 0,
                   inFilename );
+
+        // RLE compressed files decode to the same pixels
+        const std::string rleFilename = lunchbox::getDirname( inFilename ) +
+            "/out_rle_" + lunchbox::getFilename( inFilename );
+        {
+            eq::ImageWriter writer;
+            writer.setCompression( true );
+            TESTINFO( writer.writeImage( image, eq::Frame::BUFFER_COLOR,
+                                         rleFilename ), inFilename );
+        }
+        eq::Image decoded;
+        TESTINFO( decoded.readImage( rleFilename, eq::Frame::BUFFER_COLOR ),
+                  inFilename );
+        TESTINFO( _isEqual( image, decoded, eq::Frame::BUFFER_COLOR ),
+                  inFilename );
     }
 
+    // Failed writes are counted
+    {
+        eq::ImageWriter writer;
+        TEST( writer.writeImage( image, eq::Frame::BUFFER_COLOR,
+                                 "images/missing/out_failed.rgb" ));
+        writer.flush();
+        TEST( writer.getNumFailed() == 1 );
+        TEST( writer.getNumDropped() == 0 );
+    }
+
+    _testFormat( eq::Frame::BUFFER_COLOR, EQ_COMPRESSOR_DATATYPE_RGB, 3 );
+    _testFormat( eq::Frame::BUFFER_COLOR, EQ_COMPRESSOR_DATATYPE_RGBA, 4 );
+    _testFormat( eq::Frame::BUFFER_DEPTH,
+                 EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT, 4 );
+    _testPlanarize();
+
     eq::exit();
     return EXIT_SUCCESS;
 }
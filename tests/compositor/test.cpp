@@ -23,11 +23,120 @@
 #include <eq/client/image.h>
 #include <eq/client/init.h>
 #include <eq/client/nodeFactory.h>
+#include <eq/client/detail/cpuCompositor.h>
 #include <eq/fabric/drawableConfig.h>
 #include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+
+#include <vector>
 
 // Tests the functionality of the compositor and computes the performance.
 
+namespace
+{
+// Span lengths covering full vectors and all tail lengths of the kernels
+const size_t _spans[] = { 1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 47, 1037 };
+const size_t _nSpans = sizeof( _spans ) / sizeof( size_t );
+
+template< class T > void _fill( std::vector< T >& data, lunchbox::RNG& rng,
+                                const T base, const T range )
+{
+    for( size_t i = 0; i < data.size(); ++i )
+        data[i] = base + rng.get< T >() % range;
+}
+
+template<> void _fill( std::vector< float >& data, lunchbox::RNG& rng,
+                       const float, const float )
+{
+    for( size_t i = 0; i < data.size(); ++i )
+        data[i] = float( rng.get< uint16_t >( )) / 65535.f;
+}
+
+/**
+ * Blend random spans with the scalar and the given SIMD kernel, starting at
+ * all pixel offsets of a vector, and compare the results. The values differ
+ * by at most maxDelta in their integer representation.
+ */
+template< class T >
+void _testMergeBlend( const eq::detail::SIMD simd, const size_t pixelSize,
+                      const T base, const T range, const int maxDelta )
+{
+    const eq::detail::MergeKernels& scalar =
+        eq::detail::getMergeKernels( eq::detail::SIMD_NONE );
+    const eq::detail::MergeKernels& kernels =
+        eq::detail::getMergeKernels( simd );
+    const eq::detail::MergeBlendFunc reference =
+        scalar.getMergeBlend( pixelSize );
+    const eq::detail::MergeBlendFunc mergeBlend =
+        kernels.getMergeBlend( pixelSize );
+    TEST( reference && mergeBlend );
+
+    const size_t nChannels = pixelSize / sizeof( T );
+    lunchbox::RNG rng;
+
+    for( size_t i = 0; i < _nSpans; ++i )
+    {
+        for( size_t offset = 0; offset < 4; ++offset )
+        {
+            const size_t nValues = ( _spans[i] + offset ) * nChannels;
+            std::vector< T > source( nValues );
+            std::vector< T > dest( nValues );
+            _fill( source, rng, base, range );
+            _fill( dest, rng, base, range );
+            std::vector< T > expected( dest );
+
+            const size_t start = offset * nChannels;
+            reference( &expected[ start ], &source[ start ], _spans[i] );
+            mergeBlend( &dest[ start ], &source[ start ], _spans[i] );
+
+            for( size_t j = 0; j < nValues; ++j )
+            {
+                if( maxDelta == 0 )
+                {
+                    TESTINFO( dest[j] == expected[j],
+                              eq::detail::getSIMDName( kernels.simd ) << ' '
+                              << pixelSize << "b span " << _spans[i] << '@'
+                              << offset << " value " << j );
+                }
+                else
+                {
+                    const int delta = int( dest[j] ) - int( expected[j] );
+                    TESTINFO( delta >= -maxDelta && delta <= maxDelta,
+                              eq::detail::getSIMDName( kernels.simd ) << ' '
+                              << pixelSize << "b span " << _spans[i] << '@'
+                              << offset << " value " << j << " delta "
+                              << delta );
+                }
+            }
+        }
+    }
+}
+
+void _testMergeBlendKernels()
+{
+    const eq::detail::SIMD simds[] = { eq::detail::SIMD_SSE2,
+                                       eq::detail::SIMD_AVX2 };
+    for( size_t i = 0; i < 2; ++i )
+    {
+        const eq::detail::SIMD simd = simds[i];
+        if( eq::detail::getMergeKernels( simd ).simd != simd )
+        {
+            std::cout << "Skipping blend kernel test, no "
+                      << eq::detail::getSIMDName( simd ) << " support"
+                      << std::endl;
+            continue;
+        }
+
+        // 8 bit RGBA: bit-identical
+        _testMergeBlend< uint8_t >( simd, 4, 0, 255, 0 );
+        // 16 bit float RGBA in [0.25, 1[: rounding of the last bit may differ
+        _testMergeBlend< uint16_t >( simd, 8, 0x3400, 0x800, 1 );
+        // 32 bit float RGBA: bit-identical, no fused multiply-add is used
+        _testMergeBlend< float >( simd, 16, 0.f, 1.f, 0 );
+    }
+}
+}
+
 int main( int argc, char **argv )
 {
     eq::NodeFactory nodeFactory;
@@ -146,6 +255,54 @@ int main( int argc, char **argv )
               << 5000.0f * size * 2.f / time / 1024.0f / 1024.0f << " MB/s)"
               << std::endl;
 
+    // 2b) DB assembly equivalence with a scalar reference
+    frames.clear();
+    frames.push_back( &frame );
+
+    eq::PixelViewport destPVP;
+    for( eq::ImagesCIter i = images.begin(); i != images.end(); ++i )
+        destPVP.merge( (*i)->getPixelViewport( ));
+
+    const size_t nPixels = destPVP.getArea();
+    std::vector< uint32_t > colorBuffer( nPixels, 0 );
+    std::vector< uint32_t > depthBuffer( nPixels, 0xffffffffu );
+    std::vector< uint32_t > refColor( colorBuffer );
+    std::vector< uint32_t > refDepth( depthBuffer );
+
+    eq::PixelViewport outPVP;
+    TEST( eq::Compositor::mergeFramesCPU( frames, false, &colorBuffer[0],
+                                          uint32_t( nPixels * 4 ),
+                                          &depthBuffer[0],
+                                          uint32_t( nPixels * 4 ), outPVP ));
+    TEST( outPVP == destPVP );
+
+    for( eq::ImagesCIter i = images.begin(); i != images.end(); ++i )
+    {
+        const eq::Image* input = *i;
+        const eq::PixelViewport& pvp = input->getPixelViewport();
+        const uint32_t* color = reinterpret_cast< const uint32_t* >(
+            input->getPixelPointer( eq::Frame::BUFFER_COLOR ));
+        const uint32_t* depth = reinterpret_cast< const uint32_t* >(
+            input->getPixelPointer( eq::Frame::BUFFER_DEPTH ));
+
+        for( int32_t y = 0; y < pvp.h; ++y )
+        {
+            for( int32_t x = 0; x < pvp.w; ++x )
+            {
+                const size_t in = y * pvp.w + x;
+                const size_t out = ( pvp.y - destPVP.y + y ) * destPVP.w +
+                                   pvp.x - destPVP.x + x;
+                if( refDepth[ out ] > depth[ in ] )
+                {
+                    refColor[ out ] = color[ in ];
+                    refDepth[ out ] = depth[ in ];
+                }
+            }
+        }
+    }
+    TEST( colorBuffer == refColor );
+    TEST( depthBuffer == refDepth );
+
     // 3) alpha-blend assembly test
 #ifdef EQ_USE_PARACOMP_BLEND
      std::cout << "Using Paracomp PC compositing (blend)" << std::endl;
@@ -193,6 +350,9 @@ int main( int argc, char **argv )
     std::cout << argv[0] << ": Alpha 15 images: " << time << " ms (" 
          << 5000.0f * size / time / 1024.0f / 1024.0f << " MB/s)" << std::endl;
     
+    // 4) blend kernel equivalence with the scalar kernels
+    _testMergeBlendKernels();
+
     TEST( eq::exit( ));
 
     return EXIT_SUCCESS;
@@ -0,0 +1,183 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the delta encoding of render contexts between two caches, with a
+// changing number of tasks per frame and a reader missing a frame
+
+#include <test.h>
+#include <eq/fabric/renderContextCache.h>
+
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <lunchbox/plugins/compressor.h>
+#include <lunchbox/rng.h>
+
+namespace
+{
+/** Collects the written data in memory. */
+class OStream : public co::DataOStream
+{
+public:
+    OStream() { _enable(); }
+
+    const std::vector< uint8_t >& finish() { disable(); return _data; }
+
+protected:
+    virtual void sendData( const void* buffer, const uint64_t size,
+                           const bool )
+    {
+        const uint8_t* data = static_cast< const uint8_t* >( buffer );
+        _data.insert( _data.end(), data, data + size );
+    }
+
+private:
+    std::vector< uint8_t > _data;
+};
+
+/** Reads the data of an OStream. */
+class IStream : public co::DataIStream
+{
+public:
+    IStream( const std::vector< uint8_t >& data )
+        : _data( data ), _read( false ) {}
+
+    virtual size_t nRemainingBuffers() const { return _read ? 0 : 1; }
+    virtual eq::uint128_t getVersion() const { return co::VERSION_NONE; }
+    virtual co::NodePtr getMaster() { return 0; }
+
+protected:
+    virtual bool getNextBuffer( uint32_t& compressor, uint32_t& nChunks,
+                                const void** chunkData, uint64_t& size )
+    {
+        if( _read || _data.empty( ))
+            return false;
+        _read = true;
+        compressor = EQ_COMPRESSOR_NONE;
+        nChunks = 1;
+        *chunkData = &_data[0];
+        size = _data.size();
+        return true;
+    }
+
+private:
+    const std::vector< uint8_t >& _data;
+    bool _read;
+};
+
+typedef std::vector< eq::fabric::RenderContext > RenderContexts;
+
+/** @return the contexts of a frame, changing some of them randomly. */
+RenderContexts _newFrame( const RenderContexts& last, const size_t nTasks )
+{
+    lunchbox::RNG rng;
+    const eq::uint128_t frameID( rng.get< uint64_t >(), rng.get< uint64_t >());
+
+    RenderContexts contexts( last );
+    contexts.resize( nTasks );
+    for( size_t i = 0; i < nTasks; ++i )
+    {
+        eq::fabric::RenderContext& context = contexts[i];
+        context.frameID = frameID;
+        context.taskID = uint32_t( i );
+        if( i >= last.size() || rng.get< bool >( ))
+        {
+            context.pvp = eq::fabric::PixelViewport( 0, 0,
+                                                     rng.get< uint16_t >(),
+                                                     rng.get< uint16_t >( ));
+        }
+        if( rng.get< bool >( ))
+            context.range = eq::fabric::Range( 0.f, rng.get< float >( ));
+        if( rng.get< bool >( ))
+            context.headTransform.set_translation( rng.get< float >(), 0.f,
+                                                   0.f );
+    }
+    return contexts;
+}
+
+void _testEqual( const eq::fabric::RenderContext& a,
+                 const eq::fabric::RenderContext& b )
+{
+    TEST( a.frameID == b.frameID );
+    TEST( a.taskID == b.taskID );
+    TESTINFO( a.pvp == b.pvp, a.pvp << " != " << b.pvp );
+    TEST( a.range == b.range );
+    TEST( a.headTransform == b.headTransform );
+    TEST( a.frustum == b.frustum );
+    TEST( a.zoom == b.zoom );
+    TEST( a.buffer == b.buffer );
+}
+
+size_t _transmit( eq::fabric::RenderContextCache& writer,
+                  eq::fabric::RenderContextCache& reader,
+                  const RenderContexts& contexts )
+{
+    OStream os;
+    writer.rewind();
+    for( size_t i = 0; i < contexts.size(); ++i )
+        writer.write( os, contexts[i] );
+    const std::vector< uint8_t >& data = os.finish();
+
+    IStream is( data );
+    reader.rewind();
+    for( size_t i = 0; i < contexts.size(); ++i )
+        _testEqual( reader.read( is ), contexts[i] );
+    return data.size();
+}
+}
+
+int main( int, char** )
+{
+    eq::fabric::RenderContextCache writer;
+    eq::fabric::RenderContextCache reader;
+
+    // The number of tasks changes between frames
+    const size_t nTasks[] = { 3, 3, 5, 2, 4, 4, 1, 6 };
+    RenderContexts contexts;
+    for( size_t i = 0; i < sizeof( nTasks ) / sizeof( size_t ); ++i )
+    {
+        contexts = _newFrame( contexts, nTasks[i] );
+        _transmit( writer, reader, contexts );
+        TEST( reader.isSynchronized( ));
+    }
+
+    // Unchanged contexts are smaller than the first transmission
+    eq::fabric::RenderContextCache fresh;
+    eq::fabric::RenderContextCache freshReader;
+    const size_t full = _transmit( fresh, freshReader, contexts );
+    contexts = _newFrame( contexts, contexts.size( ));
+    const size_t delta = _transmit( fresh, freshReader, contexts );
+    TESTINFO( delta < full, delta << " >= " << full );
+
+    // A reader missing the base contexts detects the delta mismatch
+    contexts = _newFrame( contexts, contexts.size( ));
+    OStream os;
+    writer.rewind();
+    for( size_t i = 0; i < contexts.size(); ++i )
+        writer.write( os, contexts[i] );
+    const std::vector< uint8_t >& data = os.finish();
+
+    eq::fabric::RenderContextCache lost;
+    IStream is( data );
+    lost.rewind();
+    for( size_t i = 0; i < contexts.size(); ++i )
+        lost.read( is );
+    TEST( !lost.isSynchronized( ));
+
+    lost.clear();
+    TEST( lost.isSynchronized( ));
+    return EXIT_SUCCESS;
+}
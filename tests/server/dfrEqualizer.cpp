@@ -0,0 +1,187 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+
+#include <eq/server/channel.h>
+#include <eq/server/compound.h>
+#include <eq/server/config.h>
+#include <eq/server/frame.h>
+#include <eq/server/global.h>
+#include <eq/server/loader.h>
+#include <eq/server/server.h>
+#include <eq/server/tileQueue.h>
+#include <eq/server/equalizers/dfrEqualizer.h>
+
+#include <lunchbox/init.h>
+
+// Tests the tile sizing of the tile queue and the targets of a DFR equalizer
+// on a root compound
+
+namespace
+{
+const char* const _config =
+    "server\n"
+    "{\n"
+    "  config\n"
+    "  {\n"
+    "    appNode\n"
+    "    {\n"
+    "      pipe\n"
+    "      {\n"
+    "        window\n"
+    "        {\n"
+    "          channel { name \"source1\" }\n"
+    "          channel { name \"source2\" }\n"
+    "          channel { name \"source3\" }\n"
+    "          channel { name \"destination\" }\n"
+    "        }\n"
+    "      }\n"
+    "    }\n"
+    "    compound\n"
+    "    {\n"
+    "      channel \"destination\"\n"
+    "      DFR_equalizer { framerate 30 }\n"
+    "      compound\n"
+    "      {\n"
+    "        channel \"source1\"\n"
+    "        outputframe { name \"frame.source1\" }\n"
+    "      }\n"
+    "      compound\n"
+    "      {\n"
+    "        channel \"source2\"\n"
+    "        outputframe { name \"frame.source2\" }\n"
+    "      }\n"
+    "      inputframe { name \"frame.source1\" }\n"
+    "      inputframe { name \"frame.source2\" }\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+void _testTileSize()
+{
+    const eq::server::Vector2i grid( 4, 4 );
+    eq::server::TileQueue queue;
+    queue.setTileSize( eq::server::Vector2i( 64, 64 ));
+    queue.setTileGrid( grid );
+    TEST( !queue.fitTileSize( 16.f )); // no costs yet
+
+    // 4 ms per 64x64 tile: a 16 ms tile has twice the edge
+    for( int32_t y = 0; y < grid.y(); ++y )
+        for( int32_t x = 0; x < grid.x(); ++x )
+            queue.addTileTime( eq::PixelViewport( x * 64, y * 64, 64, 64 ),
+                               4.f );
+    TEST( queue.fitTileSize( 16.f ));
+    TESTINFO( queue.getTileSize() == eq::server::Vector2i( 128, 128 ),
+              queue.getTileSize( ));
+
+    // The new grid resets the costs
+    queue.setTileGrid( eq::server::Vector2i( 2, 2 ));
+    TEST( !queue.fitTileSize( 16.f ));
+
+    // Small deviations keep the tile size
+    for( int32_t y = 0; y < 2; ++y )
+        for( int32_t x = 0; x < 2; ++x )
+            queue.addTileTime( eq::PixelViewport( x * 128, y * 128, 128, 128),
+                               18.f );
+    TEST( !queue.fitTileSize( 16.f ));
+    TEST( queue.getTileSize() == eq::server::Vector2i( 128, 128 ));
+
+    // Sizes are clamped
+    TEST( queue.fitTileSize( .001f ));
+    TESTINFO( queue.getTileSize() == eq::server::Vector2i( 16, 16 ),
+              queue.getTileSize( ));
+}
+
+eq::server::DFREqualizer* _findEqualizer( eq::server::Compound* compound )
+{
+    const eq::server::Equalizers& equalizers = compound->getEqualizers();
+    for( eq::server::EqualizersCIter i = equalizers.begin();
+         i != equalizers.end(); ++i )
+    {
+        eq::server::DFREqualizer* equalizer =
+            dynamic_cast< eq::server::DFREqualizer* >( *i );
+        if( equalizer )
+            return equalizer;
+    }
+    return 0;
+}
+
+void _testTargets()
+{
+    eq::server::Loader loader;
+    eq::server::ServerPtr server = loader.parseServer( _config );
+    TEST( server.isValid( ));
+
+    const eq::server::Configs& configs = server->getConfigs();
+    TESTINFO( configs.size() == 1, configs.size( ));
+    eq::server::Config* config = configs.front();
+    TEST( config->getCompounds().size() == 1 );
+
+    eq::server::Compound* root = config->getCompounds().front();
+    eq::server::DFREqualizer* equalizer = _findEqualizer( root );
+    TEST( equalizer );
+
+    // A frozen equalizer resets the zoom of all its targets
+    const eq::fabric::Zoom zoom( .5f, .5f );
+    const eq::server::Compounds& children = root->getChildren();
+    TESTINFO( children.size() == 2, children.size( ));
+    for( eq::server::CompoundsCIter i = children.begin();
+         i != children.end(); ++i )
+    {
+        (*i)->setZoom( zoom );
+    }
+
+    equalizer->setFrozen( true );
+    equalizer->notifyUpdatePre( root, 1 );
+    for( eq::server::CompoundsCIter i = children.begin();
+         i != children.end(); ++i )
+    {
+        TEST( (*i)->getZoom() == eq::fabric::Zoom::NONE );
+    }
+
+    // Targets added later below an existing child are picked up
+    eq::server::Compound* group = new eq::server::Compound( root );
+    equalizer->notifyUpdatePre( root, 2 );
+
+    eq::server::Compound* late = new eq::server::Compound( group );
+    late->setChannel( config->find< eq::server::Channel >( "source3" ));
+    eq::server::Frame* frame = new eq::server::Frame;
+    frame->setName( "frame.source3" );
+    late->addOutputFrame( frame );
+
+    late->setZoom( zoom );
+    group->setZoom( zoom );
+    equalizer->notifyUpdatePre( root, 3 );
+    TEST( late->getZoom() == eq::fabric::Zoom::NONE );
+    TEST( group->getZoom() == zoom ); // no channel, not a target
+
+    eq::server::Global::clear();
+    server->deleteConfigs(); // break server <-> config ref circle
+}
+}
+
+int main( int argc, char **argv )
+{
+    TEST( lunchbox::init( argc, argv ));
+
+    _testTileSize();
+    _testTargets();
+
+    TEST( lunchbox::exit( ));
+    return EXIT_SUCCESS;
+}
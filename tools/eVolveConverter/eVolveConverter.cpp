@@ -19,9 +19,13 @@
 #include "ddsbase.h"
 
 #include <math.h>
+#include <time.h>
 #ifndef _MSC_VER
 #  include <stdint.h>
 #endif
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 #define EQ_MIN(a,b) ((a)<(b)?(a):(b))
 #ifndef MIN
@@ -31,6 +35,7 @@
 
 #include "eVolveConverter.h"
 #include "hlp.h"
+#include <volumeBricks.h>
 
 #define QUOTE( string ) STRINGIFY( string )
 #define STRINGIFY( foo ) #foo
@@ -87,6 +92,12 @@ int RawConverter::parseArguments( int argc, char** argv )
                                  command, false );
         TCLAP::SwitchArg pvmArg( "p", "pvm", "pvm[+sav]->raw+derivatives+vhf",
                                  command, false );
+        TCLAP::SwitchArg bnhArg( "", "benchmark",
+                                 "benchmark derivatives calculation of raw",
+                                 command, false );
+        TCLAP::SwitchArg brkArg( "b", "bricks",
+                                 "raw[+derivatives]->bricked multi-resolution",
+                                 command, false );
         TCLAP::ValueArg<string> dstArg( "d", "dst", "destination file", true,
                                         "Bucky32x32x32_d.raw", "string",
                                         command );
@@ -103,6 +114,13 @@ int RawConverter::parseArguments( int argc, char** argv )
             return RawConverter::RawToRawPlusDerivativesConverter(
                         srcArg.getValue( ), dstArg.getValue( ));
 
+        if( bnhArg.isSet() ) // benchmark derivatives
+            return RawConverter::BenchmarkDerivatives( srcArg.getValue( ));
+
+        if( brkArg.isSet() ) // raw -> bricks
+            return RawConverter::RawToBricksConverter(
+                        srcArg.getValue( ), dstArg.getValue( ));
+
         if( savArg.isSet() ) // sav -> vhf
             return RawConverter::SavToVhfConverter(
                         srcArg.getValue( ), dstArg.getValue( ));
@@ -180,6 +198,14 @@ static int calculateAndSaveDerivatives( const string& dst,
                                         const unsigned h,
                                         const unsigned d  );
 
+static int calculateAndSaveDerivatives( const string& dst,
+                                        const string& src,
+                                        const unsigned bytes,
+                                        const unsigned w,
+                                        const unsigned h,
+                                        const unsigned d,
+                                        const bool     save = true );
+
 
 static int readDimensionsFromSav( FILE*     file,
                                   unsigned& w,
@@ -445,11 +471,43 @@ int RawConverter::RawPlusDerivativesToRawConverter( const string& src,
 }
 
 
-int RawConverter::RawToRawPlusDerivativesConverter( const string& src,
-                                                    const string& dst )
+/** Average 2x2x2 voxels of each channel, clamped at the volume border.
+*/
+static void downsampleVolume( const vector<unsigned char>& src,
+                              vector<unsigned char>& dst,
+                              const unsigned w, const unsigned h,
+                              const unsigned d, const unsigned bytes )
+{
+    const unsigned w2 = eVolve::getLevelSize( w, 1 );
+    const unsigned h2 = eVolve::getLevelSize( h, 1 );
+    const unsigned d2 = eVolve::getLevelSize( d, 1 );
+    dst.resize( size_t( w2 )*h2*d2*bytes );
+
+    for( unsigned z = 0; z < d2; ++z )
+    for( unsigned y = 0; y < h2; ++y )
+    for( unsigned x = 0; x < w2; ++x )
+    {
+        const unsigned xs[2] = { 2*x, min( 2*x+1, w-1 ) };
+        const unsigned ys[2] = { 2*y, min( 2*y+1, h-1 ) };
+        const unsigned zs[2] = { 2*z, min( 2*z+1, d-1 ) };
+
+        for( unsigned c = 0; c < bytes; ++c )
+        {
+            unsigned sum = 0;
+            for( unsigned i = 0; i < 8; ++i )
+                sum += src[(( size_t( zs[i>>2] )*h + ys[(i>>1)&1] )*w +
+                            xs[i&1] )*bytes + c ];
+
+            dst[(( size_t( z )*h2 + y )*w2 + x )*bytes + c ] =
+                static_cast< unsigned char >(( sum + 4 ) / 8 );
+        }
+    }
+}
+
+
+int RawConverter::BenchmarkDerivatives( const string& src )
 {
     unsigned w, h, d;
-//read header
     {
         string configFileName = src;
         hFile info( fopen( configFileName.append( ".vhf" ).c_str(), "rb" ) );
@@ -457,45 +515,109 @@ int RawConverter::RawToRawPlusDerivativesConverter( const string& src,
 
         if( file==NULL ) return lFailed( "Can't open header file" );
 
-        readDimensionsFromSav( file, w, h, d );
+        if( readDimensionsFromSav( file, w, h, d ))
+            return lFailed( "Can't read dimensions from header file" );
     }
-    LBWARN << "Creating derivatives for raw model: "
+
+    const size_t srcLen = src.length();
+    const unsigned bytes =
+        ( srcLen >= 6 && src.substr( srcLen-6, 6 ) == "_d.raw" ) ? 4 : 1;
+
+    LBWARN << "Benchmarking derivatives for model: "
            << src << " " << w << " x " << h << " x " << d << endl;
+    return calculateAndSaveDerivatives( "", src, bytes, w, h, d, false );
+}
+
+
+int RawConverter::RawToBricksConverter( const string& src, const string& dst )
+{
+    unsigned w, h, d;
+//read header
+    {
+        string configFileName = src;
+        hFile info( fopen( configFileName.append( ".vhf" ).c_str(), "rb" ) );
+        FILE* file = info.f;
+
+        if( file==NULL ) return lFailed( "Can't open header file" );
+
+        if( readDimensionsFromSav( file, w, h, d ))
+            return lFailed( "Can't read dimensions from header file" );
+    }
+
+    // same convention as eVolve to detect raw+derivatives data
+    const size_t srcLen = src.length();
+    const unsigned bytes =
+        ( srcLen >= 6 && src.substr( srcLen-6, 6 ) == "_d.raw" ) ? 4 : 1;
+
+    LBWARN << "Creating bricks for model: " << src << " " << w << " x " << h
+           << " x " << d << " x " << bytes << endl;
 
 //read model
-    vector<unsigned char> volume( w*h*d, 0 );
+    vector<unsigned char> volume( size_t( w )*h*d*bytes, 0 );
 
     LBWARN << "Reading model" << endl;
     {
-        ifstream file( src.c_str(),
-                       ifstream::in | ifstream::binary | ifstream::ate );
+        ifstream file( src.c_str(), ifstream::in | ifstream::binary );
 
         if( !file.is_open() )
             return lFailed( "Can't open volume file" );
 
-        ifstream::pos_type size;
+        file.read( (char*)( &volume[0] ), volume.size() );
+        if( !file.good() )
+            return lFailed( "Volume file is shorter than its header" );
+    }
 
-        size = min( (int)file.tellg(), (int)volume.size() );
+//write levels until the coarsest fits into one brick
+    eVolve::BrickHeader header;
+    header.magic      = eVolve::BRICK_MAGIC;
+    header.version    = eVolve::BRICK_VERSION;
+    header.w          = w;
+    header.h          = h;
+    header.d          = d;
+    header.bytes      = bytes;
+    header.brickDepth = 16;
+    header.levels     = 1;
+    while( header.levels < 16 &&
+           ( eVolve::getLevelSize( w, header.levels-1 ) > header.brickDepth ||
+             eVolve::getLevelSize( h, header.levels-1 ) > header.brickDepth ||
+             eVolve::getLevelSize( d, header.levels-1 ) > header.brickDepth ))
+    {
+        ++header.levels;
+    }
 
-        file.seekg( 0, ios::beg );
-        file.read( (char*)( &volume[0] ), size );
+    ofstream file( dst.c_str(),
+                   ifstream::out | ifstream::binary | ifstream::trunc );
+    if( !file.is_open() )
+        return lFailed( "Can't open destination bricks file" );
 
-        file.close();
-    }
+    file.write( (const char*)( &header ), sizeof( header ));
 
-//calculate and save derivatives
+    vector<unsigned char> level;
+    for( unsigned i = 0; i < header.levels; ++i )
     {
-        int result = calculateAndSaveDerivatives( dst, &volume[0], w,  h, d );
+        LBWARN << "Writing level " << i << endl;
+        file.write( (const char*)( &volume[0] ), volume.size() );
 
-        if( result ) return result;
+        if( i+1 < header.levels )
+        {
+            downsampleVolume( volume, level,
+                              eVolve::getLevelSize( w, i ),
+                              eVolve::getLevelSize( h, i ),
+                              eVolve::getLevelSize( d, i ), bytes );
+            volume.swap( level );
+        }
     }
+
+    if( !file.good() )
+        return lFailed( "Can't write bricks file" );
+
     LBWARN << "done" << endl;
     return 0;
 }
 
 
-int RawConverter::RecalculateDerivatives( const string& src,
-                                          const string& dst )
+int RawConverter::RawToRawPlusDerivativesConverter( const string& src,
+                                                    const string& dst )
 {
     unsigned w, h, d;
 //read header
@@ -511,42 +633,37 @@ int RawConverter::RecalculateDerivatives( const string& src,
     LBWARN << "Creating derivatives for raw model: "
            << src << " " << w << " x " << h << " x " << d << endl;
 
-//read model
-    vector<unsigned char> volume( w*h*d*4, 0 );
-
-    LBWARN << "Reading model" << endl;
+//calculate and save derivatives, streaming slabs of the volume file
     {
-        ifstream file( src.c_str(),
-                       ifstream::in | ifstream::binary | ifstream::ate );
+        int result = calculateAndSaveDerivatives( dst, src, 1, w, h, d );
 
-        if( !file.is_open() )
-            return lFailed( "Can't open volume file" );
+        if( result ) return result;
+    }
+    LBWARN << "done" << endl;
+    return 0;
+}
 
-        ifstream::pos_type size;
 
-        size = min( (int)file.tellg(), (int)volume.size() );
+int RawConverter::RecalculateDerivatives( const string& src,
+                                          const string& dst )
+{
+    unsigned w, h, d;
+//read header
+    {
+        string configFileName = src;
+        hFile info( fopen( configFileName.append( ".vhf" ).c_str(), "rb" ) );
+        FILE* file = info.f;
 
-        file.seekg( 0, ios::beg );
-        file.read( (char*)( &volume[0] ), size );
+        if( file==NULL ) return lFailed( "Can't open header file" );
 
-        file.close();
-    }
-//remove derivatives
-    {
-        unsigned char* sr = &volume[3];
-        unsigned char* ds = &volume[0];
-        for( unsigned i = 3; i < w*h*d*4; i+=4 )
-        {
-            *ds = *sr;
-            sr += 4;
-            ++ds;
-        }
-        volume.resize( w*h*d );
+        readDimensionsFromSav( file, w, h, d );
     }
+    LBWARN << "Creating derivatives for raw model: "
+           << src << " " << w << " x " << h << " x " << d << endl;
 
-//calculate and save derivatives
+//calculate and save derivatives from the values of the raw+derivatives file
     {
-        int result = calculateAndSaveDerivatives( dst, &volume[0], w, h, d );
+        int result = calculateAndSaveDerivatives( dst, src, 4, w, h, d );
 
         if( result ) return result;
     }
@@ -931,93 +1048,239 @@ int RawConverter::ScaleRawDerFile(                  const string& src,
 }
 
 
+/** @return the wall clock time in seconds. */
+static double getTime()
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return double( clock( )) / CLOCKS_PER_SEC;
+#endif
+}
+
+
+/** Gradients and values of one row of voxels with a 3x3x3 Sobel stencil,
+    the first and last voxel of the row are left untouched.
+*/
+static void calculateGradientRow( const unsigned char* prvRow,
+                                  const unsigned char* curRow,
+                                  const unsigned char* nxtRow,
+                                  const int ws,
+                                  unsigned char* out )
+{
+    for( int x=1; x<ws-1; x++ )
+    {
+        const unsigned char * curP = curRow + x;
+        const unsigned char * prvP = prvRow + x;
+        const unsigned char * nxtP = nxtRow + x;
+        int gx =
+              nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
+            3*nxtP[     1 ]+ 6*curP[     1 ]+ 3*prvP[     1 ]+
+              nxtP[ -ws+1 ]+ 3*curP[ -ws+1 ]+   prvP[ -ws+1 ]-
+
+              nxtP[  ws-1 ]- 3*curP[  ws-1 ]-   prvP[  ws-1 ]-
+            3*nxtP[    -1 ]- 6*curP[    -1 ]- 3*prvP[    -1 ]-
+              nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
+
+        int gy =
+              nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
+            3*nxtP[  ws   ]+ 6*curP[  ws   ]+ 3*prvP[  ws   ]+
+              nxtP[  ws-1 ]+ 3*curP[  ws-1 ]+   prvP[  ws-1 ]-
+
+              nxtP[ -ws+1 ]- 3*curP[ -ws+1 ]-   prvP[ -ws+1 ]-
+            3*nxtP[ -ws   ]- 6*curP[ -ws   ]- 3*prvP[ -ws   ]-
+              nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
+
+        int gz =
+              nxtP[  ws+1 ]+ 3*nxtP[    1 ]+   nxtP[ -ws+1 ]+
+            3*nxtP[  ws   ]+ 6*nxtP[    0 ]+ 3*nxtP[ -ws   ]+
+              nxtP[  ws-1 ]+ 3*nxtP[   -1 ]+   nxtP[ -ws-1 ]-
+
+              prvP[  ws+1 ]- 3*prvP[    1 ]-   prvP[ -ws+1 ]-
+            3*prvP[  ws   ]- 6*prvP[    0 ]- 3*prvP[ -ws   ]-
+              prvP[  ws-1 ]- 3*prvP[   -1 ]-   prvP[ -ws-1 ];
+
+        int length = static_cast<int>(
+                                sqrt(double((gx*gx+gy*gy+gz*gz))+1));
+
+        gx = ( gx*255/length + 255 )/2;
+        gy = ( gy*255/length + 255 )/2;
+        gz = ( gz*255/length + 255 )/2;
+
+        out[x*4   ] = static_cast<unsigned char>( gx );
+        out[x*4 +1] = static_cast<unsigned char>( gy );
+        out[x*4 +2] = static_cast<unsigned char>( gz );
+        out[x*4 +3] = curP[0];
+    }
+}
+
+
+/** Source of volume slices for the streamed derivatives calculation.
+*/
+class SliceSource
+{
+public:
+    virtual ~SliceSource() {}
+
+    /** Read the values of n slices starting at z into data. */
+    virtual bool read( unsigned z, unsigned n, unsigned char* data ) = 0;
+};
+
+class MemorySliceSource : public SliceSource
+{
+public:
+    MemorySliceSource( const unsigned char* volume, const size_t wh )
+        : _volume( volume ), _wh( wh ) {}
+
+    virtual bool read( unsigned z, unsigned n, unsigned char* data )
+    {
+        memcpy( data, _volume + z*_wh, n*_wh );
+        return true;
+    }
+
+private:
+    const unsigned char* _volume;
+    const size_t         _wh;
+};
+
+/** Reads raw (bytes=1) or the values of raw+derivatives (bytes=4) files. */
+class FileSliceSource : public SliceSource
+{
+public:
+    FileSliceSource( const string& filename, const unsigned bytes,
+                     const size_t wh )
+        : _file( filename.c_str(), ifstream::in | ifstream::binary )
+        , _bytes( bytes ), _wh( wh ) {}
+
+    bool isOpen() const { return _file.is_open(); }
+
+    virtual bool read( unsigned z, unsigned n, unsigned char* data )
+    {
+        const size_t size = n*_wh*_bytes;
+        _buffer.resize( size );
+        _file.clear();
+        _file.seekg( streamoff( z*_wh*_bytes ), ios::beg );
+        _file.read( (char*)( &_buffer[0] ), size );
+
+        // missing data at the end of the file is zero, as before
+        const size_t got = static_cast<size_t>( _file.gcount() );
+        memset( &_buffer[0] + got, 0, size - got );
+
+        for( size_t i = 0; i < n*_wh; ++i )
+            data[i] = _buffer[ i*_bytes + _bytes-1 ];
+        return true;
+    }
+
+private:
+    ifstream                _file;
+    const unsigned          _bytes;
+    const size_t            _wh;
+    vector< unsigned char > _buffer;
+};
+
+
+/** Calculate derivatives slab by slab, all rows of a slab in parallel, and
+    write each slab to the destination file, which bounds the memory usage
+    to a few slices independent of the volume size.
+*/
 static int calculateAndSaveDerivatives( const string& dst,
-                                        unsigned char *volume,
+                                        SliceSource& source,
                                         const unsigned w,
                                         const unsigned h,
-                                        const unsigned d  )
+                                        const unsigned d,
+                                        const bool     save )
 {
     LBWARN << "Calculating derivatives" << endl;
-    ofstream file ( dst.c_str(),
-                    ifstream::out | ifstream::binary | ifstream::trunc );
-
-    if( !file.is_open() )
-        return lFailed( "Can't open destination volume file" );
+    ofstream file;
+    if( save )
+    {
+        file.open( dst.c_str(),
+                   ifstream::out | ifstream::binary | ifstream::trunc );
 
-    const int wh = w*h;
+        if( !file.is_open() )
+            return lFailed( "Can't open destination volume file" );
+    }
 
-    const int ws = static_cast<int>( w );
+    const size_t wh = size_t( w )*h;
+    const int    ws = static_cast<int>( w );
+    const unsigned slabDepth = 16;
 
-    vector<unsigned char> GxGyGzA( wh*d*4, 0 );
+    // input slab with one halo slice on each side
+    vector<unsigned char> slices( ( slabDepth+2 )*wh, 0 );
+    vector<unsigned char> GxGyGzA( slabDepth*wh*4, 0 );
+    double computeTime = 0.;
 
-    for( unsigned z=1; z<d-1; z++ )
+    for( unsigned z0 = 0; z0 < d; z0 += slabDepth )
     {
-        const int zwh = z*wh;
+        const unsigned n     = min( slabDepth, d-z0 );
+        const unsigned first = z0 > 0 ? z0-1 : 0;
+        const unsigned last  = min( z0+n, d-1 );
+        const size_t   base  = ( first+1-z0 )*wh; // position of slice first
 
-        const unsigned char *curPz = &volume[0] + zwh;
+        if( !source.read( first, last-first+1, &slices[base] ))
+            return lFailed( "Can't read volume data" );
 
-        for( unsigned y=1; y<h-1; y++ )
+        const double start = getTime();
+        memset( &GxGyGzA[0], 0, n*wh*4 );
+
+        const int nRows = static_cast<int>( n*h );
+#pragma omp parallel for schedule( static )
+        for( int i = 0; i < nRows; ++i )
         {
-            const int zwh_y = zwh + y*w;
-            const unsigned char * curPy = curPz + y*w;
-            for( unsigned x=1; x<w-1; x++ )
-            {
-                const unsigned char * curP = curPy +  x;
-                const unsigned char * prvP = curP  - wh;
-                const unsigned char * nxtP = curP  + wh;
-                int gx =
-                      nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
-                    3*nxtP[     1 ]+ 6*curP[     1 ]+ 3*prvP[     1 ]+
-                      nxtP[ -ws+1 ]+ 3*curP[ -ws+1 ]+   prvP[ -ws+1 ]-
-
-                      nxtP[  ws-1 ]- 3*curP[  ws-1 ]-   prvP[  ws-1 ]-
-                    3*nxtP[    -1 ]- 6*curP[    -1 ]- 3*prvP[    -1 ]-
-                      nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
-
-                int gy =
-                      nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
-                    3*nxtP[  ws   ]+ 6*curP[  ws   ]+ 3*prvP[  ws   ]+
-                      nxtP[  ws-1 ]+ 3*curP[  ws-1 ]+   prvP[  ws-1 ]-
-
-                      nxtP[ -ws+1 ]- 3*curP[ -ws+1 ]-   prvP[ -ws+1 ]-
-                    3*nxtP[ -ws   ]- 6*curP[ -ws   ]- 3*prvP[ -ws   ]-
-                      nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
-
-                int gz =
-                      nxtP[  ws+1 ]+ 3*nxtP[    1 ]+   nxtP[ -ws+1 ]+
-                    3*nxtP[  ws   ]+ 6*nxtP[    0 ]+ 3*nxtP[ -ws   ]+
-                      nxtP[  ws-1 ]+ 3*nxtP[   -1 ]+   nxtP[ -ws-1 ]-
-
-                      prvP[  ws+1 ]- 3*prvP[    1 ]-   prvP[ -ws+1 ]-
-                    3*prvP[  ws   ]- 6*prvP[    0 ]- 3*prvP[ -ws   ]-
-                      prvP[  ws-1 ]- 3*prvP[   -1 ]-   prvP[ -ws-1 ];
-
-                int length = static_cast<int>(
-                                        sqrt(double((gx*gx+gy*gy+gz*gz))+1));
-
-                gx = ( gx*255/length + 255 )/2;
-                gy = ( gy*255/length + 255 )/2;
-                gz = ( gz*255/length + 255 )/2;
-
-                GxGyGzA[(zwh_y + x)*4   ] = static_cast<unsigned char>( gx );
-                GxGyGzA[(zwh_y + x)*4 +1] = static_cast<unsigned char>( gy );
-                GxGyGzA[(zwh_y + x)*4 +2] = static_cast<unsigned char>( gz );
-                GxGyGzA[(zwh_y + x)*4 +3] = curP[0];
-            }
+            const unsigned z = z0 + i/h;
+            const unsigned y = i%h;
+            if( z == 0 || z >= d-1 || y == 0 || y >= h-1 )
+                continue;
+
+            const unsigned char* curRow = &slices[( z+1-z0 )*wh + y*w];
+            calculateGradientRow( curRow - wh, curRow, curRow + wh, ws,
+                                  &GxGyGzA[( size_t( i/h )*wh + y*w )*4] );
         }
-    }
+        computeTime += getTime() - start;
 
-    LBWARN << "Writing derivatives: "
-           << dst.c_str() << " " << GxGyGzA.size() << " bytes" <<endl;
+        if( save )
+            file.write( (char*)( &GxGyGzA[0] ), n*wh*4 );
+    }
 
-    file.write( (char*)( &GxGyGzA[0] ), GxGyGzA.size() );
+    const double voxels = double( wh )*d;
+    LBWARN << "Calculated " << voxels << " voxels in " << computeTime
+           << " s, " << voxels / hlpFuncs::max( computeTime, 1e-6 ) << " voxels/s"
+           << endl;
 
-    file.close();
+    if( save && !file.good() )
+        return lFailed( "Can't write destination volume file" );
 
     return 0;
 }
 
 
+static int calculateAndSaveDerivatives( const string& dst,
+                                        unsigned char *volume,
+                                        const unsigned w,
+                                        const unsigned h,
+                                        const unsigned d  )
+{
+    MemorySliceSource source( volume, size_t( w )*h );
+    return calculateAndSaveDerivatives( dst, source, w, h, d, true );
+}
+
+
+static int calculateAndSaveDerivatives( const string& dst,
+                                        const string& src,
+                                        const unsigned bytes,
+                                        const unsigned w,
+                                        const unsigned h,
+                                        const unsigned d,
+                                        const bool     save )
+{
+    FileSliceSource source( src, bytes, size_t( w )*h );
+    if( !source.isOpen() )
+        return lFailed( "Can't open volume file" );
+
+    return calculateAndSaveDerivatives( dst, source, w, h, d, save );
+}
+
+
 static void getPredefinedHeaderParameters( const string& fileName,
                                           unsigned &w, unsigned &h, unsigned &d,
                                           vector<unsigned char> &TF )
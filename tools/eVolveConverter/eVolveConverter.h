@@ -16,6 +16,11 @@ namespace eVolve
         static int RawPlusDerivativesToRawConverter( const string& src,
                                                      const string& dst  );
 
+        static int BenchmarkDerivatives(             const string& src  );
+
+        static int RawToBricksConverter(             const string& src,
+                                                     const string& dst  );
+
         static int SavToVhfConverter(                const string& src,
                                                      const string& dst  );
 
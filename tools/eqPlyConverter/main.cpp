@@ -60,7 +60,8 @@ int main( const int argc, char** argv )
         if( _isPlyfile( filename ))
         {
             mesh::VertexBufferRoot* model = new mesh::VertexBufferRoot;
-            if( !model->readFromFile( filename.c_str( )))
+            // existing binary files are verified, broken ones are rebuilt
+            if( !model->readFromFile( filename.c_str(), true ))
                 LBWARN << "Can't load model: " << filename << std::endl;
 
             delete model;
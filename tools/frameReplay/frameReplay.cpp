@@ -0,0 +1,184 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Replays the images of a frame recording (see eq::FrameRecorder) through the
+// CPU compositor and reports the decompression and compositing performance.
+
+#include <eq/eq.h>
+#include <lunchbox/clock.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+namespace
+{
+typedef std::map< uint32_t, std::vector< size_t > > FrameRecords;
+typedef std::map< eq::uint128_t, eq::Frame* > FrameMap;
+
+struct Result
+{
+    Result() : nFrames( 0 ), nImages( 0 ), nBytes( 0 ), nPixels( 0 )
+             , decompressTime( 0.f ), compositeTime( 0.f ) {}
+
+    size_t nFrames;
+    size_t nImages;
+    uint64_t nBytes;  //!< recorded image data
+    uint64_t nPixels; //!< composited pixels
+    float decompressTime;
+    float compositeTime;
+};
+
+void _replay( const eq::FrameRecording& recording,
+              const FrameRecords& frameRecords, FrameMap& frames,
+              const bool blendAlpha, Result& result )
+{
+    lunchbox::Clock clock;
+    for( FrameRecords::const_iterator i = frameRecords.begin();
+         i != frameRecords.end(); ++i )
+    {
+        const std::vector< size_t >& records = i->second;
+        eq::Frames inputFrames;
+
+        clock.reset();
+        for( size_t j = 0; j < records.size(); ++j )
+        {
+            const eq::FrameRecord& record = recording.getRecord( records[j] );
+            eq::Frame*& frame = frames[ record.frameDataID ];
+            if( !frame )
+            {
+                frame = new eq::Frame;
+                frame->setFrameData( new eq::FrameData );
+            }
+            eq::FrameDataPtr frameData = frame->getFrameData();
+            if( frameData->getImages().empty( ))
+                inputFrames.push_back( frame );
+
+            // the recording is mapped read-only, the images only read the data
+            uint8_t* data =
+                const_cast< uint8_t* >( recording.getData( records[j] ));
+            frameData->newImage( record.pvp, record.zoom, record.buffers,
+                                 record.useAlpha != 0, data );
+            result.nBytes += record.size;
+        }
+        result.decompressTime += clock.getTimef();
+        result.nImages += records.size();
+
+        clock.reset();
+        const eq::Image* image = eq::Compositor::mergeFramesCPU( inputFrames,
+                                                                 blendAlpha );
+        result.compositeTime += clock.getTimef();
+        if( image )
+            result.nPixels += image->getPixelViewport().getArea();
+        ++result.nFrames;
+
+        for( eq::FramesCIter j = inputFrames.begin(); j!=inputFrames.end(); ++j)
+            (*j)->getFrameData()->clear();
+    }
+}
+
+void _print( const Result& result )
+{
+    const float time = result.decompressTime + result.compositeTime;
+    std::cout << result.nFrames << " frames, " << result.nImages << " images, "
+              << result.nBytes / 1048576.f << " MB: decompress "
+              << result.decompressTime << " ms, composite "
+              << result.compositeTime << " ms, "
+              << ( time > 0.f ? result.nFrames * 1000.f / time : 0.f )
+              << " FPS, "
+              << ( result.compositeTime > 0.f ?
+                   result.nPixels / result.compositeTime / 1000.f : 0.f )
+              << " MPixel/s composited" << std::endl;
+}
+}
+
+int main( int argc, char **argv )
+{
+    std::string filename;
+    bool blendAlpha = false;
+    int iterations = 1;
+    for( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        if( arg == "-b" || arg == "--blend" )
+            blendAlpha = true;
+        else if(( arg == "-i" || arg == "--iterations" ) && i + 1 < argc )
+            iterations = std::max( 1, atoi( argv[++i] ));
+        else if( arg[0] != '-' )
+            filename = arg;
+    }
+
+    if( filename.empty( ))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-b|--blend] [-i|--iterations n] recording.eqr"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    eq::NodeFactory nodeFactory;
+    if( !eq::init( argc, argv, &nodeFactory ))
+    {
+        std::cerr << "Equalizer initialization failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int retval = EXIT_FAILURE;
+    {
+        eq::FrameRecording recording;
+        if( recording.open( filename ))
+        {
+            FrameRecords frameRecords;
+            for( size_t i = 0; i < recording.getNumRecords(); ++i )
+            {
+                const uint32_t frameNumber = recording.getRecord(i).frameNumber;
+                frameRecords[ frameNumber ].push_back( i );
+            }
+
+            FrameMap frames;
+            for( int i = 0; i < iterations; ++i )
+            {
+                Result result;
+                _replay( recording, frameRecords, frames, blendAlpha, result );
+                _print( result );
+            }
+
+            for( FrameMap::const_iterator i = frames.begin();
+                 i != frames.end(); ++i )
+            {
+                eq::Frame* frame = i->second;
+                frame->getFrameData()->flush();
+                delete frame;
+            }
+            retval = EXIT_SUCCESS;
+        }
+    }
+
+    eq::exit();
+    return retval;
+}